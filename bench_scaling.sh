@@ -0,0 +1,14 @@
+#!/bin/sh
+# Frame time of the headless build for 1 to N threads, run build_headless.sh first.
+# usage: bench_scaling.sh [frame count] [max thread count]
+
+cd "$(dirname "$0")/build"
+
+frame_count=${1:-3000}
+thread_count=${2:-$(nproc)}
+
+worker_count=0
+while [ "$worker_count" -lt "$thread_count" ]; do
+    echo "threads $((worker_count + 1)): $(./headless_rm "$frame_count" 0 "$worker_count" 0 | grep 'frame time' | cut -d, -f1)"
+    worker_count=$((worker_count + 1))
+done
@@ -23,7 +23,7 @@ where /q node && (
 
         start /B node export_runtime_binary.js frame_data.schema.yml build/frame_data.bin >CON 2>CON
         start /B node export_imhex_pattern.js frame_data.schema.yml generated/frame_data.hexpat >CON 2>CON
-        start /B node export_c_header.js frame_data.schema.yml generated/frame_data.h >CON 2>CON
+        start /B node export_c_header.js frame_data.schema.yml generated/frame_data.h generated/frame_data_static.h >CON 2>CON
 
         start /B node export_runtime_binary.js materials.schema.yml build/materials.bin materials.xlsx >CON 2>CON
         start /B node export_imhex_pattern.js materials.schema.yml generated/materials.hexpat >CON 2>CON
@@ -34,7 +34,7 @@ where /q node && (
         start /B node export_imhex_pattern.js bullets.schema.yml generated/bullets.hexpat >CON 2>CON
         start /B node export_c_header.js bullets.schema.yml generated/bullets.h >CON 2>CON
 
-        start /B node export_c_header.js bullets_update.schema.yml generated/bullets_update.h >CON 2>CON
+        start /B node export_c_header.js bullets_update.schema.yml generated/bullets_update.h generated/bullets_update_static.h >CON 2>CON
         start /B node export_runtime_binary.js bullets_update.schema.yml build/enemy_bullets_update.bin >CON 2>CON
         start /B node export_runtime_binary.js bullets_update.schema.yml build/hero_bullets_update.bin >CON 2>CON
         start /B node export_imhex_pattern.js bullets_update.schema.yml generated/bullets_update.hexpat >CON 2>CON
@@ -43,17 +43,17 @@ where /q node && (
 
         start /B node export_c_header.js enemy_instances_draw.schema.yml generated/enemy_instances_draw.h >CON 2>CON
 
-        start /B node export_c_header.js game_state.schema.yml generated/game_state.h >CON 2>CON
+        start /B node export_c_header.js game_state.schema.yml generated/game_state.h generated/game_state_static.h >CON 2>CON
         start /B node export_runtime_binary.js game_state.schema.yml build/game_state.bin >CON 2>CON
         start /B node export_imhex_pattern.js game_state.schema.yml generated/game_state.hexpat >CON 2>CON
 
         start /B node export_c_header.js bullet_source_instances.schema.yml generated/bullet_source_instances.h >CON 2>CON
 
-        start /B node export_c_header.js wave_update.schema.yml generated/wave_update.h >CON 2>CON
+        start /B node export_c_header.js wave_update.schema.yml generated/wave_update.h generated/wave_update_static.h >CON 2>CON
         start /B node export_runtime_binary.js wave_update.schema.yml build/wave_update.bin >CON 2>CON
         start /B node export_imhex_pattern.js wave_update.schema.yml generated/wave_update.hexpat >CON 2>CON
 
-        start /B node export_c_header.js level_update.schema.yml generated/level_update.h >CON 2>CON
+        start /B node export_c_header.js level_update.schema.yml generated/level_update.h generated/level_update_static.h >CON 2>CON
         start /B node export_runtime_binary.js level_update.schema.yml build/level_update.bin >CON 2>CON
         start /B node export_imhex_pattern.js level_update.schema.yml generated/level_update.hexpat >CON 2>CON
 
@@ -66,16 +66,22 @@ where /q node && (
         start /B node export_c_header.js collision_source_damage.schema.yml generated/collision_source_damage.h >CON 2>CON
         start /B node export_c_header.js collision_instances_damage.schema.yml generated/collision_instances_damage.h >CON 2>CON
 
-        start /B node export_c_header.js collision_grid.schema.yml generated/collision_grid.h >CON 2>CON
+        start /B node export_c_header.js collision_grid.schema.yml generated/collision_grid.h generated/collision_grid_static.h >CON 2>CON
         start /B node export_runtime_binary.js collision_grid.schema.yml build/collision_grid.bin >CON 2>CON
         start /B node export_imhex_pattern.js collision_grid.schema.yml generated/collision_grid.hexpat >CON 2>CON
 
-        start /B node export_c_header.js collision_damage.schema.yml generated/collision_damage.h >CON 2>CON
+        start /B node export_c_header.js damage_event_pool.schema.yml generated/damage_event_pool.h generated/damage_event_pool_static.h >CON 2>CON
+        start /B node export_runtime_binary.js damage_event_pool.schema.yml build/damage_event_pool.bin >CON 2>CON
+        start /B node export_imhex_pattern.js damage_event_pool.schema.yml generated/damage_event_pool.hexpat >CON 2>CON
+
+        start /B node export_c_header.js collision_damage.schema.yml generated/collision_damage.h generated/collision_damage_static.h >CON 2>CON
         start /B node export_runtime_binary.js collision_damage.schema.yml build/collision_damage.bin >CON 2>CON
         start /B node export_imhex_pattern.js collision_damage.schema.yml generated/collision_damage.hexpat >CON 2>CON
 
     ) | pause
 
+    node export_pack_binary.js world.pack.yml build/world.pack generated/world_pack.h
+
 	pushd build
 
 	where /q cl && (
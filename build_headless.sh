@@ -0,0 +1,95 @@
+#!/bin/sh
+# Headless Linux build: same exporters as build.bat, then headless_main.c with the frame pipeline and a CPU consumer.
+
+command -v cc >/dev/null || echo "WARNING: cc not found -- executable will not be built"
+command -v node >/dev/null || { echo "WARNING: node not found -- executable will not be built"; exit 1; }
+
+cd "$(dirname "$0")"
+
+mkdir -p build generated
+
+(
+    node export_runtime_binary.js enemy_instances.schema.yml build/enemy_instances.bin enemy_instances.xlsx &
+    node export_imhex_pattern.js enemy_instances.schema.yml generated/enemy_instances.hexpat &
+    node export_c_header.js enemy_instances.schema.yml generated/enemy_instances.h &
+
+    node export_c_header.js enemy_instances_wave.schema.yml generated/enemy_instances_wave.h &
+
+    node export_c_header.js hero_instances_draw.schema.yml generated/hero_instances_draw.h &
+
+    node export_runtime_binary.js hero_instances.schema.yml build/hero_instances.bin hero_instances.xlsx &
+    node export_imhex_pattern.js hero_instances.schema.yml generated/hero_instances.hexpat &
+    node export_c_header.js hero_instances.schema.yml generated/hero_instances.h &
+
+    node export_runtime_binary.js frame_data.schema.yml build/frame_data.bin &
+    node export_imhex_pattern.js frame_data.schema.yml generated/frame_data.hexpat &
+    node export_c_header.js frame_data.schema.yml generated/frame_data.h generated/frame_data_static.h &
+
+    node export_runtime_binary.js materials.schema.yml build/materials.bin materials.xlsx &
+    node export_imhex_pattern.js materials.schema.yml generated/materials.hexpat &
+    node export_c_header.js materials.schema.yml generated/materials.h &
+
+    node export_runtime_binary.js bullets.schema.yml build/enemy_bullets.bin enemy_bullets.xlsx &
+    node export_runtime_binary.js bullets.schema.yml build/hero_bullets.bin hero_bullets.xlsx &
+    node export_imhex_pattern.js bullets.schema.yml generated/bullets.hexpat &
+    node export_c_header.js bullets.schema.yml generated/bullets.h &
+
+    node export_c_header.js bullets_update.schema.yml generated/bullets_update.h generated/bullets_update_static.h &
+    node export_runtime_binary.js bullets_update.schema.yml build/enemy_bullets_update.bin &
+    node export_runtime_binary.js bullets_update.schema.yml build/hero_bullets_update.bin &
+    node export_imhex_pattern.js bullets_update.schema.yml generated/bullets_update.hexpat &
+
+    node export_c_header.js bullets_draw.schema.yml generated/bullets_draw.h &
+
+    node export_c_header.js enemy_instances_draw.schema.yml generated/enemy_instances_draw.h &
+
+    node export_c_header.js game_state.schema.yml generated/game_state.h generated/game_state_static.h &
+    node export_runtime_binary.js game_state.schema.yml build/game_state.bin &
+    node export_imhex_pattern.js game_state.schema.yml generated/game_state.hexpat &
+
+    node export_c_header.js bullet_source_instances.schema.yml generated/bullet_source_instances.h &
+
+    node export_c_header.js wave_update.schema.yml generated/wave_update.h generated/wave_update_static.h &
+    node export_runtime_binary.js wave_update.schema.yml build/wave_update.bin &
+    node export_imhex_pattern.js wave_update.schema.yml generated/wave_update.hexpat &
+
+    node export_c_header.js level_update.schema.yml generated/level_update.h generated/level_update_static.h &
+    node export_runtime_binary.js level_update.schema.yml build/level_update.bin &
+    node export_imhex_pattern.js level_update.schema.yml generated/level_update.hexpat &
+
+    node export_c_header.js play_area.schema.yml generated/play_area.h &
+
+    node export_c_header.js play_clock.schema.yml generated/play_clock.h &
+
+    node export_c_header.js collision_source_instances.schema.yml generated/collision_source_instances.h &
+    node export_c_header.js collision_source_radius.schema.yml generated/collision_source_radius.h &
+    node export_c_header.js collision_source_damage.schema.yml generated/collision_source_damage.h &
+    node export_c_header.js collision_instances_damage.schema.yml generated/collision_instances_damage.h &
+
+    node export_c_header.js collision_grid.schema.yml generated/collision_grid.h generated/collision_grid_static.h &
+    node export_runtime_binary.js collision_grid.schema.yml build/collision_grid.bin &
+    node export_imhex_pattern.js collision_grid.schema.yml generated/collision_grid.hexpat &
+
+    node export_c_header.js damage_event_pool.schema.yml generated/damage_event_pool.h generated/damage_event_pool_static.h &
+    node export_runtime_binary.js damage_event_pool.schema.yml build/damage_event_pool.bin &
+    node export_imhex_pattern.js damage_event_pool.schema.yml generated/damage_event_pool.hexpat &
+
+    node export_c_header.js collision_damage.schema.yml generated/collision_damage.h generated/collision_damage_static.h &
+    node export_runtime_binary.js collision_damage.schema.yml build/collision_damage.bin &
+    node export_imhex_pattern.js collision_damage.schema.yml generated/collision_damage.hexpat &
+
+    wait
+)
+
+node export_pack_binary.js world.pack.yml build/world.pack generated/world_pack.h || exit 1
+
+cd build
+
+if command -v cc >/dev/null; then
+    cc -g -std=gnu11 -fgnu89-inline -Wall -Wno-unused-function -Wno-missing-braces -pthread -I../generated ../headless_main.c -o headless_dm -lm
+    cc -O2 -g -std=gnu11 -fgnu89-inline -Wall -Wno-unused-function -Wno-missing-braces -pthread -I../generated ../headless_main.c -o headless_rm -DNDEBUG -lm
+    cc -O2 -g -std=gnu11 -fgnu89-inline -Wall -Wno-unused-function -Wno-missing-braces -pthread -I../generated ../headless_main.c -o headless_fx -DNDEBUG -DCOLLISION_FIXED_POINT -lm
+    cc -O2 -g -std=gnu11 -fgnu89-inline -Wall -Wno-unused-function -Wno-missing-braces -pthread -I../generated ../job_pool_test.c -o job_pool_test -lm
+    cc -O2 -g -std=gnu11 -fgnu89-inline -Wall -Wno-unused-function -Wno-missing-braces -pthread -I../generated ../collision_damage_test.c -o collision_damage_test -DNDEBUG -lm
+    cc -O2 -g -std=gnu11 -fgnu89-inline -Wall -Wno-unused-function -Wno-missing-braces -pthread -I../generated ../collision_grid_bench.c -o collision_grid_bench -DNDEBUG -lm
+fi
@@ -1,3 +1,6 @@
+// move runs one partition per live bit word, partitions never share a word
+#define kBulletsUpdateMovePartitionCount (kBulletsUpdateSourceBulletsMaxInstanceCount / 64)
+
 static void
 bullets_spawn(BulletsUpdateContext *context)
 {
@@ -25,16 +28,10 @@ bullets_spawn(BulletsUpdateContext *context)
     u8 *bullets_type_quantity = BulletsSourceBulletTypesQuantityPrt(bullets, bullet_types_sheet);
     u8 *bullets_type_index    = BulletsSourceBulletTypesBulletTypeIndexPrt(bullets, bullet_types_sheet);
 
-    BulletsUpdateBulletPositions *bullet_update_positions_sheet = BulletsUpdateBulletPositionsPrt(bullets_update);
-    v2 *bullets_update_positions       = (v2 *)BulletsUpdateBulletPositionsCurrentPositionPrt(bullets_update, bullet_update_positions_sheet);
-    v2 *bullets_update_end_positions   = (v2 *)BulletsUpdateBulletPositionsEndPositionPrt(bullets_update, bullet_update_positions_sheet);
-    uint8_t *bullets_update_type_index = BulletsUpdateBulletPositionsTypeIndexPrt(bullets_update, bullet_update_positions_sheet);
-
     BulletsUpdateSourceBullets *bullets_update_sheet                 = BulletsUpdateSourceBulletsPrt(bullets_update);
     BulletsUpdateSourceBulletsSpawnCount *bullets_update_spawn_count = BulletsUpdateSourceBulletsSpawnCountPrt(bullets_update, bullets_update_sheet);
 
     BulletSourceInstancesPositions *bullet_instances_positions_sheet = BulletSourceInstancesPositionsPrt(bullet_source_instances);
-    v2 *bullet_instances_positions                                   = (v2 *)BulletSourceInstancesPositionsPositionsPrt(bullet_source_instances, bullet_instances_positions_sheet);
 
     f32 bullet_end_length = 5.0f * max(kPlayAreaWidth, kPlayAreaHeight);
 
@@ -61,7 +58,7 @@ bullets_spawn(BulletsUpdateContext *context)
 
         f32 enemy_instance_time = play_clock_time - start_time;
 
-        v2 bullet_instance_position = bullet_instances_positions[wave_instance_index];
+        v2 bullet_instance_position = *(v2 *)BulletSourceInstancesPositionsPositionsAt(bullet_source_instances, bullet_instances_positions_sheet, wave_instance_index);
 
         BulletsSourceTypesSourceBulletTypes bullets_type = types_enemy_bullet_types[enemy_index];
 
@@ -128,9 +125,9 @@ bullets_spawn(BulletsUpdateContext *context)
             instances_reset_prt->InstancesReset[bullet_instance_word_index] |= 1ULL << bullet_instance_bit_index;
             instances_live_prt->InstancesLive[bullet_instance_word_index] |= 1ULL << bullet_instance_bit_index;
 
-            bullets_update_positions[bullet_instance_index] = spawn_position;
-            bullets_update_end_positions[bullet_instance_index] = end_position;
-            bullets_update_type_index[bullet_instance_index] = bullet_type_index;
+            *(v2 *)BulletsUpdateBulletPositionsCurrentPositionStaticAt(bullets_update, bullet_instance_index) = spawn_position;
+            *(v2 *)BulletsUpdateBulletPositionsEndPositionStaticAt(bullets_update, bullet_instance_index)     = end_position;
+            *BulletsUpdateBulletPositionsTypeIndexStaticAt(bullets_update, bullet_instance_index)             = bullet_type_index;
 
             (*bullet_positions_count_ptr)++;
             
@@ -140,7 +137,7 @@ bullets_spawn(BulletsUpdateContext *context)
 }
 
 static void
-bullets_move(BulletsUpdateContext *context)
+bullets_move(BulletsUpdateContext *context, u32 partition_index)
 {
     Bullets* bullets              = context->BulletsBin;
     BulletsUpdate *bullets_update = context->Root;
@@ -149,11 +146,6 @@ bullets_move(BulletsUpdateContext *context)
 
     f32 time_delta = *GameStateTimeDeltaPrt(game_state);
 
-    BulletsUpdateBulletPositions *bullet_update_positions_sheet = BulletsUpdateBulletPositionsPrt(bullets_update);
-    v2 *bullets_positions                                 = (v2 *)BulletsUpdateBulletPositionsCurrentPositionPrt(bullets_update, bullet_update_positions_sheet);
-    v2 *bullets_end_positions                             = (v2 *)BulletsUpdateBulletPositionsEndPositionPrt(bullets_update, bullet_update_positions_sheet);
-    uint8_t *bullets_type_index                           = BulletsUpdateBulletPositionsTypeIndexPrt(bullets_update, bullet_update_positions_sheet);
-
     BulletsBulletTypes *bullet_types_sheet = BulletsBulletTypesPrt(bullets);
 
     u8 *bullet_types_radius_q8         = BulletsBulletTypesRadiusQ8Prt(bullets, bullet_types_sheet);
@@ -165,13 +157,16 @@ bullets_move(BulletsUpdateContext *context)
 
     u16 update_count = min(bullet_positions_count, bullet_positions_capacity);
 
+    u32 partition_begin = partition_index * 64;
+    u32 partition_end   = min(partition_begin + 64, update_count);
+
     BulletsUpdateInstancesReset *instances_reset_prt = BulletsUpdateInstancesResetPrt(bullets_update);
     BulletsUpdateInstancesLive *instances_live_prt = BulletsUpdateInstancesLivePrt(bullets_update);
 
     CollisionInstancesDamageInstances *collision_instances_damage_instances_sheet = CollisionInstancesDamageInstancesPrt(collision_instances_damage_bin);
     u16 *instances_damage_prt = CollisionInstancesDamageInstancesDamagePrt(collision_instances_damage_bin, collision_instances_damage_instances_sheet);
 
-    for (u32 bullet_instance_index = 0; bullet_instance_index < update_count; bullet_instance_index++)
+    for (u32 bullet_instance_index = partition_begin; bullet_instance_index < partition_end; bullet_instance_index++)
     {
         u32 bullet_instance_word_index = bullet_instance_index / 64;
         u32 bullet_instance_bit_index = bullet_instance_index - (bullet_instance_word_index * 64);
@@ -183,9 +178,11 @@ bullets_move(BulletsUpdateContext *context)
 
         instances_reset_prt->InstancesReset[bullet_instance_word_index] &= ~(1ULL << bullet_instance_bit_index);
 
-        v2 bullet_position = bullets_positions[bullet_instance_index];
-        v2 bullet_end_position = bullets_end_positions[bullet_instance_index];
-        u8 bullet_type_index = bullets_type_index[bullet_instance_index];
+        v2 *bullet_position_prt = (v2 *)BulletsUpdateBulletPositionsCurrentPositionStaticAt(bullets_update, bullet_instance_index);
+
+        v2 bullet_position = *bullet_position_prt;
+        v2 bullet_end_position = *(v2 *)BulletsUpdateBulletPositionsEndPositionStaticAt(bullets_update, bullet_instance_index);
+        u8 bullet_type_index = *BulletsUpdateBulletPositionsTypeIndexStaticAt(bullets_update, bullet_instance_index);
 
         u8 bullet_radius_q8 = bullet_types_radius_q8[bullet_type_index];
         f32 bullet_radius = ((f32)bullet_radius_q8) * kQ8ToFloat;
@@ -222,12 +219,12 @@ bullets_move(BulletsUpdateContext *context)
         v2 move_v        = v2_scale(dv, source_bullet_frame_move_dist / dv_length);
         v2 move_position = v2_add(bullet_position, move_v);
 
-        bullets_positions[bullet_instance_index] = move_position;
+        *bullet_position_prt = move_position;
     }
 }
 
 static void
-bullets_update(BulletsUpdateContext *context)
+bullets_update_begin(BulletsUpdateContext *context)
 {
     BulletsUpdate *bullets_update = context->Root;
     PlayClock *play_clock         = context->PlayClockBin;
@@ -244,7 +241,4 @@ bullets_update(BulletsUpdateContext *context)
         memset(bullets_update_spawn_count, 0, sizeof(BulletsUpdateSourceBulletsSpawnCount) * kBulletsUpdateMaxInstancesPerWave);
         *bullet_positions_count_ptr = 0;
     }
-
-    bullets_move(context);
-    bullets_spawn(context);
-}
\ No newline at end of file
+}
@@ -0,0 +1,128 @@
+// Damage event log of one collision_damage instance, paged over the rows of a shared damage_event_pool.
+// Producer appends at write_sequence, every consumer reads from its own cursor and consumes in order.
+// A page goes back to the pool once every consumer has consumed past it,
+// so a burst in one interaction borrows pages other interactions are not using instead of dropping events.
+// Sequences are free running u32, page_row_count and the page table length are powers of two so they wrap cleanly.
+//
+// Producer (collision_damage_merge) and consumers (draw and stats in game_world_update) all run on the simulation thread,
+// the frame graph finishes merge before any consumer runs, so cursors are plain loads and stores.
+
+#define kCollisionDamageEventFull 0xffffffff
+
+static u32
+collision_damage_event_row(CollisionDamage *collision_damage_bin, u32 sequence)
+{
+    u8 *damage_event_pages_prt = CollisionDamageDamageEventPagesStaticPrt(collision_damage_bin)->DamageEventPages;
+
+    u32 page_sequence = sequence / kDamageEventPoolPageRowCount;
+    u32 page_index    = damage_event_pages_prt[page_sequence % kCollisionDamageMaxDamageEventPageCount];
+
+    return (page_index * kDamageEventPoolPageRowCount) + (sequence % kDamageEventPoolPageRowCount);
+}
+
+// returns pool row of the new event or kCollisionDamageEventFull when the pool has no free page, row is published right away
+static u32
+collision_damage_event_append(CollisionDamage *collision_damage_bin, DamageEventPool *damage_event_pool_bin)
+{
+    CollisionDamageDamageEventLog *log = CollisionDamageDamageEventLogStaticPrt(collision_damage_bin);
+
+    if ((log->WriteSequence % kDamageEventPoolPageRowCount) == 0)
+    {
+        u16 *allocated_page_count_prt = DamageEventPoolAllocatedPageCountStaticPrt(damage_event_pool_bin);
+        u16 *free_page_count_prt      = DamageEventPoolFreePageCountStaticPrt(damage_event_pool_bin);
+        u8 *free_pages_prt            = DamageEventPoolFreePagesStaticPrt(damage_event_pool_bin)->FreePages;
+
+        u32 log_page_count = (log->WriteSequence - log->HeadSequence) / kDamageEventPoolPageRowCount;
+
+        u32 page_index;
+        if (log_page_count >= kCollisionDamageMaxDamageEventPageCount)
+        {
+            page_index = kCollisionDamageEventFull;
+        }
+        else if (*free_page_count_prt > 0)
+        {
+            page_index = free_pages_prt[--(*free_page_count_prt)];
+        }
+        else if (*allocated_page_count_prt < kDamageEventPoolPageCount)
+        {
+            page_index = (*allocated_page_count_prt)++;
+        }
+        else
+        {
+            page_index = kCollisionDamageEventFull;
+        }
+
+        if (page_index == kCollisionDamageEventFull)
+        {
+            log->DroppedCount++;
+            return kCollisionDamageEventFull;
+        }
+
+        u32 page_sequence = log->WriteSequence / kDamageEventPoolPageRowCount;
+        CollisionDamageDamageEventPagesStaticPrt(collision_damage_bin)->DamageEventPages[page_sequence % kCollisionDamageMaxDamageEventPageCount] = (u8)page_index;
+    }
+
+    u32 row_index = collision_damage_event_row(collision_damage_bin, log->WriteSequence);
+    log->WriteSequence++;
+    return row_index;
+}
+
+static u32
+collision_damage_event_available(CollisionDamage *collision_damage_bin, u32 consumer_index)
+{
+    CollisionDamageDamageEventLog *log = CollisionDamageDamageEventLogStaticPrt(collision_damage_bin);
+    u32 cursor = CollisionDamageDamageEventCursorsStaticPrt(collision_damage_bin)->DamageEventCursors[consumer_index];
+
+    return log->WriteSequence - cursor;
+}
+
+// pool row of the event index places past the consumer cursor
+static u32
+collision_damage_event_peek(CollisionDamage *collision_damage_bin, u32 consumer_index, u32 index)
+{
+    u32 cursor = CollisionDamageDamageEventCursorsStaticPrt(collision_damage_bin)->DamageEventCursors[consumer_index];
+
+    return collision_damage_event_row(collision_damage_bin, cursor + index);
+}
+
+// head_sequence is always page aligned, pages before the oldest cursor go back to the pool
+// the page under write_sequence stays with the log until it is full, an idle log keeps at most that one page
+static void
+collision_damage_event_recycle(CollisionDamage *collision_damage_bin, DamageEventPool *damage_event_pool_bin)
+{
+    CollisionDamageDamageEventLog *log = CollisionDamageDamageEventLogStaticPrt(collision_damage_bin);
+    u32 *cursors_prt = CollisionDamageDamageEventCursorsStaticPrt(collision_damage_bin)->DamageEventCursors;
+    u8 *damage_event_pages_prt = CollisionDamageDamageEventPagesStaticPrt(collision_damage_bin)->DamageEventPages;
+
+    // distances from head keep the compare right across sequence wrap
+    u32 consumed_count = log->WriteSequence - log->HeadSequence;
+    for (u32 consumer_index = 0; consumer_index < kCollisionDamageDamageEventConsumerCount; consumer_index++)
+    {
+        consumed_count = min(consumed_count, cursors_prt[consumer_index] - log->HeadSequence);
+    }
+
+    u16 *free_page_count_prt = DamageEventPoolFreePageCountStaticPrt(damage_event_pool_bin);
+    u8 *free_pages_prt       = DamageEventPoolFreePagesStaticPrt(damage_event_pool_bin)->FreePages;
+
+    while (consumed_count >= kDamageEventPoolPageRowCount)
+    {
+        u32 page_sequence = log->HeadSequence / kDamageEventPoolPageRowCount;
+
+        Assert(*free_page_count_prt < kDamageEventPoolPageCount);
+        free_pages_prt[(*free_page_count_prt)++] = damage_event_pages_prt[page_sequence % kCollisionDamageMaxDamageEventPageCount];
+
+        log->HeadSequence += kDamageEventPoolPageRowCount;
+        consumed_count    -= kDamageEventPoolPageRowCount;
+    }
+}
+
+static void
+collision_damage_event_consume(CollisionDamage *collision_damage_bin, DamageEventPool *damage_event_pool_bin, u32 consumer_index, u32 count)
+{
+    u32 *cursors_prt = CollisionDamageDamageEventCursorsStaticPrt(collision_damage_bin)->DamageEventCursors;
+
+    Assert(count <= collision_damage_event_available(collision_damage_bin, consumer_index));
+    cursors_prt[consumer_index] += count;
+
+    collision_damage_event_recycle(collision_damage_bin, damage_event_pool_bin);
+}
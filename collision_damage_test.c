@@ -0,0 +1,315 @@
+// Test for the partitioned collision damage walk, built next to the headless executables by build_headless.sh and run from build:
+// two collision groups are piled into the first base rows, so partition 0 gets far more hits than partition_hit_capacity,
+// a few instances further down give the other partitions hits of their own.
+// Accumulated damage and hit count must match a brute force test of every pair,
+// and events must come out in the order of a walk over every partition, level pair and row.
+//
+// usage: collision_damage_test [world pack]
+
+#include <math.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "types.h"
+#include "math.h"
+#include "game_world.c"
+
+#define kCollisionDamageTestTypeCount     2
+#define kCollisionDamageTestTypeSmall     0
+#define kCollisionDamageTestTypeLarge     1
+#define kCollisionDamageTestRowWidth      kCollisionGridColCount
+#define kCollisionDamageTestMaxHitCount   (kCollisionDamagePartitionCount * kCollisionDamagePartitionHitCapacity * 16)
+
+#ifndef __cplusplus
+typedef struct CollisionDamageTestInstances CollisionDamageTestInstances;
+typedef struct CollisionDamageTestTypes     CollisionDamageTestTypes;
+#endif
+
+// source blobs laid out by hand, the root struct comes first so field offsets are blob offsets
+struct CollisionDamageTestInstances
+{
+    CollisionSourceInstances Root;
+    CollisionSourceInstancesSourceInstances Sheet;
+    u16 Count;
+    u16 Capacity;
+    u8 SourceTypeIndex[kCollisionGridMaxInstanceCount];
+    v2 Positions[kCollisionGridMaxInstanceCount];
+    u64 Reset[kCollisionGridMaxInstanceCount / 64];
+};
+
+struct CollisionDamageTestTypes
+{
+    CollisionSourceRadius RadiusRoot;
+    CollisionSourceRadiusSourceTypes RadiusSheet;
+    u16 Count;
+    u16 Capacity;
+    u8 RadiusQ4[kCollisionDamageTestTypeCount];
+
+    CollisionSourceDamage DamageRoot;
+    CollisionSourceDamageSourceTypes DamageSheet;
+    u16 DamageCount;
+    u16 DamageCapacity;
+    u16 Damage[kCollisionDamageTestTypeCount];
+};
+
+static void
+collision_damage_test_instances_init(CollisionDamageTestInstances *instances)
+{
+    memset(instances, 0, sizeof(CollisionDamageTestInstances));
+
+    instances->Root.SourceInstancesCountOffset    = (u16)offsetof(CollisionDamageTestInstances, Count);
+    instances->Root.SourceInstancesCapacityOffset = (u16)offsetof(CollisionDamageTestInstances, Capacity);
+    instances->Root.SourceInstancesOffset         = (u16)offsetof(CollisionDamageTestInstances, Sheet);
+    instances->Root.SourceInstancesResetOffset    = (u16)offsetof(CollisionDamageTestInstances, Reset);
+    instances->Sheet.SourceTypeIndexOffset        = (u16)offsetof(CollisionDamageTestInstances, SourceTypeIndex);
+    instances->Sheet.PositionsOffset              = (u16)offsetof(CollisionDamageTestInstances, Positions);
+    instances->Capacity                           = kCollisionGridMaxInstanceCount;
+}
+
+static void
+collision_damage_test_instances_add(CollisionDamageTestInstances *instances, u8 source_type_index, f32 x, f32 y)
+{
+    Assert(instances->Count < instances->Capacity);
+
+    instances->SourceTypeIndex[instances->Count] = source_type_index;
+    instances->Positions[instances->Count]       = V2(x, y);
+    instances->Count++;
+}
+
+// y of the center of a base row, row 0 is the top of the play area
+static f32
+collision_damage_test_row_y(u32 row_index)
+{
+    f32 row_height = (f32)kPlayAreaHeight / kCollisionGridRowCount;
+    return (f32)kPlayAreaHalfHeight - ((row_index + 0.5f) * row_height);
+}
+
+// a full row of small instances on each of the first four base rows and a full level 2 row of large ones over them,
+// every small instance overlaps the small ones of its row and all large ones, plus a few small pairs in partition 2
+static void
+collision_damage_test_instances_pile(CollisionDamageTestInstances *instances)
+{
+    for (u32 row_index = 0; row_index < 4; row_index++)
+    {
+        for (u32 col_index = 0; col_index < kCollisionDamageTestRowWidth; col_index++)
+        {
+            collision_damage_test_instances_add(instances, kCollisionDamageTestTypeSmall, 0.01f * col_index, collision_damage_test_row_y(row_index));
+        }
+    }
+
+    for (u32 col_index = 0; col_index < kCollisionDamageTestRowWidth; col_index++)
+    {
+        collision_damage_test_instances_add(instances, kCollisionDamageTestTypeLarge, 0.01f * col_index, collision_damage_test_row_y(2));
+    }
+
+    for (u32 col_index = 0; col_index < 4; col_index++)
+    {
+        collision_damage_test_instances_add(instances, kCollisionDamageTestTypeSmall, -1.0f + (0.05f * col_index), collision_damage_test_row_y(9));
+    }
+}
+
+static void
+collision_damage_test_types_init(CollisionDamageTestTypes *types, u16 small_damage, u16 large_damage)
+{
+    memset(types, 0, sizeof(CollisionDamageTestTypes));
+
+    u16 radius_root = (u16)offsetof(CollisionDamageTestTypes, RadiusRoot);
+    types->RadiusRoot.SourceTypesCountOffset    = (u16)offsetof(CollisionDamageTestTypes, Count) - radius_root;
+    types->RadiusRoot.SourceTypesCapacityOffset = (u16)offsetof(CollisionDamageTestTypes, Capacity) - radius_root;
+    types->RadiusRoot.SourceTypesOffset         = (u16)offsetof(CollisionDamageTestTypes, RadiusSheet) - radius_root;
+    types->RadiusSheet.RadiusQ4Offset           = (u16)offsetof(CollisionDamageTestTypes, RadiusQ4) - radius_root;
+    types->Count                                = kCollisionDamageTestTypeCount;
+    types->Capacity                             = kCollisionDamageTestTypeCount;
+
+    // 0.125 stays on level 0, 1.5 lands on level 2 and spans its first two rows
+    types->RadiusQ4[kCollisionDamageTestTypeSmall] = 2;
+    types->RadiusQ4[kCollisionDamageTestTypeLarge] = 24;
+
+    u16 damage_root = (u16)offsetof(CollisionDamageTestTypes, DamageRoot);
+    types->DamageRoot.SourceTypesCountOffset    = (u16)offsetof(CollisionDamageTestTypes, DamageCount) - damage_root;
+    types->DamageRoot.SourceTypesCapacityOffset = (u16)offsetof(CollisionDamageTestTypes, DamageCapacity) - damage_root;
+    types->DamageRoot.SourceTypesOffset         = (u16)offsetof(CollisionDamageTestTypes, DamageSheet) - damage_root;
+    types->DamageSheet.DamageOffset             = (u16)offsetof(CollisionDamageTestTypes, Damage) - damage_root;
+    types->DamageCount                          = kCollisionDamageTestTypeCount;
+    types->DamageCapacity                       = kCollisionDamageTestTypeCount;
+
+    types->Damage[kCollisionDamageTestTypeSmall] = small_damage;
+    types->Damage[kCollisionDamageTestTypeLarge] = large_damage;
+}
+
+static PackFile *
+collision_damage_test_load_pack(const char *file_name)
+{
+    FILE *file = fopen(file_name, "rb");
+    if (!file)
+    {
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    void *data = aligned_alloc(4096, ((size_t)size + 4095) & ~(size_t)4095);
+    b32 is_read = data && (fread(data, 1, (size_t)size, file) == (size_t)size);
+    fclose(file);
+
+    if (!is_read || !pack_file_valid((PackFile *)data, kWorldPackEntryCount))
+    {
+        free(data);
+        return NULL;
+    }
+    return (PackFile *)data;
+}
+
+static b32
+collision_damage_test_report(const char *name, b32 passed)
+{
+    printf("%-22s %s\n", name, passed ? "ok" : "FAILED");
+    return passed;
+}
+
+int
+main(int argument_count, char **arguments)
+{
+    const char *pack_file_name = (argument_count > 1) ? arguments[1] : "world.pack";
+
+    PackFile *world_pack = collision_damage_test_load_pack(pack_file_name);
+    if (!world_pack)
+    {
+        fprintf(stderr, "can not load %s\n", pack_file_name);
+        return 1;
+    }
+
+    LevelUpdate *level_update_bin             = (LevelUpdate *)pack_file_instance_prt(world_pack, kWorldPackLevelUpdate, 0);
+    CollisionGrid *a_collision_grid_bin       = (CollisionGrid *)pack_file_instance_prt(world_pack, kWorldPackCollisionGrid, 0);
+    CollisionGrid *b_collision_grid_bin       = (CollisionGrid *)pack_file_instance_prt(world_pack, kWorldPackCollisionGrid, 1);
+    CollisionDamage *collision_damage_bin     = (CollisionDamage *)pack_file_instance_prt(world_pack, kWorldPackCollisionDamage, 0);
+    DamageEventPool *damage_event_pool_bin    = (DamageEventPool *)pack_file_instance_prt(world_pack, kWorldPackDamageEventPool, 0);
+
+    Assert(CollisionGridStaticLayoutMatch(a_collision_grid_bin));
+    Assert(CollisionDamageStaticLayoutMatch(collision_damage_bin));
+    Assert(DamageEventPoolStaticLayoutMatch(damage_event_pool_bin));
+
+    *LevelUpdateStatePrt(level_update_bin) = 0;
+
+    static CollisionDamageTestInstances a_instances;
+    static CollisionDamageTestInstances b_instances;
+    static CollisionDamageTestTypes a_types;
+    static CollisionDamageTestTypes b_types;
+
+    collision_damage_test_instances_init(&a_instances);
+    collision_damage_test_instances_init(&b_instances);
+    collision_damage_test_instances_pile(&a_instances);
+    collision_damage_test_instances_pile(&b_instances);
+
+    // damage values are powers of two apart so a swapped pair shows up in the totals
+    collision_damage_test_types_init(&a_types, 1, 16);
+    collision_damage_test_types_init(&b_types, 256, 4096);
+
+    CollisionWorld collision_world;
+    collision_world_init(&collision_world, level_update_bin, damage_event_pool_bin);
+
+    u32 a_group_index = collision_world_add_group(&collision_world, a_collision_grid_bin, &a_instances.Root, &a_types.RadiusRoot, &a_types.DamageRoot);
+    u32 b_group_index = collision_world_add_group(&collision_world, b_collision_grid_bin, &b_instances.Root, &b_types.RadiusRoot, &b_types.DamageRoot);
+    u32 interaction_index = collision_world_add_interaction(&collision_world, a_group_index, b_group_index, collision_damage_bin);
+
+    CollisionDamageContext *context = &collision_world.Interactions[interaction_index].DamageContext;
+
+    collision_grid_update(&collision_world.Groups[a_group_index].GridContext);
+    collision_grid_update(&collision_world.Groups[b_group_index].GridContext);
+
+    collision_world_begin(&collision_world);
+    for (u32 partition_index = 0; partition_index < kCollisionDamagePartitionCount; partition_index++)
+    {
+        collision_world_partition(&collision_world, partition_index);
+    }
+
+    u16 partition_hit_count[kCollisionDamagePartitionCount];
+    memcpy(partition_hit_count, CollisionDamagePartitionHitCountStaticPrt(collision_damage_bin)->PartitionHitCount, sizeof(partition_hit_count));
+    u32 partition_0_overflow_count = CollisionDamagePartitionHitOverflowCountStaticPrt(collision_damage_bin)->PartitionHitOverflowCount[0];
+
+    collision_world_merge(&collision_world);
+
+    // every pair once, in any order
+    static u16 expected_a_damage[kCollisionGridMaxInstanceCount];
+    static u16 expected_b_damage[kCollisionGridMaxInstanceCount];
+    u32 expected_hit_count = 0;
+
+    for (u32 a_index = 0; a_index < a_instances.Count; a_index++)
+    {
+        for (u32 b_index = 0; b_index < b_instances.Count; b_index++)
+        {
+            f32 a_radius = a_types.RadiusQ4[a_instances.SourceTypeIndex[a_index]] * kQ4ToFloat;
+            f32 b_radius = b_types.RadiusQ4[b_instances.SourceTypeIndex[b_index]] * kQ4ToFloat;
+
+            if (v2_length(v2_sub(b_instances.Positions[b_index], a_instances.Positions[a_index])) < (a_radius + b_radius))
+            {
+                expected_a_damage[a_index] += b_types.Damage[b_instances.SourceTypeIndex[b_index]];
+                expected_b_damage[b_index] += a_types.Damage[a_instances.SourceTypeIndex[a_index]];
+                expected_hit_count++;
+            }
+        }
+    }
+
+    // walk order over every partition, level pair and row, as one serial walk would append them
+    static u8 walk_a_index[kCollisionDamageTestMaxHitCount];
+    static u8 walk_b_index[kCollisionDamageTestMaxHitCount];
+    u32 walk_hit_count = 0;
+
+    for (u32 partition_index = 0; partition_index < kCollisionDamagePartitionCount; partition_index++)
+    {
+        for (u32 a_level = 0; a_level < kCollisionGridLevelCount; a_level++)
+        {
+            for (u32 b_level = 0; b_level < kCollisionGridLevelCount; b_level++)
+            {
+                u32 fine_row_begin;
+                u32 fine_row_end;
+                collision_damage_partition_rows(partition_index, min(a_level, b_level), &fine_row_begin, &fine_row_end);
+
+                for (u32 fine_row_index = fine_row_begin; fine_row_index < fine_row_end; fine_row_index++)
+                {
+                    Assert((walk_hit_count + kCollisionDamageRowHitCapacity) <= kCollisionDamageTestMaxHitCount);
+                    walk_hit_count += collision_damage_row_hits(context, a_level, b_level, fine_row_index,
+                                                                walk_a_index + walk_hit_count, walk_b_index + walk_hit_count, kCollisionDamageRowHitCapacity);
+                }
+            }
+        }
+    }
+
+    u16 *accumulated_damage_a_value_prt = CollisionDamageAccumulatedDamageAValueStaticPrt(collision_damage_bin);
+    u16 *accumulated_damage_b_value_prt = CollisionDamageAccumulatedDamageBValueStaticPrt(collision_damage_bin);
+
+    b32 is_damage_match = (memcmp(accumulated_damage_a_value_prt, expected_a_damage, a_instances.Count * sizeof(u16)) == 0) &&
+                          (memcmp(accumulated_damage_b_value_prt, expected_b_damage, b_instances.Count * sizeof(u16)) == 0);
+
+    u8 *a_event_source_instance_index_prt = DamageEventPoolDamageEventsASourceInstanceIndexStaticPrt(damage_event_pool_bin);
+    u8 *b_event_source_instance_index_prt = DamageEventPoolDamageEventsBSourceInstanceIndexStaticPrt(damage_event_pool_bin);
+
+    CollisionDamageDamageEventLog *log = CollisionDamageDamageEventLogStaticPrt(collision_damage_bin);
+    u32 event_count = collision_damage_event_available(collision_damage_bin, kCollisionDamageDamageEventConsumerStats);
+
+    b32 is_order_match = (event_count <= walk_hit_count);
+    for (u32 event_index = 0; is_order_match && (event_index < event_count); event_index++)
+    {
+        u32 damage_index = collision_damage_event_peek(collision_damage_bin, kCollisionDamageDamageEventConsumerStats, event_index);
+        is_order_match = (a_event_source_instance_index_prt[damage_index] == walk_a_index[event_index]) &&
+                         (b_event_source_instance_index_prt[damage_index] == walk_b_index[event_index]);
+    }
+
+    b32 passed = 1;
+    passed &= collision_damage_test_report("partition 0 overflows", (partition_hit_count[0] == kCollisionDamagePartitionOverflowed) && (partition_0_overflow_count > 0));
+    passed &= collision_damage_test_report("partition 2 fits", (partition_hit_count[2] > 0) && (partition_hit_count[2] != kCollisionDamagePartitionOverflowed));
+    passed &= collision_damage_test_report("hit count", (walk_hit_count == expected_hit_count) && ((event_count + log->DroppedCount) == expected_hit_count));
+    passed &= collision_damage_test_report("accumulated damage", is_damage_match);
+    passed &= collision_damage_test_report("event order", is_order_match);
+
+    printf("hits %u (partition capacity %u), events %u, dropped %u, %s\n", expected_hit_count, kCollisionDamagePartitionHitCapacity,
+           event_count, log->DroppedCount, passed ? "passed" : "FAILED");
+
+    free(world_pack);
+
+    return passed ? 0 : 1;
+}
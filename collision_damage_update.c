@@ -1,64 +1,15 @@
+#define kCollisionDamagePartitionRowCount (kCollisionGridRowCount / kCollisionDamagePartitionCount)
+// a row holds at most col_count instances of each grid, so one row of one level pair has at most this many hits
+#define kCollisionDamageRowHitCapacity    (kCollisionGridColCount * kCollisionGridColCount)
+// partition hit count of a partition whose hits did not fit, merge walks its rows again
+#define kCollisionDamagePartitionOverflowed 0xffff
+
 static void
-collision_damage_update(CollisionDamageContext *context)
+collision_damage_begin(CollisionDamageContext *context)
 {
     CollisionDamage *collision_damage_bin = context->Root;
-    CollisionGrid *a_collision_grid_bin = context->ACollisionGridBin;
     CollisionSourceInstances *a_collision_source_instances_bin = context->ACollisionSourceInstancesBin;
-    CollisionSourceRadius *a_collision_source_radius_bin = context->ACollisionSourceRadiusBin;
-    CollisionSourceDamage *a_collision_source_damage_bin = context->ACollisionSourceDamageBin;
-    CollisionGrid *b_collision_grid_bin = context->BCollisionGridBin;
     CollisionSourceInstances *b_collision_source_instances_bin = context->BCollisionSourceInstancesBin;
-    CollisionSourceRadius *b_collision_source_radius_bin = context->BCollisionSourceRadiusBin;
-    CollisionSourceDamage *b_collision_source_damage_bin = context->BCollisionSourceDamageBin;
-    LevelUpdate *level_update_bin = context->LevelUpdateBin;
-
-    u16 *damage_events_count_prt = CollisionDamageDamageEventsCountPrt(collision_damage_bin);
-    u16 damage_events_capacity   = *CollisionDamageDamageEventsCapacityPrt(collision_damage_bin);
-    CollisionDamageDamageEvents *collision_damage_damage_events_sheet = CollisionDamageDamageEventsPrt(collision_damage_bin);
-    v2 *a_damage_position_prt = (v2*)CollisionDamageDamageEventsAPositionPrt(collision_damage_bin, collision_damage_damage_events_sheet);
-    v2 *b_damage_position_prt = (v2*)CollisionDamageDamageEventsBPositionPrt(collision_damage_bin, collision_damage_damage_events_sheet);
-    u16 *a_damage_value_prt = CollisionDamageDamageEventsAValuePrt(collision_damage_bin, collision_damage_damage_events_sheet);
-    u16 *b_damage_value_prt = CollisionDamageDamageEventsBValuePrt(collision_damage_bin, collision_damage_damage_events_sheet);
-    f32 *damage_time_prt = CollisionDamageDamageEventsTimePrt(collision_damage_bin, collision_damage_damage_events_sheet);
-    u8 *a_damage_source_instance_index_prt = CollisionDamageDamageEventsASourceInstanceIndexPrt(collision_damage_bin, collision_damage_damage_events_sheet);
-    u8 *b_damage_source_instance_index_prt = CollisionDamageDamageEventsBSourceInstanceIndexPrt(collision_damage_bin, collision_damage_damage_events_sheet);
-
-    CollisionSourceInstancesSourceInstances *a_collision_source_instances_source_instances_sheet = CollisionSourceInstancesSourceInstancesPrt(a_collision_source_instances_bin);
-    u8 *a_source_instances_source_type_index_prt = CollisionSourceInstancesSourceInstancesSourceTypeIndexPrt(a_collision_source_instances_bin, a_collision_source_instances_source_instances_sheet);
-    v2 *a_source_instances_positions_prt = (v2*)CollisionSourceInstancesSourceInstancesPositionsPrt(a_collision_source_instances_bin, a_collision_source_instances_source_instances_sheet);
-
-    CollisionSourceInstancesSourceInstances *b_collision_source_instances_source_instances_sheet = CollisionSourceInstancesSourceInstancesPrt(b_collision_source_instances_bin);
-    u8 *b_source_instances_source_type_index_prt = CollisionSourceInstancesSourceInstancesSourceTypeIndexPrt(b_collision_source_instances_bin, b_collision_source_instances_source_instances_sheet);
-    v2 *b_source_instances_positions_prt = (v2*)CollisionSourceInstancesSourceInstancesPositionsPrt(b_collision_source_instances_bin, b_collision_source_instances_source_instances_sheet);
-
-    CollisionGridGridRowCount *a_grid_row_count_prt = CollisionGridGridRowCountPrt(a_collision_grid_bin);
-    CollisionGridGridRows *a_grid_rows_prt = CollisionGridGridRowsPrt(a_collision_grid_bin);
-
-    CollisionGridGridRowCount *b_grid_row_count_prt = CollisionGridGridRowCountPrt(b_collision_grid_bin);
-    CollisionGridGridRows *b_grid_rows_prt = CollisionGridGridRowsPrt(b_collision_grid_bin);
-
-    CollisionSourceRadiusSourceTypes *a_collision_source_radius_source_types_sheet = CollisionSourceRadiusSourceTypesPrt(a_collision_source_radius_bin);
-    u8 *a_source_types_radius_q8_prt = CollisionSourceRadiusSourceTypesRadiusQ8Prt(a_collision_source_radius_bin, a_collision_source_radius_source_types_sheet);
-    u8 *a_source_types_radius_q4_prt = CollisionSourceRadiusSourceTypesRadiusQ4Prt(a_collision_source_radius_bin, a_collision_source_radius_source_types_sheet);
-
-    u8 *a_collision_source_radius_q = a_source_types_radius_q4_prt ? a_source_types_radius_q4_prt : a_source_types_radius_q8_prt;
-    f32 a_radius_multiplier = a_source_types_radius_q4_prt ? kQ4ToFloat : kQ8ToFloat;
-
-    CollisionSourceRadiusSourceTypes *b_collision_source_radius_source_types_sheet = CollisionSourceRadiusSourceTypesPrt(b_collision_source_radius_bin);
-    u8 *b_source_types_radius_q8_prt = CollisionSourceRadiusSourceTypesRadiusQ8Prt(b_collision_source_radius_bin, b_collision_source_radius_source_types_sheet);
-    u8 *b_source_types_radius_q4_prt = CollisionSourceRadiusSourceTypesRadiusQ4Prt(b_collision_source_radius_bin, b_collision_source_radius_source_types_sheet);
-
-    u8 *b_collision_source_radius_q = b_source_types_radius_q4_prt ? b_source_types_radius_q4_prt : b_source_types_radius_q8_prt;
-    f32 b_radius_multiplier = b_source_types_radius_q4_prt ? kQ4ToFloat : kQ8ToFloat;
-
-    CollisionSourceDamageSourceTypes *a_collision_source_damage_source_types_sheet = CollisionSourceDamageSourceTypesPrt(a_collision_source_damage_bin);
-    u16 *a_source_types_damage_prt = CollisionSourceDamageSourceTypesDamagePrt(a_collision_source_damage_bin, a_collision_source_damage_source_types_sheet);
-
-    CollisionSourceDamageSourceTypes *b_collision_source_damage_source_types_sheet = CollisionSourceDamageSourceTypesPrt(b_collision_source_damage_bin);
-    u16 *b_source_types_damage_prt = CollisionSourceDamageSourceTypesDamagePrt(b_collision_source_damage_bin, b_collision_source_damage_source_types_sheet);
-
-    f32 damage_time = *LevelUpdateTimePrt(level_update_bin);
-    u32 level_state_state = *LevelUpdateStatePrt(level_update_bin);
 
     u16 a_source_instances_count = *CollisionSourceInstancesSourceInstancesCountPrt(a_collision_source_instances_bin);
     u16 b_source_instances_count = *CollisionSourceInstancesSourceInstancesCountPrt(b_collision_source_instances_bin);
@@ -71,15 +22,14 @@ collision_damage_update(CollisionDamageContext *context)
     u64 *a_source_instances_reset_prt = CollisionSourceInstancesSourceInstancesResetPrt(a_collision_source_instances_bin);
     u64 *b_source_instances_reset_prt = CollisionSourceInstancesSourceInstancesResetPrt(b_collision_source_instances_bin);
 
-    CollisionDamageAccumulatedDamage *collision_damage_accumulated_damage_sheet = CollisionDamageAccumulatedDamagePrt(collision_damage_bin);
-    u16 *accumulated_damage_a_value_prt = CollisionDamageAccumulatedDamageAValuePrt(collision_damage_bin, collision_damage_accumulated_damage_sheet);
-    u16 *accumulated_damage_b_value_prt = CollisionDamageAccumulatedDamageBValuePrt(collision_damage_bin, collision_damage_accumulated_damage_sheet);
+    u16 *accumulated_damage_a_value_prt = CollisionDamageAccumulatedDamageAValueStaticPrt(collision_damage_bin);
+    u16 *accumulated_damage_b_value_prt = CollisionDamageAccumulatedDamageBValueStaticPrt(collision_damage_bin);
 
     for (u16 source_instance_index = 0; source_instance_index < a_source_instances_count; source_instance_index++)
     {
         u16 instance_word_index = source_instance_index / 64;
         u16 instance_bit_index = source_instance_index - (instance_word_index * 64);
-        
+
         b32 is_instance_reset = (a_source_instances_reset_prt[instance_word_index] & (1ULL << instance_bit_index)) != 0;
 
         if (is_instance_reset)
@@ -92,7 +42,7 @@ collision_damage_update(CollisionDamageContext *context)
     {
         u16 instance_word_index = source_instance_index / 64;
         u16 instance_bit_index = source_instance_index - (instance_word_index * 64);
-        
+
         b32 is_instance_reset = (b_source_instances_reset_prt[instance_word_index] & (1ULL << instance_bit_index)) != 0;
 
         if (is_instance_reset)
@@ -100,117 +50,312 @@ collision_damage_update(CollisionDamageContext *context)
             accumulated_damage_b_value_prt[source_instance_index] = 0;
         }
     }
+}
 
-    if (level_state_state & kLevelUpdateStateReset)
-    {
-        *damage_events_count_prt = 0;
-        return;
-    }
+// Finer rows of level fine_level owned by a partition: the ones whose first base row falls into the partition base row range.
+static void
+collision_damage_partition_rows(u32 partition_index, u32 fine_level, u32 *fine_row_begin, u32 *fine_row_end)
+{
+    Assert((kCollisionDamagePartitionRowCount * kCollisionDamagePartitionCount) == kCollisionGridRowCount);
+
+    u32 base_row_begin = partition_index * kCollisionDamagePartitionRowCount;
+    u32 base_row_end   = base_row_begin + kCollisionDamagePartitionRowCount;
+    u32 fine_row_size  = 1 << fine_level;
+
+    *fine_row_begin = (base_row_begin + fine_row_size - 1) >> fine_level;
+    *fine_row_end   = (base_row_end + fine_row_size - 1) >> fine_level;
+}
+
+// Tests a instances of a_level against b instances of b_level on one row of the finer level, the coarser row is the one containing it.
+// Both spans are contiguous, so a pair is recorded only in the first finer row where both instances are present.
+// Writes the first hit_capacity hits to the hit arrays and returns the number of hits on the row, which may be more.
+static u32
+collision_damage_row_hits(CollisionDamageContext *context, u32 a_level, u32 b_level, u32 fine_row_index,
+                          u8 *a_hit_source_instance_index_prt, u8 *b_hit_source_instance_index_prt, u32 hit_capacity)
+{
+    CollisionGrid *a_collision_grid_bin = context->ACollisionGridBin;
+    CollisionGrid *b_collision_grid_bin = context->BCollisionGridBin;
+
+    u32 a_level_row_offset = collision_grid_level_row_offset(a_level);
+    u32 b_level_row_offset = collision_grid_level_row_offset(b_level);
+
+    u32 fine_level    = min(a_level, b_level);
+    u32 a_level_shift = a_level - fine_level;
+    u32 b_level_shift = b_level - fine_level;
+
+    u32 a_row_grid_index = a_level_row_offset + (fine_row_index >> a_level_shift);
+    u32 b_row_grid_index = b_level_row_offset + (fine_row_index >> b_level_shift);
 
-    // up to 256(64 * 4) instances two buffers 
-    u64 a_instances_processed[4 * 2] = { 0 };
-    u64 b_instances_processed[4 * 2] = { 0 };
-    u8 instances_processed_index = 0;
+    u8 a_row_count = CollisionGridGridRowCountStaticPrt(a_collision_grid_bin)->GridRowCount[a_row_grid_index];
+    u8 b_row_count = CollisionGridGridRowCountStaticPrt(b_collision_grid_bin)->GridRowCount[b_row_grid_index];
 
-    for (u8 row_grid_index = 0; row_grid_index < kCollisionGridRowCount; row_grid_index++)
+    if ((a_row_count == 0) || (b_row_count == 0))
     {
-        u8 a_row_count = a_grid_row_count_prt->GridRowCount[row_grid_index];
-        u8 b_row_count = b_grid_row_count_prt->GridRowCount[row_grid_index];
+        return 0;
+    }
 
-        u8 *a_grid_row = &a_grid_rows_prt->GridRows[row_grid_index * kCollisionGridColCount];
-        u8 *b_grid_row = &b_grid_rows_prt->GridRows[row_grid_index * kCollisionGridColCount];
+    u8 *a_grid_row = &CollisionGridGridRowsStaticPrt(a_collision_grid_bin)->GridRows[a_row_grid_index * kCollisionGridColCount];
+    u8 *b_grid_row = &CollisionGridGridRowsStaticPrt(b_collision_grid_bin)->GridRows[b_row_grid_index * kCollisionGridColCount];
+
+    #ifdef COLLISION_FIXED_POINT
+    u16 *a_grid_instance_radius_q8_prt = CollisionGridInstanceRadiusQ8StaticPrt(a_collision_grid_bin)->InstanceRadiusQ8;
+    u16 *b_grid_instance_radius_q8_prt = CollisionGridInstanceRadiusQ8StaticPrt(b_collision_grid_bin)->InstanceRadiusQ8;
+    s32 *a_grid_instance_position_x_q8_prt = CollisionGridInstancePositionQ8StaticPrt(a_collision_grid_bin)->X;
+    s32 *a_grid_instance_position_y_q8_prt = CollisionGridInstancePositionQ8StaticPrt(a_collision_grid_bin)->Y;
+    s32 *b_grid_instance_position_x_q8_prt = CollisionGridInstancePositionQ8StaticPrt(b_collision_grid_bin)->X;
+    s32 *b_grid_instance_position_y_q8_prt = CollisionGridInstancePositionQ8StaticPrt(b_collision_grid_bin)->Y;
+    #else
+    CollisionSourceInstances *a_collision_source_instances_bin = context->ACollisionSourceInstancesBin;
+    CollisionSourceInstances *b_collision_source_instances_bin = context->BCollisionSourceInstancesBin;
 
-        u8 prev_instances_processed_offset = instances_processed_index * 4;
-        u8 next_instances_processed_offset = (instances_processed_index^1) * 4;
+    CollisionSourceInstancesSourceInstances *a_collision_source_instances_source_instances_sheet = CollisionSourceInstancesSourceInstancesPrt(a_collision_source_instances_bin);
 
-        u64 *a_prev_instances_processed = &a_instances_processed[prev_instances_processed_offset];
-        u64 *a_next_instances_processed = &a_instances_processed[next_instances_processed_offset];
+    CollisionSourceInstancesSourceInstances *b_collision_source_instances_source_instances_sheet = CollisionSourceInstancesSourceInstancesPrt(b_collision_source_instances_bin);
 
-        u64 *b_prev_instances_processed = &b_instances_processed[prev_instances_processed_offset];
-        u64 *b_next_instances_processed = &b_instances_processed[next_instances_processed_offset];
+    f32 *a_grid_instance_radius_prt = CollisionGridInstanceRadiusStaticPrt(a_collision_grid_bin)->InstanceRadius;
+    f32 *b_grid_instance_radius_prt = CollisionGridInstanceRadiusStaticPrt(b_collision_grid_bin)->InstanceRadius;
+    #endif
 
-        a_next_instances_processed[0] = 0;
-        a_next_instances_processed[1] = 0;
-        a_next_instances_processed[2] = 0;
-        a_next_instances_processed[3] = 0;
+    u8 *a_grid_instance_row_begin_prt = CollisionGridInstanceRowBeginStaticPrt(a_collision_grid_bin)->InstanceRowBegin;
+    u8 *b_grid_instance_row_begin_prt = CollisionGridInstanceRowBeginStaticPrt(b_collision_grid_bin)->InstanceRowBegin;
 
-        b_next_instances_processed[0] = 0;
-        b_next_instances_processed[1] = 0;
-        b_next_instances_processed[2] = 0;
-        b_next_instances_processed[3] = 0;
+    u32 hit_count = 0;
 
-        for (u8 a_col_index = 0; a_col_index < a_row_count; a_col_index++)
+    for (u8 a_col_index = 0; a_col_index < a_row_count; a_col_index++)
+    {
+        u8 a_source_instance_index = a_grid_row[a_col_index];
+        #ifdef COLLISION_FIXED_POINT
+        s32 a_instance_position_x_q8 = a_grid_instance_position_x_q8_prt[a_source_instance_index];
+        s32 a_instance_position_y_q8 = a_grid_instance_position_y_q8_prt[a_source_instance_index];
+        s32 a_instance_radius_q8 = a_grid_instance_radius_q8_prt[a_source_instance_index];
+        #else
+        v2 a_source_instances_position = *(v2*)CollisionSourceInstancesSourceInstancesPositionsAt(a_collision_source_instances_bin, a_collision_source_instances_source_instances_sheet, a_source_instance_index);
+        f32 a_instance_radius = a_grid_instance_radius_prt[a_source_instance_index];
+        #endif
+
+        u32 a_fine_row_first = (a_grid_instance_row_begin_prt[a_source_instance_index] - a_level_row_offset) << a_level_shift;
+
+        for (u8 b_col_index = 0; b_col_index < b_row_count; b_col_index++)
         {
-            u8 a_source_instance_index = a_grid_row[a_col_index];
-            u8 a_source_type_index = a_source_instances_source_type_index_prt[a_source_instance_index];
-            v2 a_source_instances_position = a_source_instances_positions_prt[a_source_instance_index];
+            u8 b_source_instance_index = b_grid_row[b_col_index];
 
-            u8 a_instance_radius_q = a_collision_source_radius_q[a_source_type_index];
-            f32 a_instance_radius = ((f32)a_instance_radius_q) * a_radius_multiplier;
+            u32 b_fine_row_first = (b_grid_instance_row_begin_prt[b_source_instance_index] - b_level_row_offset) << b_level_shift;
 
-            u16 a_source_damage = a_source_types_damage_prt[a_source_type_index];
+            b32 is_pair_processed = max(a_fine_row_first, b_fine_row_first) != fine_row_index;
+            if (is_pair_processed)
+            {
+                continue;
+            }
 
-            u16 a_instance_word_index = a_source_instance_index / 64;
-            u16 a_instance_bit_index = a_source_instance_index - (a_instance_word_index * 64);
+            #ifdef COLLISION_FIXED_POINT
+            // grid positions are clamped to +-32 units, squared Q8 distances and radius sums fit in 32 bits
+            s32 v_ab_x_q8 = b_grid_instance_position_x_q8_prt[b_source_instance_index] - a_instance_position_x_q8;
+            s32 v_ab_y_q8 = b_grid_instance_position_y_q8_prt[b_source_instance_index] - a_instance_position_y_q8;
+            s32 radius_sum_q8 = a_instance_radius_q8 + b_grid_instance_radius_q8_prt[b_source_instance_index];
 
-            b32 is_a_processed = (a_prev_instances_processed[a_instance_word_index] & (1ULL << a_instance_bit_index)) != 0;
+            b32 is_hit = (u32)((v_ab_x_q8 * v_ab_x_q8) + (v_ab_y_q8 * v_ab_y_q8)) < (u32)(radius_sum_q8 * radius_sum_q8);
+            #else
+            v2 b_source_instances_position = *(v2*)CollisionSourceInstancesSourceInstancesPositionsAt(b_collision_source_instances_bin, b_collision_source_instances_source_instances_sheet, b_source_instance_index);
+            f32 b_instance_radius = b_grid_instance_radius_prt[b_source_instance_index];
 
-            a_next_instances_processed[a_instance_word_index] |= (1ULL << a_instance_bit_index);
+            v2 v_ab = v2_sub(b_source_instances_position, a_source_instances_position);
+            f32 v_ab_length = v2_length(v_ab);
 
-            for (u8 b_col_index = 0; b_col_index < b_row_count; b_col_index++)
+            b32 is_hit = v_ab_length < (a_instance_radius + b_instance_radius);
+            #endif
+
+            if (!is_hit)
             {
-                u8 b_source_instance_index = b_grid_row[b_col_index];
-                u8 b_source_type_index = b_source_instances_source_type_index_prt[b_source_instance_index];
-                v2 b_source_instances_position = b_source_instances_positions_prt[b_source_instance_index];
+                continue;
+            }
 
-                u8 b_instance_radius_q = b_collision_source_radius_q[b_source_type_index];
-                f32 b_instance_radius = ((f32)b_instance_radius_q) * b_radius_multiplier;
+            if (hit_count < hit_capacity)
+            {
+                a_hit_source_instance_index_prt[hit_count] = a_source_instance_index;
+                b_hit_source_instance_index_prt[hit_count] = b_source_instance_index;
+            }
+            hit_count++;
+        }
+    }
 
-                u16 b_source_damage = b_source_types_damage_prt[b_source_type_index];
+    return hit_count;
+}
 
-                u16 b_instance_word_index = b_source_instance_index / 64;
-                u16 b_instance_bit_index = b_source_instance_index - (b_instance_word_index * 64);
+// Appends hits of one row to the partition hit range.
+// partition_hit_capacity is not a bound across all level pairs (that is 13275 hits, past a u16 sized blob),
+// once a row does not fit, the partition is marked overflowed for merge to walk its rows again,
+// partition_hit_overflow_count keeps a running total of hits that did not fit.
+static void
+collision_damage_row(CollisionDamageContext *context, u32 partition_index, u32 a_level, u32 b_level, u32 fine_row_index)
+{
+    CollisionDamage *collision_damage_bin = context->Root;
 
-                b32 is_b_processed = (b_prev_instances_processed[b_instance_word_index] & (1ULL << b_instance_bit_index)) != 0;
+    u16 *partition_hit_count_prt = CollisionDamagePartitionHitCountStaticPrt(collision_damage_bin)->PartitionHitCount;
+    u32 *partition_hit_overflow_count_prt = CollisionDamagePartitionHitOverflowCountStaticPrt(collision_damage_bin)->PartitionHitOverflowCount;
+    u8 *a_hit_source_instance_index_prt = CollisionDamagePartitionHitsASourceInstanceIndexStaticPrt(collision_damage_bin) + (partition_index * kCollisionDamagePartitionHitCapacity);
+    u8 *b_hit_source_instance_index_prt = CollisionDamagePartitionHitsBSourceInstanceIndexStaticPrt(collision_damage_bin) + (partition_index * kCollisionDamagePartitionHitCapacity);
 
-                b_next_instances_processed[b_instance_word_index] |= (1ULL << b_instance_bit_index);
+    u32 hit_count = partition_hit_count_prt[partition_index];
+    b32 is_overflowed = hit_count == kCollisionDamagePartitionOverflowed;
 
-                v2 v_ab = v2_sub(b_source_instances_position, a_source_instances_position);
-                f32 v_ab_length = v2_length(v_ab);
+    hit_count = is_overflowed ? kCollisionDamagePartitionHitCapacity : hit_count;
 
-                if (v_ab_length < (a_instance_radius + b_instance_radius))
-                {
-                    b32 is_pair_processed = is_a_processed && is_b_processed;
-                    if (!is_pair_processed)
-                    {
-                        v2 v_a_damage = v2_scale(v_ab, a_instance_radius / v_ab_length);
-                        v2 v_b_damage = v2_scale(v_ab, b_instance_radius / v_ab_length);
+    u32 hit_capacity = kCollisionDamagePartitionHitCapacity - hit_count;
+    u32 row_hit_count = collision_damage_row_hits(context, a_level, b_level, fine_row_index,
+                                                  a_hit_source_instance_index_prt + hit_count, b_hit_source_instance_index_prt + hit_count, hit_capacity);
+
+    if (!is_overflowed && (row_hit_count <= hit_capacity))
+    {
+        partition_hit_count_prt[partition_index] = (u16)(hit_count + row_hit_count);
+    }
+    else
+    {
+        partition_hit_count_prt[partition_index] = kCollisionDamagePartitionOverflowed;
+        partition_hit_overflow_count_prt[partition_index] += row_hit_count;
+    }
+}
 
-                        v2 a_damage_position = v2_add(a_source_instances_position, v_a_damage);
-                        v2 b_damage_position = v2_sub(b_source_instances_position, v_b_damage);
+// Applies damage and appends events for hits in order.
+static void
+collision_damage_apply(CollisionDamageContext *context, u8 *a_hit_source_instance_index_prt, u8 *b_hit_source_instance_index_prt, u32 hit_count)
+{
+    CollisionDamage *collision_damage_bin = context->Root;
+    CollisionGrid *a_collision_grid_bin = context->ACollisionGridBin;
+    CollisionSourceInstances *a_collision_source_instances_bin = context->ACollisionSourceInstancesBin;
+    CollisionSourceDamage *a_collision_source_damage_bin = context->ACollisionSourceDamageBin;
+    CollisionGrid *b_collision_grid_bin = context->BCollisionGridBin;
+    CollisionSourceInstances *b_collision_source_instances_bin = context->BCollisionSourceInstancesBin;
+    CollisionSourceDamage *b_collision_source_damage_bin = context->BCollisionSourceDamageBin;
+    LevelUpdate *level_update_bin = context->LevelUpdateBin;
+
+    DamageEventPool *damage_event_pool_bin = context->DamageEventPoolBin;
+
+    v2 *a_damage_position_prt = (v2*)DamageEventPoolDamageEventsAPositionStaticPrt(damage_event_pool_bin);
+    v2 *b_damage_position_prt = (v2*)DamageEventPoolDamageEventsBPositionStaticPrt(damage_event_pool_bin);
+    u16 *a_damage_value_prt = DamageEventPoolDamageEventsAValueStaticPrt(damage_event_pool_bin);
+    u16 *b_damage_value_prt = DamageEventPoolDamageEventsBValueStaticPrt(damage_event_pool_bin);
+    f32 *damage_time_prt = DamageEventPoolDamageEventsTimeStaticPrt(damage_event_pool_bin);
+    u8 *a_damage_source_instance_index_prt = DamageEventPoolDamageEventsASourceInstanceIndexStaticPrt(damage_event_pool_bin);
+    u8 *b_damage_source_instance_index_prt = DamageEventPoolDamageEventsBSourceInstanceIndexStaticPrt(damage_event_pool_bin);
+
+    CollisionSourceInstancesSourceInstances *a_collision_source_instances_source_instances_sheet = CollisionSourceInstancesSourceInstancesPrt(a_collision_source_instances_bin);
+
+    CollisionSourceInstancesSourceInstances *b_collision_source_instances_source_instances_sheet = CollisionSourceInstancesSourceInstancesPrt(b_collision_source_instances_bin);
 
-                        u16 damage_index = (*damage_events_count_prt) % damage_events_capacity;
+    f32 *a_grid_instance_radius_prt = CollisionGridInstanceRadiusStaticPrt(a_collision_grid_bin)->InstanceRadius;
+    f32 *b_grid_instance_radius_prt = CollisionGridInstanceRadiusStaticPrt(b_collision_grid_bin)->InstanceRadius;
 
-                        a_damage_value_prt[damage_index] = b_source_damage;
-                        b_damage_value_prt[damage_index] = a_source_damage;
+    CollisionSourceDamageSourceTypes *a_collision_source_damage_source_types_sheet = CollisionSourceDamageSourceTypesPrt(a_collision_source_damage_bin);
+    u16 *a_source_types_damage_prt = CollisionSourceDamageSourceTypesDamagePrt(a_collision_source_damage_bin, a_collision_source_damage_source_types_sheet);
+
+    CollisionSourceDamageSourceTypes *b_collision_source_damage_source_types_sheet = CollisionSourceDamageSourceTypesPrt(b_collision_source_damage_bin);
+    u16 *b_source_types_damage_prt = CollisionSourceDamageSourceTypesDamagePrt(b_collision_source_damage_bin, b_collision_source_damage_source_types_sheet);
+
+    u16 *accumulated_damage_a_value_prt = CollisionDamageAccumulatedDamageAValueStaticPrt(collision_damage_bin);
+    u16 *accumulated_damage_b_value_prt = CollisionDamageAccumulatedDamageBValueStaticPrt(collision_damage_bin);
+
+    f32 damage_time = *LevelUpdateTimePrt(level_update_bin);
 
-                        damage_time_prt[damage_index] = damage_time;
+    for (u32 hit_index = 0; hit_index < hit_count; hit_index++)
+    {
+        u8 a_source_instance_index = a_hit_source_instance_index_prt[hit_index];
+        u8 b_source_instance_index = b_hit_source_instance_index_prt[hit_index];
+
+        u8 a_source_type_index = *CollisionSourceInstancesSourceInstancesSourceTypeIndexAt(a_collision_source_instances_bin, a_collision_source_instances_source_instances_sheet, a_source_instance_index);
+        v2 a_source_instances_position = *(v2*)CollisionSourceInstancesSourceInstancesPositionsAt(a_collision_source_instances_bin, a_collision_source_instances_source_instances_sheet, a_source_instance_index);
+
+        u8 b_source_type_index = *CollisionSourceInstancesSourceInstancesSourceTypeIndexAt(b_collision_source_instances_bin, b_collision_source_instances_source_instances_sheet, b_source_instance_index);
+        v2 b_source_instances_position = *(v2*)CollisionSourceInstancesSourceInstancesPositionsAt(b_collision_source_instances_bin, b_collision_source_instances_source_instances_sheet, b_source_instance_index);
+
+        f32 a_instance_radius = a_grid_instance_radius_prt[a_source_instance_index];
+        f32 b_instance_radius = b_grid_instance_radius_prt[b_source_instance_index];
 
-                        a_damage_position_prt[damage_index] = a_damage_position;
-                        b_damage_position_prt[damage_index] = b_damage_position;
+        u16 a_source_damage = a_source_types_damage_prt[a_source_type_index];
+        u16 b_source_damage = b_source_types_damage_prt[b_source_type_index];
 
-                        a_damage_source_instance_index_prt[damage_index] = a_source_instance_index;
-                        b_damage_source_instance_index_prt[damage_index] = b_source_instance_index;
+        v2 v_ab = v2_sub(b_source_instances_position, a_source_instances_position);
+        f32 v_ab_length = v2_length(v_ab);
 
-                        accumulated_damage_a_value_prt[a_source_instance_index] += b_source_damage;
-                        accumulated_damage_b_value_prt[b_source_instance_index] += a_source_damage;
+        v2 v_a_damage = v2_scale(v_ab, a_instance_radius / v_ab_length);
+        v2 v_b_damage = v2_scale(v_ab, b_instance_radius / v_ab_length);
 
-                        (*damage_events_count_prt)++;
-                    }
+        v2 a_damage_position = v2_add(a_source_instances_position, v_a_damage);
+        v2 b_damage_position = v2_sub(b_source_instances_position, v_b_damage);
+
+        accumulated_damage_a_value_prt[a_source_instance_index] += b_source_damage;
+        accumulated_damage_b_value_prt[b_source_instance_index] += a_source_damage;
+
+        // damage is applied even when the pool runs out of pages and the event is dropped
+        u32 damage_index = collision_damage_event_append(collision_damage_bin, damage_event_pool_bin);
+        if (damage_index == kCollisionDamageEventFull)
+        {
+            continue;
+        }
+
+        a_damage_value_prt[damage_index] = b_source_damage;
+        b_damage_value_prt[damage_index] = a_source_damage;
+
+        damage_time_prt[damage_index] = damage_time;
+
+        a_damage_position_prt[damage_index] = a_damage_position;
+        b_damage_position_prt[damage_index] = b_damage_position;
+
+        a_damage_source_instance_index_prt[damage_index] = a_source_instance_index;
+        b_damage_source_instance_index_prt[damage_index] = b_source_instance_index;
+    }
+}
+
+// Appends hits of all partitions in partition order, events and accumulated damage match a single walk over all rows.
+// An overflowed partition walks its rows again here one row at a time, so no hit is lost.
+static void
+collision_damage_merge(CollisionDamageContext *context)
+{
+    CollisionDamage *collision_damage_bin = context->Root;
+    LevelUpdate *level_update_bin = context->LevelUpdateBin;
+
+    u16 *partition_hit_count_prt = CollisionDamagePartitionHitCountStaticPrt(collision_damage_bin)->PartitionHitCount;
+    u8 *a_hit_source_instance_index_prt = CollisionDamagePartitionHitsASourceInstanceIndexStaticPrt(collision_damage_bin);
+    u8 *b_hit_source_instance_index_prt = CollisionDamagePartitionHitsBSourceInstanceIndexStaticPrt(collision_damage_bin);
+
+    u32 level_state_state = *LevelUpdateStatePrt(level_update_bin);
+
+    if (level_state_state & kLevelUpdateStateReset)
+    {
+        return;
+    }
+
+    for (u32 partition_index = 0; partition_index < kCollisionDamagePartitionCount; partition_index++)
+    {
+        u16 hit_count = partition_hit_count_prt[partition_index];
+        u32 hit_offset = partition_index * kCollisionDamagePartitionHitCapacity;
+
+        if (hit_count != kCollisionDamagePartitionOverflowed)
+        {
+            collision_damage_apply(context, a_hit_source_instance_index_prt + hit_offset, b_hit_source_instance_index_prt + hit_offset, hit_count);
+            continue;
+        }
+
+        // same level pair and row order as collision_world_partition
+        for (u32 a_level = 0; a_level < kCollisionGridLevelCount; a_level++)
+        {
+            for (u32 b_level = 0; b_level < kCollisionGridLevelCount; b_level++)
+            {
+                u32 fine_row_begin;
+                u32 fine_row_end;
+                collision_damage_partition_rows(partition_index, min(a_level, b_level), &fine_row_begin, &fine_row_end);
+
+                for (u32 fine_row_index = fine_row_begin; fine_row_index < fine_row_end; fine_row_index++)
+                {
+                    u8 a_row_hit_source_instance_index[kCollisionDamageRowHitCapacity];
+                    u8 b_row_hit_source_instance_index[kCollisionDamageRowHitCapacity];
+
+                    u32 row_hit_count = collision_damage_row_hits(context, a_level, b_level, fine_row_index,
+                                                                  a_row_hit_source_instance_index, b_row_hit_source_instance_index, kCollisionDamageRowHitCapacity);
+                    Assert(row_hit_count <= kCollisionDamageRowHitCapacity);
+
+                    collision_damage_apply(context, a_row_hit_source_instance_index, b_row_hit_source_instance_index, row_hit_count);
                 }
             }
         }
-
-        instances_processed_index ^= 1;
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,261 @@
+// Benchmark of the per-frame collision grid builds, built next to the headless executables by build_headless.sh and run from build:
+// both bullet groups of the game world are filled to capacity and moved every frame, then the four collision_grid_update calls
+// run once serially and once as four frame graph systems on a job pool, over the same motion.
+// Grids must come out identical both ways.
+//
+// usage: collision_grid_bench [frame count] [worker count] [bullet speed per frame]
+
+#include <math.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "types.h"
+#include "math.h"
+#include "game_world.c"
+
+#ifndef __cplusplus
+typedef struct CollisionGridBenchBullets CollisionGridBenchBullets;
+#endif
+
+struct CollisionGridBenchBullets
+{
+    CollisionSourceInstances *SourceInstancesBin;
+    v2 Start[kCollisionGridMaxInstanceCount];
+    v2 Velocity[kCollisionGridMaxInstanceCount];
+};
+
+static u32
+collision_grid_bench_random(u32 *state)
+{
+    *state = (*state * 1664525u) + 1013904223u;
+    return *state >> 8;
+}
+
+static f32
+collision_grid_bench_random_range(u32 *state, f32 low, f32 high)
+{
+    return low + ((high - low) * ((f32)collision_grid_bench_random(state) / (f32)(1 << 24)));
+}
+
+// every slot live, random type, position and direction
+static void
+collision_grid_bench_bullets_init(CollisionGridBenchBullets *bullets, CollisionSourceInstances *source_instances_bin, CollisionSourceRadius *source_radius_bin, f32 speed, u32 *state)
+{
+    bullets->SourceInstancesBin = source_instances_bin;
+
+    u16 capacity   = min(*CollisionSourceInstancesSourceInstancesCapacityPrt(source_instances_bin), kCollisionGridMaxInstanceCount);
+    u16 type_count = *CollisionSourceRadiusSourceTypesCountPrt(source_radius_bin);
+
+    CollisionSourceInstancesSourceInstances *sheet = CollisionSourceInstancesSourceInstancesPrt(source_instances_bin);
+    u64 *enabled_prt = CollisionSourceInstancesSourceInstancesEnabledPrt(source_instances_bin);
+
+    *CollisionSourceInstancesSourceInstancesCountPrt(source_instances_bin) = capacity;
+
+    for (u16 instance_index = 0; instance_index < capacity; instance_index++)
+    {
+        if (enabled_prt)
+        {
+            enabled_prt[instance_index / 64] |= 1ULL << (instance_index % 64);
+        }
+
+        *CollisionSourceInstancesSourceInstancesSourceTypeIndexAt(source_instances_bin, sheet, instance_index) = (u8)(collision_grid_bench_random(state) % max(type_count, 1));
+
+        f32 angle = collision_grid_bench_random_range(state, 0.0f, 6.2831853f);
+        bullets->Start[instance_index]    = V2(collision_grid_bench_random_range(state, -kPlayAreaHalfWidth, kPlayAreaHalfWidth),
+                                               collision_grid_bench_random_range(state, -kPlayAreaHalfHeight, kPlayAreaHalfHeight));
+        bullets->Velocity[instance_index] = V2(cosf(angle) * speed, sinf(angle) * speed);
+    }
+}
+
+// positions of a frame depend only on the frame index, so both runs see the same motion
+static void
+collision_grid_bench_bullets_move(CollisionGridBenchBullets *bullets, u32 frame_index)
+{
+    CollisionSourceInstances *source_instances_bin = bullets->SourceInstancesBin;
+    CollisionSourceInstancesSourceInstances *sheet = CollisionSourceInstancesSourceInstancesPrt(source_instances_bin);
+
+    u16 count = *CollisionSourceInstancesSourceInstancesCountPrt(source_instances_bin);
+    for (u16 instance_index = 0; instance_index < count; instance_index++)
+    {
+        v2 position = v2_add(bullets->Start[instance_index], v2_scale(bullets->Velocity[instance_index], (f32)frame_index));
+
+        // wrap around the play area with a margin, so some bullets are always entering or leaving
+        position.x = fmodf(position.x + kPlayAreaWidth + 4.0f, kPlayAreaWidth + 2.0f) - (kPlayAreaHalfWidth + 1.0f);
+        position.y = fmodf(position.y + kPlayAreaHeight + 4.0f, kPlayAreaHeight + 2.0f) - (kPlayAreaHalfHeight + 1.0f);
+
+        *(v2 *)CollisionSourceInstancesSourceInstancesPositionsAt(source_instances_bin, sheet, instance_index) = position;
+    }
+}
+
+static PackFile *
+collision_grid_bench_load_pack(const char *file_name)
+{
+    FILE *file = fopen(file_name, "rb");
+    if (!file)
+    {
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    void *data = aligned_alloc(4096, ((size_t)size + 4095) & ~(size_t)4095);
+    b32 is_read = data && (fread(data, 1, (size_t)size, file) == (size_t)size);
+    fclose(file);
+
+    if (!is_read || !pack_file_valid((PackFile *)data, kWorldPackEntryCount))
+    {
+        free(data);
+        return NULL;
+    }
+    return (PackFile *)data;
+}
+
+static void
+collision_grid_bench_reset(CollisionWorld *collision_world)
+{
+    for (u32 group_index = 0; group_index < collision_world->GroupCount; group_index++)
+    {
+        CollisionGrid *collision_grid = collision_world->Groups[group_index].GridContext.Root;
+        memset(CollisionGridGridRowCountStaticPrt(collision_grid), 0, sizeof(CollisionGridGridRowCount));
+        memset(CollisionGridInstanceRowBeginStaticPrt(collision_grid), 0, sizeof(CollisionGridInstanceRowBegin));
+        memset(CollisionGridInstanceRowEndStaticPrt(collision_grid), 0, sizeof(CollisionGridInstanceRowEnd));
+        *CollisionGridInstanceCountStaticPrt(collision_grid) = 0;
+    }
+}
+
+static u64
+collision_grid_bench_checksum(CollisionWorld *collision_world)
+{
+    u64 checksum = 14695981039346656037ULL;
+    for (u32 group_index = 0; group_index < collision_world->GroupCount; group_index++)
+    {
+        CollisionGrid *collision_grid = collision_world->Groups[group_index].GridContext.Root;
+
+        u8 *row_counts = CollisionGridGridRowCountStaticPrt(collision_grid)->GridRowCount;
+        u8 *rows       = CollisionGridGridRowsStaticPrt(collision_grid)->GridRows;
+        for (u32 row_index = 0; row_index < (kCollisionGridRowCount * 2); row_index++)
+        {
+            for (u32 col_index = 0; col_index < row_counts[row_index]; col_index++)
+            {
+                checksum = (checksum ^ rows[(row_index * kCollisionGridColCount) + col_index]) * 1099511628211ULL;
+            }
+            checksum = (checksum ^ (0x100u | row_counts[row_index])) * 1099511628211ULL;
+        }
+    }
+    return checksum;
+}
+
+int
+main(int argument_count, char **arguments)
+{
+    u32 frame_count  = (argument_count > 1) ? (u32)atoi(arguments[1]) : 20000;
+    u32 worker_count = (argument_count > 2) ? (u32)atoi(arguments[2]) : 3;
+    f32 speed        = (argument_count > 3) ? (f32)atof(arguments[3]) : 0.05f;
+
+    PackFile *world_pack = collision_grid_bench_load_pack("world.pack");
+    if (!world_pack)
+    {
+        fprintf(stderr, "can not load world.pack\n");
+        return 1;
+    }
+
+    u32 template_memory_size = template_registry_memory_size(world_pack, kGameWorldTemplateEntriesMask);
+    void *template_memory    = malloc(template_memory_size);
+
+    u32 job_arena_memory_size = job_pool_arena_memory_size(worker_count, kGameWorldJobArenaSize);
+    void *job_arena_memory    = malloc(job_arena_memory_size);
+    Assert(template_memory && job_arena_memory);
+
+    JobPool job_pool;
+    job_pool_init(&job_pool, worker_count, job_arena_memory, kGameWorldJobArenaSize);
+
+    static GameWorld world;
+    game_world_init(&world, world_pack, &job_pool, template_memory, template_memory_size);
+
+    CollisionWorld *collision_world = &world.collision_world;
+
+    u32 random_state = 1;
+    static CollisionGridBenchBullets hero_bullets;
+    static CollisionGridBenchBullets enemy_bullets;
+    collision_grid_bench_bullets_init(&hero_bullets, collision_world->Groups[world.hero_bullets_collision_group].GridContext.CollisionSourceInstancesBin,
+                                      collision_world->Groups[world.hero_bullets_collision_group].GridContext.CollisionSourceRadiusBin, speed, &random_state);
+    collision_grid_bench_bullets_init(&enemy_bullets, collision_world->Groups[world.enemy_bullets_collision_group].GridContext.CollisionSourceInstancesBin,
+                                      collision_world->Groups[world.enemy_bullets_collision_group].GridContext.CollisionSourceRadiusBin, speed, &random_state);
+
+    // the same four systems the update graph registers, nothing else, so they only depend on their own blobs
+    static FrameGraph grid_graph;
+    frame_graph_init(&grid_graph, world_pack, &job_pool);
+    for (u32 group_index = 0; group_index < collision_world->GroupCount; group_index++)
+    {
+        frame_graph_add_system(&grid_graph, collision_grid_update, CollisionGridContext, &collision_world->Groups[group_index].GridContext);
+    }
+
+    u64 run_ticks[2];
+    u64 run_checksum[2];
+    u32 rebuild_count[2];
+
+    for (u32 run_index = 0; run_index < 2; run_index++)
+    {
+        collision_grid_bench_reset(collision_world);
+
+        u32 rebuild_count_begin = 0;
+        for (u32 group_index = 0; group_index < collision_world->GroupCount; group_index++)
+        {
+            rebuild_count_begin += CollisionGridChurnStaticPrt(collision_world->Groups[group_index].GridContext.Root)->FullRebuildCount;
+        }
+
+        run_ticks[run_index]    = 0;
+        run_checksum[run_index] = 0;
+
+        for (u32 frame_index = 0; frame_index < frame_count; frame_index++)
+        {
+            collision_grid_bench_bullets_move(&hero_bullets, frame_index);
+            collision_grid_bench_bullets_move(&enemy_bullets, frame_index);
+
+            u64 begin_ticks = platform_ticks();
+            if (run_index == 0)
+            {
+                for (u32 group_index = 0; group_index < collision_world->GroupCount; group_index++)
+                {
+                    collision_grid_update(&collision_world->Groups[group_index].GridContext);
+                }
+            }
+            else
+            {
+                frame_graph_run(&grid_graph);
+            }
+            run_ticks[run_index] += platform_ticks() - begin_ticks;
+
+            run_checksum[run_index] = (run_checksum[run_index] * 31) + collision_grid_bench_checksum(collision_world);
+        }
+
+        rebuild_count[run_index] = 0;
+        for (u32 group_index = 0; group_index < collision_world->GroupCount; group_index++)
+        {
+            rebuild_count[run_index] += CollisionGridChurnStaticPrt(collision_world->Groups[group_index].GridContext.Root)->FullRebuildCount;
+        }
+        rebuild_count[run_index] -= rebuild_count_begin;
+    }
+
+    f64 ticks_per_us = (f64)platform_ticks_per_second() / 1000000.0;
+
+    u16 hero_bullet_count  = *CollisionSourceInstancesSourceInstancesCountPrt(hero_bullets.SourceInstancesBin);
+    u16 enemy_bullet_count = *CollisionSourceInstancesSourceInstancesCountPrt(enemy_bullets.SourceInstancesBin);
+
+    printf("bullets %u hero, %u enemy, %u frames, %u workers\n", hero_bullet_count, enemy_bullet_count, frame_count, job_pool.WorkerCount);
+    printf("serial %.2f us per frame, frame graph %.2f us per frame, full rebuilds %u/%u\n",
+           run_ticks[0] / ticks_per_us / max(frame_count, 1), run_ticks[1] / ticks_per_us / max(frame_count, 1), rebuild_count[0], rebuild_count[1]);
+    printf("grids %s\n", (run_checksum[0] == run_checksum[1]) ? "match" : "DIFFER");
+
+    job_pool_shutdown(&job_pool);
+
+    free(job_arena_memory);
+    free(template_memory);
+    free(world_pack);
+
+    return (run_checksum[0] == run_checksum[1]) ? 0 : 1;
+}
@@ -1,3 +1,65 @@
+// Rows keep instances in index order, so updating only instances whose row span changed gives the same rows as a full rebuild.
+// A full row may have dropped instances, removing from or inserting into one falls back to a full rebuild,
+// as does a frame where more than churn_rebuild_threshold spans changed.
+//
+// Rows are split into level_count levels, level l has row_count >> l rows each 2^l base rows high, stored one level after another.
+// Instance goes to the finest level whose rows are at least half its diameter high, so it spans at most three rows of that level
+// and large enemies do not fill every base row they cover. Coarser rows hold more candidates, so instances stay as fine as that allows.
+//
+// With COLLISION_FIXED_POINT positions are quantized to Q8 once per frame here and row spans are computed in integers,
+// collision damage then tests overlap on the Q8 copies so hits do not depend on the compiler float code generation.
+
+static u32
+collision_grid_level_row_offset(u32 level)
+{
+    return (kCollisionGridRowCount * 2) - ((kCollisionGridRowCount * 2) >> level);
+}
+
+static b32
+collision_grid_row_remove(CollisionGridGridRowCount *collision_grid_row_count, CollisionGridGridRows *collision_grid_rows, u32 row_index, u8 instance_index)
+{
+    u8 row_count = collision_grid_row_count->GridRowCount[row_index];
+    if (row_count >= kCollisionGridColCount)
+    {
+        return 0;
+    }
+
+    u8 *row = &collision_grid_rows->GridRows[row_index * kCollisionGridColCount];
+
+    u8 col_index = 0;
+    while ((col_index < row_count) && (row[col_index] != instance_index))
+    {
+        col_index++;
+    }
+    Assert(col_index < row_count);
+
+    memmove(row + col_index, row + col_index + 1, row_count - col_index - 1);
+    collision_grid_row_count->GridRowCount[row_index] = row_count - 1;
+    return 1;
+}
+
+static b32
+collision_grid_row_insert(CollisionGridGridRowCount *collision_grid_row_count, CollisionGridGridRows *collision_grid_rows, u32 row_index, u8 instance_index)
+{
+    u8 row_count = collision_grid_row_count->GridRowCount[row_index];
+    if (row_count >= kCollisionGridColCount)
+    {
+        return 0;
+    }
+
+    u8 *row = &collision_grid_rows->GridRows[row_index * kCollisionGridColCount];
+
+    u8 col_index = row_count;
+    while ((col_index > 0) && (row[col_index - 1] > instance_index))
+    {
+        row[col_index] = row[col_index - 1];
+        col_index--;
+    }
+    row[col_index] = instance_index;
+    collision_grid_row_count->GridRowCount[row_index] = row_count + 1;
+    return 1;
+}
+
 static void
 collision_grid_update(CollisionGridContext *context)
 {
@@ -12,8 +74,6 @@ collision_grid_update(CollisionGridContext *context)
     collision_source_instances_count = min(collision_source_instances_count, collision_source_instances_capacity);
 
     CollisionSourceInstancesSourceInstances *collision_source_instances_sheet = CollisionSourceInstancesSourceInstancesPrt(collision_source_instances_bin);
-    u8 *collision_source_types = CollisionSourceInstancesSourceInstancesSourceTypeIndexPrt(collision_source_instances_bin, collision_source_instances_sheet);
-    v2 *collision_source_positions = (v2*)CollisionSourceInstancesSourceInstancesPositionsPrt(collision_source_instances_bin, collision_source_instances_sheet);
 
     CollisionSourceRadiusSourceTypes *collision_source_radius_sheet = CollisionSourceRadiusSourceTypesPrt(collision_source_radius_bin);
     u8 *collision_source_radius_q8 = CollisionSourceRadiusSourceTypesRadiusQ8Prt(collision_source_radius_bin, collision_source_radius_sheet);
@@ -22,59 +82,214 @@ collision_grid_update(CollisionGridContext *context)
     u8 *collision_source_radius_q = collision_source_radius_q4 ? collision_source_radius_q4 : collision_source_radius_q8;
     f32 radius_multiplier = collision_source_radius_q4 ? kQ4ToFloat : kQ8ToFloat;
 
-    CollisionGridGridRowCount *collision_grid_row_count = CollisionGridGridRowCountPrt(collision_grid);
-    CollisionGridGridRows *collision_grid_rows = CollisionGridGridRowsPrt(collision_grid);
+    u16 collision_source_types_count = *CollisionSourceRadiusSourceTypesCountPrt(collision_source_radius_bin);
+    u16 collision_source_types_capacity = *CollisionSourceRadiusSourceTypesCapacityPrt(collision_source_radius_bin);
+
+    collision_source_types_count = min(collision_source_types_count, collision_source_types_capacity);
+
+    CollisionGridGridRowCount *collision_grid_row_count = CollisionGridGridRowCountStaticPrt(collision_grid);
+    CollisionGridGridRows *collision_grid_rows = CollisionGridGridRowsStaticPrt(collision_grid);
+    f32 *collision_grid_instance_radius = CollisionGridInstanceRadiusStaticPrt(collision_grid)->InstanceRadius;
+
+    // radius is decoded once per type here, collision damage reads it per instance from the grid
+    f32 source_type_radius[256];
+    #ifdef COLLISION_FIXED_POINT
+    u16 source_type_radius_q8[256];
+    #endif
+    u8 source_type_level[256];
+
+    Assert(collision_source_instances_count <= kCollisionGridMaxInstanceCount);
+    Assert(collision_source_types_count <= ArrayCount(source_type_radius));
+
+    for (u16 source_type_index = 0; source_type_index < collision_source_types_count; source_type_index++)
+    {
+        f32 source_type_diameter = 2.0f * ((f32)collision_source_radius_q[source_type_index]) * radius_multiplier;
+        f32 level_row_height = kPlayAreaHeight / (f32)kCollisionGridRowCount;
+
+        u8 level = 0;
+        while (((level + 1) < kCollisionGridLevelCount) && (source_type_diameter > (2.0f * level_row_height)))
+        {
+            level_row_height *= 2.0f;
+            level++;
+        }
+
+        source_type_radius[source_type_index] = source_type_diameter * 0.5f;
+        #ifdef COLLISION_FIXED_POINT
+        source_type_radius_q8[source_type_index] = collision_source_radius_q4 ? (u16)(collision_source_radius_q[source_type_index] << 4) : collision_source_radius_q[source_type_index];
+        #endif
+        source_type_level[source_type_index] = level;
+    }
+
+    u16 *instance_count_prt = CollisionGridInstanceCountStaticPrt(collision_grid);
+    u8 *instance_row_begin_prt = CollisionGridInstanceRowBeginStaticPrt(collision_grid)->InstanceRowBegin;
+    u8 *instance_row_end_prt = CollisionGridInstanceRowEndStaticPrt(collision_grid)->InstanceRowEnd;
+    CollisionGridChurn *churn_prt = CollisionGridChurnStaticPrt(collision_grid);
+
+    #ifdef COLLISION_FIXED_POINT
+    u16 *instance_radius_q8_prt = CollisionGridInstanceRadiusQ8StaticPrt(collision_grid)->InstanceRadiusQ8;
+    s32 *instance_position_x_q8_prt = CollisionGridInstancePositionQ8StaticPrt(collision_grid)->X;
+    s32 *instance_position_y_q8_prt = CollisionGridInstancePositionQ8StaticPrt(collision_grid)->Y;
 
-    memset(collision_grid_row_count, 0, sizeof(CollisionGridGridRowCount));
-    memset(collision_grid_rows, 0, sizeof(CollisionGridGridRows));
+    s32 play_area_half_width_q8  = (s32)(kPlayAreaHalfWidth * kFloatToQ8);
+    s32 play_area_half_height_q8 = (s32)(kPlayAreaHalfHeight * kFloatToQ8);
+    s32 row_height_q8            = (s32)(kPlayAreaHeight * kFloatToQ8) / kCollisionGridRowCount;
+    #endif
 
-    for (u16 instance_index = 0; instance_index < collision_source_instances_count; instance_index++)
+    // instances past the current count leave the grid
+    u16 span_count = max(collision_source_instances_count, *instance_count_prt);
+
+    // row_index span [begin, end) of every instance this frame within its level, empty when the instance is not in the grid
+    u8 row_begin[kCollisionGridMaxInstanceCount];
+    u8 row_end[kCollisionGridMaxInstanceCount];
+
+    u16 changed_instance_count = 0;
+
+    for (u16 instance_index = 0; instance_index < span_count; instance_index++)
     {
-        if (collision_source_instances_enabled)
+        row_begin[instance_index] = 0;
+        row_end[instance_index]   = 0;
+
+        b32 is_enabled = instance_index < collision_source_instances_count;
+
+        if (is_enabled && collision_source_instances_enabled)
         {
             u16 instance_word_index = instance_index / 64;
             u16 instance_bit_index = instance_index - (instance_word_index * 64);
 
-            if ((collision_source_instances_enabled[instance_word_index] & (1ULL << instance_bit_index)) == 0)
+            is_enabled = (collision_source_instances_enabled[instance_word_index] & (1ULL << instance_bit_index)) != 0;
+        }
+
+        if (is_enabled)
+        {
+            v2 instance_position = *(v2*)CollisionSourceInstancesSourceInstancesPositionsAt(collision_source_instances_bin, collision_source_instances_sheet, instance_index);
+            u8 instance_type = *CollisionSourceInstancesSourceInstancesSourceTypeIndexAt(collision_source_instances_bin, collision_source_instances_sheet, instance_index);
+            f32 instance_radius = source_type_radius[instance_type];
+            u8 instance_level = source_type_level[instance_type];
+
+            collision_grid_instance_radius[instance_index] = instance_radius;
+
+            #ifdef COLLISION_FIXED_POINT
+            // far away instances are outside either way, clamping keeps the Q8 value and later squared distances in range
+            s32 instance_position_x_q8 = f32_to_q8(clamp(-32.0f, instance_position.x, 32.0f));
+            s32 instance_position_y_q8 = f32_to_q8(clamp(-32.0f, instance_position.y, 32.0f));
+            s32 instance_radius_q8     = source_type_radius_q8[instance_type];
+
+            instance_radius_q8_prt[instance_index]     = (u16)instance_radius_q8;
+            instance_position_x_q8_prt[instance_index] = instance_position_x_q8;
+            instance_position_y_q8_prt[instance_index] = instance_position_y_q8;
+
+            // rows below the play area clamp to 0 whichever way the division rounds
+            s32 top = clamp_s32(0, (instance_position_y_q8 + instance_radius_q8 + play_area_half_height_q8) / row_height_q8, kCollisionGridRowCount - 1);
+            s32 bottom = clamp_s32(0, (instance_position_y_q8 - instance_radius_q8 + play_area_half_height_q8) / row_height_q8, kCollisionGridRowCount - 1);
+
+            b32 is_outside = ((instance_position_y_q8 + instance_radius_q8) < -play_area_half_height_q8) ||
+                             ((instance_position_y_q8 - instance_radius_q8) > play_area_half_height_q8) ||
+                             ((instance_position_x_q8 + instance_radius_q8) < -play_area_half_width_q8) ||
+                             ((instance_position_x_q8 - instance_radius_q8) > play_area_half_width_q8);
+            #else
+            s32 top = clamp_s32(0, (s32)((0.5f + ((instance_position.y + instance_radius) / kPlayAreaHeight)) * kCollisionGridRowCount), kCollisionGridRowCount - 1);
+            s32 bottom = clamp_s32(0, (s32)((0.5f + ((instance_position.y - instance_radius) / kPlayAreaHeight)) * kCollisionGridRowCount), kCollisionGridRowCount - 1);
+
+            b32 is_outside = ((instance_position.y + instance_radius) < -kPlayAreaHalfHeight) ||
+                             ((instance_position.y - instance_radius) > kPlayAreaHalfHeight) ||
+                             ((instance_position.x + instance_radius) < -kPlayAreaHalfWidth) ||
+                             ((instance_position.x - instance_radius) > kPlayAreaHalfWidth);
+            #endif
+
+            if (!is_outside)
             {
-                continue;
+                u32 level_row_offset = collision_grid_level_row_offset(instance_level);
+
+                row_begin[instance_index] = (u8)(level_row_offset + (((kCollisionGridRowCount - 1) - top) >> instance_level));
+                row_end[instance_index]   = (u8)(level_row_offset + (((kCollisionGridRowCount - 1) - bottom) >> instance_level) + 1);
             }
         }
 
-        v2 instance_position = collision_source_positions[instance_index];
-        u8 instance_type = collision_source_types[instance_index];
-        u8 instance_radius_q = collision_source_radius_q[instance_type];
-        f32 instance_radius = ((f32)instance_radius_q) * radius_multiplier;
+        b32 is_changed = (row_begin[instance_index] != instance_row_begin_prt[instance_index]) ||
+                         (row_end[instance_index] != instance_row_end_prt[instance_index]);
+        changed_instance_count += is_changed;
+    }
 
-        s32 top = clamp_s32(0, (s32)((0.5f + ((instance_position.y + instance_radius) / kPlayAreaHeight)) * kCollisionGridRowCount), kCollisionGridRowCount - 1);
-        s32 bottom = clamp_s32(0, (s32)((0.5f + ((instance_position.y - instance_radius) / kPlayAreaHeight)) * kCollisionGridRowCount), kCollisionGridRowCount - 1);
+    b32 is_rebuild = changed_instance_count > kCollisionGridChurnRebuildThreshold;
+
+    for (u16 instance_index = 0; (instance_index < span_count) && !is_rebuild; instance_index++)
+    {
+        u8 prev_begin = instance_row_begin_prt[instance_index];
+        u8 prev_end   = instance_row_end_prt[instance_index];
 
-        if ((instance_position.y + instance_radius) < -kPlayAreaHalfHeight)
+        if ((row_begin[instance_index] == prev_begin) && (row_end[instance_index] == prev_end))
         {
             continue;
         }
-        if ((instance_position.y - instance_radius) > kPlayAreaHalfHeight)
+
+        for (u32 row_index = prev_begin; (row_index < prev_end) && !is_rebuild; row_index++)
         {
-            continue;
+            is_rebuild = !collision_grid_row_remove(collision_grid_row_count, collision_grid_rows, row_index, (u8)instance_index);
         }
-        if ((instance_position.x + instance_radius) < -kPlayAreaHalfWidth)
+        for (u32 row_index = row_begin[instance_index]; (row_index < row_end[instance_index]) && !is_rebuild; row_index++)
         {
-            continue;
+            is_rebuild = !collision_grid_row_insert(collision_grid_row_count, collision_grid_rows, row_index, (u8)instance_index);
         }
-        if ((instance_position.x - instance_radius) > kPlayAreaHalfWidth)
+
+        instance_row_begin_prt[instance_index] = row_begin[instance_index];
+        instance_row_end_prt[instance_index]   = row_end[instance_index];
+    }
+
+    if (is_rebuild)
+    {
+        memset(collision_grid_row_count, 0, sizeof(CollisionGridGridRowCount));
+
+        for (u16 instance_index = 0; instance_index < span_count; instance_index++)
         {
-            continue;
+            for (u32 row_index = row_begin[instance_index]; row_index < row_end[instance_index]; row_index++)
+            {
+                u8 row_instance_index = collision_grid_row_count->GridRowCount[row_index];
+                if (row_instance_index < kCollisionGridColCount)
+                {
+                    collision_grid_row_count->GridRowCount[row_index]++;
+                    collision_grid_rows->GridRows[(row_index * kCollisionGridColCount) + row_instance_index] = (u8)instance_index;
+                }
+            }
+
+            instance_row_begin_prt[instance_index] = row_begin[instance_index];
+            instance_row_end_prt[instance_index]   = row_end[instance_index];
         }
 
-        for (s32 y = top; y >= bottom; y--)
+        churn_prt->FullRebuildCount++;
+    }
+    else
+    {
+        churn_prt->IncrementalUpdateCount++;
+    }
+
+    churn_prt->ChangedInstanceCount  = changed_instance_count;
+    churn_prt->ChangedInstanceTotal += changed_instance_count;
+    *instance_count_prt = collision_source_instances_count;
+
+    #ifndef NDEBUG
+    {
+        CollisionGridGridRowCount rebuild_row_count = { 0 };
+        CollisionGridGridRows rebuild_rows;
+
+        for (u16 instance_index = 0; instance_index < span_count; instance_index++)
         {
-            s32 row_index = (kCollisionGridRowCount - 1) - y;
-            u8 row_instance_index = collision_grid_row_count->GridRowCount[row_index];
-            if (row_instance_index < kCollisionGridColCount)
+            for (u32 row_index = row_begin[instance_index]; row_index < row_end[instance_index]; row_index++)
             {
-                collision_grid_row_count->GridRowCount[row_index]++;
-                collision_grid_rows->GridRows[(row_index * kCollisionGridColCount) + row_instance_index] = (u8)instance_index;
+                u8 row_instance_index = rebuild_row_count.GridRowCount[row_index];
+                if (row_instance_index < kCollisionGridColCount)
+                {
+                    rebuild_row_count.GridRowCount[row_index]++;
+                    rebuild_rows.GridRows[(row_index * kCollisionGridColCount) + row_instance_index] = (u8)instance_index;
+                }
             }
         }
+
+        for (u32 row_index = 0; row_index < collision_grid_level_row_offset(kCollisionGridLevelCount); row_index++)
+        {
+            u8 row_count = collision_grid_row_count->GridRowCount[row_index];
+            Assert(row_count == rebuild_row_count.GridRowCount[row_index]);
+            Assert(memcmp(&collision_grid_rows->GridRows[row_index * kCollisionGridColCount], &rebuild_rows.GridRows[row_index * kCollisionGridColCount], row_count) == 0);
+        }
     }
-}
\ No newline at end of file
+    #endif
+}
@@ -0,0 +1,176 @@
+// Collision groups and the interactions between them.
+// A group is one collision source (instances, radius, damage), its grid is built once per frame whatever number of interactions use it.
+// An interaction is a cell of the group x group matrix with its own collision_damage instance,
+// so every pair keeps its own accumulated damage and damage event log, logs of all interactions page out of one damage_event_pool.
+// The whole matrix is one partitioned system: a partition walks its rows once and tests every interaction on each row,
+// hits of every interaction come out in the same order as a walk over that interaction alone.
+
+#ifndef __cplusplus
+typedef struct CollisionWorld            CollisionWorld;
+typedef struct CollisionWorldGroup       CollisionWorldGroup;
+typedef struct CollisionWorldInteraction CollisionWorldInteraction;
+#endif
+
+#define kCollisionWorldMaxGroupCount       8
+#define kCollisionWorldMaxInteractionCount 16
+
+struct CollisionWorldGroup
+{
+    CollisionGridContext GridContext;
+    CollisionSourceDamage *SourceDamageBin;
+};
+
+struct CollisionWorldInteraction
+{
+    u32 AGroupIndex;
+    u32 BGroupIndex;
+    CollisionDamageContext DamageContext;
+};
+
+struct CollisionWorld
+{
+    LevelUpdate *LevelUpdateBin;
+    DamageEventPool *DamageEventPoolBin;
+
+    u32 GroupCount;
+    CollisionWorldGroup Groups[kCollisionWorldMaxGroupCount];
+
+    u32 InteractionCount;
+    CollisionWorldInteraction Interactions[kCollisionWorldMaxInteractionCount];
+};
+
+static void
+collision_world_init(CollisionWorld *world, LevelUpdate *level_update_bin, DamageEventPool *damage_event_pool_bin)
+{
+    memset(world, 0, sizeof(CollisionWorld));
+    world->LevelUpdateBin     = level_update_bin;
+    world->DamageEventPoolBin = damage_event_pool_bin;
+}
+
+static u32
+collision_world_add_group(CollisionWorld *world, CollisionGrid *grid, CollisionSourceInstances *source_instances_bin, CollisionSourceRadius *source_radius_bin, CollisionSourceDamage *source_damage_bin)
+{
+    Assert(world->GroupCount < kCollisionWorldMaxGroupCount);
+
+    u32 group_index = world->GroupCount++;
+
+    CollisionWorldGroup *group = &world->Groups[group_index];
+    group->GridContext.Root                        = grid;
+    group->GridContext.CollisionSourceInstancesBin = source_instances_bin;
+    group->GridContext.CollisionSourceRadiusBin    = source_radius_bin;
+    group->SourceDamageBin                         = source_damage_bin;
+
+    return group_index;
+}
+
+// damage applied to a group instances is read through CollisionDamageACollisionInstancesDamageMapPrt, to b group instances through the B map
+static u32
+collision_world_add_interaction(CollisionWorld *world, u32 a_group_index, u32 b_group_index, CollisionDamage *collision_damage)
+{
+    Assert(world->InteractionCount < kCollisionWorldMaxInteractionCount);
+    Assert((a_group_index < world->GroupCount) && (b_group_index < world->GroupCount));
+
+    CollisionWorldGroup *a_group = &world->Groups[a_group_index];
+    CollisionWorldGroup *b_group = &world->Groups[b_group_index];
+
+    u32 interaction_index = world->InteractionCount++;
+
+    CollisionWorldInteraction *interaction = &world->Interactions[interaction_index];
+    interaction->AGroupIndex = a_group_index;
+    interaction->BGroupIndex = b_group_index;
+
+    CollisionDamageContext *context = &interaction->DamageContext;
+    context->Root                         = collision_damage;
+    context->ACollisionGridBin            = a_group->GridContext.Root;
+    context->ACollisionSourceInstancesBin = a_group->GridContext.CollisionSourceInstancesBin;
+    context->ACollisionSourceDamageBin    = a_group->SourceDamageBin;
+    context->BCollisionGridBin            = b_group->GridContext.Root;
+    context->BCollisionSourceInstancesBin = b_group->GridContext.CollisionSourceInstancesBin;
+    context->BCollisionSourceDamageBin    = b_group->SourceDamageBin;
+    context->LevelUpdateBin               = world->LevelUpdateBin;
+    context->DamageEventPoolBin           = world->DamageEventPoolBin;
+
+    return interaction_index;
+}
+
+static void
+collision_world_begin(CollisionWorld *world)
+{
+    for (u32 interaction_index = 0; interaction_index < world->InteractionCount; interaction_index++)
+    {
+        collision_damage_begin(&world->Interactions[interaction_index].DamageContext);
+    }
+}
+
+// Every level of a is paired with every level of b, a partition owns finer rows that start in its base row range,
+// so dedup does not depend on partitioning.
+static void
+collision_world_partition(CollisionWorld *world, u32 partition_index)
+{
+    u32 level_state_state = *LevelUpdateStatePrt(world->LevelUpdateBin);
+
+    for (u32 interaction_index = 0; interaction_index < world->InteractionCount; interaction_index++)
+    {
+        CollisionDamage *collision_damage_bin = world->Interactions[interaction_index].DamageContext.Root;
+        CollisionDamagePartitionHitCountStaticPrt(collision_damage_bin)->PartitionHitCount[partition_index] = 0;
+    }
+
+    if (level_state_state & kLevelUpdateStateReset)
+    {
+        return;
+    }
+
+    for (u32 a_level = 0; a_level < kCollisionGridLevelCount; a_level++)
+    {
+        for (u32 b_level = 0; b_level < kCollisionGridLevelCount; b_level++)
+        {
+            u32 fine_row_begin;
+            u32 fine_row_end;
+            collision_damage_partition_rows(partition_index, min(a_level, b_level), &fine_row_begin, &fine_row_end);
+
+            for (u32 fine_row_index = fine_row_begin; fine_row_index < fine_row_end; fine_row_index++)
+            {
+                for (u32 interaction_index = 0; interaction_index < world->InteractionCount; interaction_index++)
+                {
+                    collision_damage_row(&world->Interactions[interaction_index].DamageContext, partition_index, a_level, b_level, fine_row_index);
+                }
+            }
+        }
+    }
+}
+
+static void
+collision_world_merge(CollisionWorld *world)
+{
+    for (u32 interaction_index = 0; interaction_index < world->InteractionCount; interaction_index++)
+    {
+        collision_damage_merge(&world->Interactions[interaction_index].DamageContext);
+    }
+}
+
+// One grid system per group, then the matrix as a single partitioned system reading and writing the union of its interaction contexts.
+static void
+collision_world_add_systems(CollisionWorld *world, FrameGraph *graph)
+{
+    for (u32 group_index = 0; group_index < world->GroupCount; group_index++)
+    {
+        frame_graph_add_system(graph, collision_grid_update, CollisionGridContext, &world->Groups[group_index].GridContext);
+    }
+
+    void *system_reads[kCollisionWorldMaxInteractionCount * kCollisionDamageContextReadCount];
+    void *system_writes[kCollisionWorldMaxInteractionCount * kCollisionDamageContextWriteCount];
+    u32 system_read_count  = 0;
+    u32 system_write_count = 0;
+
+    for (u32 interaction_index = 0; interaction_index < world->InteractionCount; interaction_index++)
+    {
+        CollisionDamageContext *context = &world->Interactions[interaction_index].DamageContext;
+        system_read_count  += CollisionDamageContextReads(context, system_reads + system_read_count);
+        system_write_count += CollisionDamageContextWrites(context, system_writes + system_write_count);
+    }
+
+    frame_graph_add(graph, "collision_world_begin", (FrameGraphSystem *)collision_world_begin, world,
+                    system_reads, system_read_count, system_writes, system_write_count);
+    frame_graph_partition_last(graph, (FrameGraphPartitionSystem *)collision_world_partition, kCollisionDamagePartitionCount,
+                               (FrameGraphSystem *)collision_world_merge);
+}
@@ -0,0 +1,438 @@
+// CPU back-end for frame_data: draws the object pass of EndFrameDirectX11 into the same two targets, so frames can be looked at
+// and compared where there is no GPU. Every object is the circle quad of the main pipeline at the render target size,
+// material color goes to the diffuse target and color * intensity to the light target.
+// Both targets blend SRC_ALPHA / INV_SRC_ALPHA, blend_state leaves IndependentBlendEnable off so target 1 blends like target 0.
+// The render target is cut into tiles, objects are binned to the tiles they touch in stream order and tiles are shaded in parallel,
+// every pixel still sees its objects in draw order so the image does not depend on worker count.
+// Coverage is evaluated four pixels at a time with SSE2, other targets run the same math per pixel.
+//
+// Diffuse is blended in float and stored as R8G8B8A8 once per frame, where circles overlap it can be one unorm step off the GPU,
+// which rounds after every blend.
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CPU_RENDER_SSE2 1
+#endif
+
+#ifndef __cplusplus
+typedef struct CpuRender CpuRender;
+#endif
+
+#define kCpuRenderTileWidth      64
+#define kCpuRenderTileHeight     32
+#define kCpuRenderTilePixelCount (kCpuRenderTileWidth * kCpuRenderTileHeight)
+#define kCpuRenderMaxCascades    10
+#define kCpuRenderMaxWidth       8192
+// diffuse rgba and light rgba planes of one tile
+#define kCpuRenderPlaneCount     8
+#define kCpuRenderJobArenaSize   (kCpuRenderPlaneCount * kCpuRenderTilePixelCount * sizeof(f32) + 1024)
+// circle edge of the main pixel shader, sd_circle(uv, 0.99)
+#define kCpuRenderCircleRadius   0.99f
+
+#define kCpuRenderTargetDiffuse 0
+#define kCpuRenderTargetLight   1
+
+struct CpuRender
+{
+    JobPool *Pool;
+    m4x4 Projection;
+
+    f32 MaterialColor[kMaterialsMaxMaterials][3];
+    f32 MaterialLight[kMaterialsMaxMaterials][3];
+
+    u32 MaxPixelCount;
+    u32 MaxTileCount;
+
+    // render target of the last frame
+    s32 Width;
+    s32 Height;
+    u32 TileColumnCount;
+    u32 TileRowCount;
+
+    // R8G8B8A8_UNORM like game_diffuse_color, R32G32B32A32_FLOAT like game_light_color, rows top down
+    u8 *Diffuse;
+    f32 *Light;
+
+    u16 *TileObjectCounts;
+    u16 *TileObjects;
+
+    // objects of the last frame in pixels of the render target
+    u32 ObjectCount;
+    f32 CenterX[kFrameDataMaxObjectDataCapacity];
+    f32 CenterY[kFrameDataMaxObjectDataCapacity];
+    f32 InvRadiusX[kFrameDataMaxObjectDataCapacity];
+    f32 InvRadiusY[kFrameDataMaxObjectDataCapacity];
+    f32 PixelRadius[kFrameDataMaxObjectDataCapacity];
+    s32 Bounds[kFrameDataMaxObjectDataCapacity][4];
+    u8 MaterialIndex[kFrameDataMaxObjectDataCapacity];
+};
+
+// render target size EndFrameDirectX11 derives from the game viewport with render_linear 0.5,
+// rounded up to a multiple of the cascade error rate
+static void
+cpu_render_size(f32 viewport_width, f32 viewport_height, s32 *render_width, s32 *render_height)
+{
+    u8 radiance_cascades = (u8)ceilf(log_base(4.0f, v2_length(V2(viewport_width, viewport_height))));
+    radiance_cascades    = min(radiance_cascades, kCpuRenderMaxCascades);
+
+    f32 error_rate = powf((f32)(radiance_cascades - 1), 2.0f);
+    *render_width  = (s32)(ceilf(viewport_width / error_rate) * error_rate);
+    *render_height = (s32)(ceilf(viewport_height / error_rate) * error_rate);
+}
+
+static u32
+cpu_render_tile_count(s32 render_width, s32 render_height)
+{
+    u32 tile_column_count = (render_width + kCpuRenderTileWidth - 1) / kCpuRenderTileWidth;
+    u32 tile_row_count    = (render_height + kCpuRenderTileHeight - 1) / kCpuRenderTileHeight;
+    return tile_column_count * tile_row_count;
+}
+
+// memory for viewports up to max_viewport_width x max_viewport_height
+static u32
+cpu_render_memory_size(f32 max_viewport_width, f32 max_viewport_height)
+{
+    s32 render_width;
+    s32 render_height;
+    cpu_render_size(max_viewport_width, max_viewport_height, &render_width, &render_height);
+
+    u32 pixel_count = render_width * render_height;
+    u32 tile_count  = cpu_render_tile_count(render_width, render_height);
+
+    u32 size = 0;
+    size += pixel_count * 4 * sizeof(f32);
+    size += pixel_count * 4 * sizeof(u8);
+    size += tile_count * sizeof(u16);
+    size += tile_count * kFrameDataMaxObjectDataCapacity * sizeof(u16);
+    return size;
+}
+
+// pool arenas need kCpuRenderJobArenaSize bytes
+static void
+cpu_render_init(CpuRender *render, JobPool *pool, Materials *materials_bin, m4x4 projection,
+                f32 max_viewport_width, f32 max_viewport_height, void *memory)
+{
+    memset(render, 0, offsetof(CpuRender, CenterX));
+
+    render->Pool       = pool;
+    render->Projection = projection;
+
+    MaterialsMaterials *materials_sheet = MaterialsMaterialsPrt(materials_bin);
+    u32 materials_capacity              = min(*MaterialsMaterialsCapacityPrt(materials_bin), kMaterialsMaxMaterials);
+    for (u32 material_index = 0; material_index < materials_capacity; material_index++)
+    {
+        MaterialsMaterialsMaterial *material = MaterialsMaterialsMaterialAt(materials_bin, materials_sheet, material_index);
+
+        render->MaterialColor[material_index][0] = material->ColorRed;
+        render->MaterialColor[material_index][1] = material->ColorGreen;
+        render->MaterialColor[material_index][2] = material->ColorBlue;
+
+        render->MaterialLight[material_index][0] = material->ColorRed * material->Intensity;
+        render->MaterialLight[material_index][1] = material->ColorGreen * material->Intensity;
+        render->MaterialLight[material_index][2] = material->ColorBlue * material->Intensity;
+    }
+
+    s32 render_width;
+    s32 render_height;
+    cpu_render_size(max_viewport_width, max_viewport_height, &render_width, &render_height);
+
+    render->MaxPixelCount = render_width * render_height;
+    render->MaxTileCount  = cpu_render_tile_count(render_width, render_height);
+
+    u8 *memory_at = (u8 *)memory;
+    render->Light            = (f32 *)memory_at;  memory_at += render->MaxPixelCount * 4 * sizeof(f32);
+    render->Diffuse          = memory_at;         memory_at += render->MaxPixelCount * 4 * sizeof(u8);
+    render->TileObjectCounts = (u16 *)memory_at;  memory_at += render->MaxTileCount * sizeof(u16);
+    render->TileObjects      = (u16 *)memory_at;
+}
+
+// blends one object into the rows and columns of the tile it covers, planes hold the tile as diffuse rgba then light rgba
+static void
+cpu_render_tile_object(CpuRender *render, u32 object_index, s32 tile_x, s32 tile_y, s32 tile_width, s32 tile_height, f32 *planes)
+{
+    s32 *bounds = render->Bounds[object_index];
+
+    s32 span_begin = max(bounds[0] - tile_x, 0);
+    s32 span_end   = min(bounds[2] - tile_x, tile_width);
+    s32 row_begin  = max(bounds[1] - tile_y, 0);
+    s32 row_end    = min(bounds[3] - tile_y, tile_height);
+
+    f32 center_x     = render->CenterX[object_index] - (f32)tile_x;
+    f32 center_y     = render->CenterY[object_index] - (f32)tile_y;
+    f32 inv_radius_x = render->InvRadiusX[object_index];
+    f32 inv_radius_y = render->InvRadiusY[object_index];
+    f32 pixel_radius = render->PixelRadius[object_index];
+
+    f32 *color = render->MaterialColor[render->MaterialIndex[object_index]];
+    f32 *light = render->MaterialLight[render->MaterialIndex[object_index]];
+
+    f32 *plane[kCpuRenderPlaneCount];
+    for (u32 plane_index = 0; plane_index < kCpuRenderPlaneCount; plane_index++)
+    {
+        plane[plane_index] = planes + (plane_index * kCpuRenderTilePixelCount);
+    }
+
+    f32 source[kCpuRenderPlaneCount] = { color[0], color[1], color[2], 1.0f, light[0], light[1], light[2], 1.0f };
+
+    for (s32 row = row_begin; row < row_end; row++)
+    {
+        f32 uv_y    = (((f32)row + 0.5f) - center_y) * inv_radius_y;
+        f32 uv_y_sq = uv_y * uv_y;
+        u32 row_at  = row * kCpuRenderTileWidth;
+
+        #ifdef CPU_RENDER_SSE2
+        // spans start on a 4 pixel boundary of the tile row, lanes outside [span_begin, span_end) get zero alpha and keep the target
+        __m128 lane_center   = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        __m128i lane_index   = _mm_setr_epi32(0, 1, 2, 3);
+        __m128i lane_begin   = _mm_set1_epi32(span_begin);
+        __m128i lane_end     = _mm_set1_epi32(span_end);
+        __m128 zero          = _mm_setzero_ps();
+        __m128 one           = _mm_set1_ps(1.0f);
+        __m128 half          = _mm_set1_ps(0.5f);
+        __m128 circle_radius = _mm_set1_ps(kCpuRenderCircleRadius);
+        __m128 center_x4     = _mm_set1_ps(center_x);
+        __m128 inv_radius_x4 = _mm_set1_ps(inv_radius_x);
+        __m128 pixel_radius4 = _mm_set1_ps(pixel_radius);
+        __m128 uv_y_sq4      = _mm_set1_ps(uv_y_sq);
+
+        for (s32 column = span_begin & ~3; column < span_end; column += 4)
+        {
+            __m128 uv_x   = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(_mm_set1_ps((f32)column), lane_center), center_x4), inv_radius_x4);
+            __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(uv_x, uv_x), uv_y_sq4));
+            __m128 alpha  = _mm_sub_ps(half, _mm_mul_ps(_mm_sub_ps(length, circle_radius), pixel_radius4));
+            alpha         = _mm_min_ps(_mm_max_ps(alpha, zero), one);
+
+            __m128i lane   = _mm_add_epi32(_mm_set1_epi32(column), lane_index);
+            __m128i inside = _mm_andnot_si128(_mm_cmplt_epi32(lane, lane_begin), _mm_cmplt_epi32(lane, lane_end));
+            alpha          = _mm_and_ps(alpha, _mm_castsi128_ps(inside));
+
+            __m128 inv_alpha = _mm_sub_ps(one, alpha);
+            for (u32 plane_index = 0; plane_index < kCpuRenderPlaneCount; plane_index++)
+            {
+                f32 *target   = plane[plane_index] + row_at + column;
+                __m128 result = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(source[plane_index]), alpha), _mm_mul_ps(_mm_loadu_ps(target), inv_alpha));
+                _mm_storeu_ps(target, result);
+            }
+        }
+        #else
+        for (s32 column = span_begin; column < span_end; column++)
+        {
+            f32 uv_x   = (((f32)column + 0.5f) - center_x) * inv_radius_x;
+            f32 length = sqrtf((uv_x * uv_x) + uv_y_sq);
+            f32 alpha  = clamp(0.0f, 0.5f - ((length - kCpuRenderCircleRadius) * pixel_radius), 1.0f);
+
+            f32 inv_alpha = 1.0f - alpha;
+            for (u32 plane_index = 0; plane_index < kCpuRenderPlaneCount; plane_index++)
+            {
+                f32 *target = plane[plane_index] + row_at + column;
+                *target     = (source[plane_index] * alpha) + (*target * inv_alpha);
+            }
+        }
+        #endif
+    }
+}
+
+// copies the tile planes into the interleaved targets
+static void
+cpu_render_tile_store(CpuRender *render, s32 tile_x, s32 tile_y, s32 tile_width, s32 tile_height, f32 *planes)
+{
+    for (s32 row = 0; row < tile_height; row++)
+    {
+        u32 pixel_at = ((tile_y + row) * render->Width) + tile_x;
+        u8 *diffuse  = render->Diffuse + (pixel_at * 4);
+        f32 *light   = render->Light + (pixel_at * 4);
+
+        f32 *source[kCpuRenderPlaneCount];
+        for (u32 plane_index = 0; plane_index < kCpuRenderPlaneCount; plane_index++)
+        {
+            source[plane_index] = planes + (plane_index * kCpuRenderTilePixelCount) + (row * kCpuRenderTileWidth);
+        }
+
+        s32 column = 0;
+
+        #ifdef CPU_RENDER_SSE2
+        __m128 unorm_scale = _mm_set1_ps(255.0f);
+        __m128 zero        = _mm_setzero_ps();
+        __m128 one         = _mm_set1_ps(1.0f);
+        for (; (column + 4) <= tile_width; column += 4)
+        {
+            __m128 diffuse_r = _mm_loadu_ps(source[0] + column);
+            __m128 diffuse_g = _mm_loadu_ps(source[1] + column);
+            __m128 diffuse_b = _mm_loadu_ps(source[2] + column);
+            __m128 diffuse_a = _mm_loadu_ps(source[3] + column);
+            _MM_TRANSPOSE4_PS(diffuse_r, diffuse_g, diffuse_b, diffuse_a);
+
+            __m128i pixel0 = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(diffuse_r, zero), one), unorm_scale));
+            __m128i pixel1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(diffuse_g, zero), one), unorm_scale));
+            __m128i pixel2 = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(diffuse_b, zero), one), unorm_scale));
+            __m128i pixel3 = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(diffuse_a, zero), one), unorm_scale));
+            __m128i pixels = _mm_packus_epi16(_mm_packs_epi32(pixel0, pixel1), _mm_packs_epi32(pixel2, pixel3));
+            _mm_storeu_si128((__m128i *)(diffuse + (column * 4)), pixels);
+
+            __m128 light_r = _mm_loadu_ps(source[4] + column);
+            __m128 light_g = _mm_loadu_ps(source[5] + column);
+            __m128 light_b = _mm_loadu_ps(source[6] + column);
+            __m128 light_a = _mm_loadu_ps(source[7] + column);
+            _MM_TRANSPOSE4_PS(light_r, light_g, light_b, light_a);
+
+            _mm_storeu_ps(light + (column * 4) + 0, light_r);
+            _mm_storeu_ps(light + (column * 4) + 4, light_g);
+            _mm_storeu_ps(light + (column * 4) + 8, light_b);
+            _mm_storeu_ps(light + (column * 4) + 12, light_a);
+        }
+        #endif
+
+        for (; column < tile_width; column++)
+        {
+            for (u32 channel = 0; channel < 4; channel++)
+            {
+                diffuse[(column * 4) + channel] = (u8)((clamp(0.0f, source[channel][column], 1.0f) * 255.0f) + 0.5f);
+                light[(column * 4) + channel]   = source[4 + channel][column];
+            }
+        }
+    }
+}
+
+static void
+cpu_render_tiles(void *data, u32 tile_begin, u32 tile_end)
+{
+    CpuRender *render = (CpuRender *)data;
+
+    f32 *planes = (f32 *)job_pool_scratch_push(render->Pool, kCpuRenderPlaneCount * kCpuRenderTilePixelCount * sizeof(f32));
+
+    for (u32 tile_index = tile_begin; tile_index < tile_end; tile_index++)
+    {
+        s32 tile_x      = (tile_index % render->TileColumnCount) * kCpuRenderTileWidth;
+        s32 tile_y      = (tile_index / render->TileColumnCount) * kCpuRenderTileHeight;
+        s32 tile_width  = min(kCpuRenderTileWidth, render->Width - tile_x);
+        s32 tile_height = min(kCpuRenderTileHeight, render->Height - tile_y);
+
+        u32 tile_object_count = render->TileObjectCounts[tile_index];
+        u16 *tile_objects     = render->TileObjects + (tile_index * kFrameDataMaxObjectDataCapacity);
+
+        // cleared to black_color like the game targets
+        memset(planes, 0, kCpuRenderPlaneCount * kCpuRenderTilePixelCount * sizeof(f32));
+
+        for (u32 tile_object_index = 0; tile_object_index < tile_object_count; tile_object_index++)
+        {
+            cpu_render_tile_object(render, tile_objects[tile_object_index], tile_x, tile_y, tile_width, tile_height, planes);
+        }
+
+        cpu_render_tile_store(render, tile_x, tile_y, tile_width, tile_height, planes);
+    }
+}
+
+// draws objects the way the main pipeline instances them into a viewport_width x viewport_height game viewport
+static void
+cpu_render_objects(CpuRender *render, f32 viewport_width, f32 viewport_height, FrameDataObject *objects, u32 object_count)
+{
+    cpu_render_size(viewport_width, viewport_height, &render->Width, &render->Height);
+    Assert((u32)(render->Width * render->Height) <= render->MaxPixelCount);
+
+    render->TileColumnCount = (render->Width + kCpuRenderTileWidth - 1) / kCpuRenderTileWidth;
+    render->TileRowCount    = (render->Height + kCpuRenderTileHeight - 1) / kCpuRenderTileHeight;
+    render->ObjectCount     = min(object_count, kFrameDataMaxObjectDataCapacity);
+
+    u32 tile_count = render->TileColumnCount * render->TileRowCount;
+    memset(render->TileObjectCounts, 0, tile_count * sizeof(u16));
+
+    // clip space to render viewport pixels, y down
+    m4x4 *projection = &render->Projection;
+    f32 half_width   = (f32)render->Width * 0.5f;
+    f32 half_height  = (f32)render->Height * 0.5f;
+
+    for (u32 object_index = 0; object_index < render->ObjectCount; object_index++)
+    {
+        f32 x;
+        f32 y;
+        f32 radius;
+        u32 material_index;
+        frame_data_object_decode(objects + object_index, &x, &y, &radius, &material_index);
+        Assert(material_index < kMaterialsMaxMaterials);
+
+        v2 clip         = transform(*projection, V2(x, y));
+        f32 center_x    = (clip.x + 1.0f) * half_width;
+        f32 center_y    = (1.0f - clip.y) * half_height;
+        f32 radius_x    = fabsf(radius * projection->E[0][0]) * half_width;
+        f32 radius_y    = fabsf(radius * projection->E[1][1]) * half_height;
+
+        render->CenterX[object_index]       = center_x;
+        render->CenterY[object_index]       = center_y;
+        render->InvRadiusX[object_index]    = (radius_x > 0.0f) ? (1.0f / radius_x) : 0.0f;
+        render->InvRadiusY[object_index]    = (radius_y > 0.0f) ? (1.0f / radius_y) : 0.0f;
+        // ddx / ddy of the circle distance in the pixel shader, taken as isotropic, render and game aspect differ by the rounding only
+        render->PixelRadius[object_index]   = (radius_x + radius_y) * 0.5f;
+        render->MaterialIndex[object_index] = (u8)material_index;
+
+        // pixels whose center is inside the quad, left and top edges inclusive
+        s32 *bounds = render->Bounds[object_index];
+        bounds[0]   = clamp_s32(0, (s32)ceilf(center_x - radius_x - 0.5f), render->Width);
+        bounds[1]   = clamp_s32(0, (s32)ceilf(center_y - radius_y - 0.5f), render->Height);
+        bounds[2]   = clamp_s32(0, (s32)ceilf(center_x + radius_x - 0.5f), render->Width);
+        bounds[3]   = clamp_s32(0, (s32)ceilf(center_y + radius_y - 0.5f), render->Height);
+
+        if ((bounds[0] >= bounds[2]) || (bounds[1] >= bounds[3]))
+        {
+            continue;
+        }
+
+        u32 tile_column_begin = bounds[0] / kCpuRenderTileWidth;
+        u32 tile_column_end   = (bounds[2] - 1) / kCpuRenderTileWidth;
+        u32 tile_row_begin    = bounds[1] / kCpuRenderTileHeight;
+        u32 tile_row_end      = (bounds[3] - 1) / kCpuRenderTileHeight;
+
+        for (u32 tile_row = tile_row_begin; tile_row <= tile_row_end; tile_row++)
+        {
+            for (u32 tile_column = tile_column_begin; tile_column <= tile_column_end; tile_column++)
+            {
+                u32 tile_index = (tile_row * render->TileColumnCount) + tile_column;
+                render->TileObjects[(tile_index * kFrameDataMaxObjectDataCapacity) + render->TileObjectCounts[tile_index]++] = (u16)object_index;
+            }
+        }
+    }
+
+    job_pool_parallel_for(render->Pool, tile_count, 1, cpu_render_tiles, render);
+}
+
+// viewport of the frame times scale, so a frame simulated for one screen can be drawn at the render size of another
+static void
+cpu_render_frame(CpuRender *render, FrameData *frame_data, f32 scale)
+{
+    FrameDataViewport *viewport         = FrameDataViewportPrt(frame_data);
+    FrameDataObjectStream object_stream = frame_data_object_stream(frame_data);
+
+    cpu_render_objects(render, viewport->Width * scale, viewport->Height * scale, object_stream.Objects, object_stream.ObjectCount);
+}
+
+// binary PPM of a target's rgb, light is clamped to [0, 1]
+static b32
+cpu_render_write_ppm(CpuRender *render, u32 target, const char *file_name)
+{
+    u8 row[3 * kCpuRenderMaxWidth];
+    Assert(render->Width <= kCpuRenderMaxWidth);
+
+    FILE *file = fopen(file_name, "wb");
+    if (!file)
+    {
+        return 0;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", render->Width, render->Height);
+
+    for (s32 y = 0; y < render->Height; y++)
+    {
+        for (s32 x = 0; x < render->Width; x++)
+        {
+            u32 pixel_at = ((y * render->Width) + x) * 4;
+            for (u32 channel = 0; channel < 3; channel++)
+            {
+                row[(x * 3) + channel] = (target == kCpuRenderTargetDiffuse) ? render->Diffuse[pixel_at + channel]
+                                                                             : (u8)((clamp(0.0f, render->Light[pixel_at + channel], 1.0f) * 255.0f) + 0.5f);
+            }
+        }
+        fwrite(row, 3, render->Width, file);
+    }
+
+    fclose(file);
+    return 1;
+}
@@ -0,0 +1,427 @@
+// CPU version of the distance field EndFrameDirectX11 builds for the radiance pass: seed_jump_flood_pipeline,
+// jump_flood_passes of jump_flood_pipeline and sdf_pipeline, on R8G8B8A8 textures laid out like the GPU ones,
+// so the result can be diffed byte for byte against a captured sdf texture.
+// Positions and distances are F16V2 encoded over two unorm bytes, every stage decodes and encodes them like the shaders do,
+// the sdf stage reads the jf texture like sdf_pipeline does (with an odd pass count that holds the second to last pass).
+// A stage is one parallel for over the tiles of the render target, flood passes run four pixels of a row at a time with SSE2.
+// Every texel carries its decoded seed position in two float planes, a flood pass copies the three together and never decodes.
+// Shaders and C do the same float operations in the same order, GPU sqrt and division may still round an ulp apart on near ties.
+// Offline and debug only: a 1080p flood costs 150-225 ms on one core, headless builds it once after the last frame.
+
+#ifndef __cplusplus
+typedef struct CpuSdf CpuSdf;
+#endif
+
+#define kCpuSdfMaxHeight    8192
+// 1 / 255 as the shaders spell it
+#define kCpuSdfUnormStep    0.0039215689f
+#define kCpuSdfFarDistance  1e10f
+
+#define kCpuSdfTextureJumpFlood 0
+#define kCpuSdfTextureSdf       1
+
+// neighborhood of jump_flood_pipeline, in its order, later samples win ties
+static const s32 kCpuSdfOffsets[9][2] =
+{
+    { -1, -1 }, { -1, 0 }, { -1, 1 },
+    {  0, -1 }, {  0, 0 }, {  0, 1 },
+    {  1, -1 }, {  1, 0 }, {  1, 1 },
+};
+
+struct CpuSdf
+{
+    JobPool *Pool;
+    u32 MaxPixelCount;
+
+    // size of the last build, that is the render target size
+    s32 Width;
+    s32 Height;
+    u32 TileColumnCount;
+    u32 TileRowCount;
+    u32 PassCount;
+
+    // jf and sdf textures of the GPU with the decoded seed of every texel, Texels[kCpuSdfTextureSdf] holds the distance after a build
+    u32 *Texels[2];
+    f32 *SeedX[2];
+    f32 *SeedY[2];
+
+    // uv * size of every pixel center, as the shaders compute it
+    f32 PixelU[kCpuRenderMaxWidth];
+    f32 PixelV[kCpuSdfMaxHeight];
+
+    // stage being run by the tile jobs
+    u8 *Diffuse;
+    u32 SourceIndex;
+    u32 TargetIndex;
+    s32 JumpDistance;
+
+    u64 SeedTicks;
+    u64 FloodTicks;
+    u64 DistanceTicks;
+};
+
+static u32
+cpu_sdf_memory_size(f32 max_viewport_width, f32 max_viewport_height)
+{
+    s32 render_width;
+    s32 render_height;
+    cpu_render_size(max_viewport_width, max_viewport_height, &render_width, &render_height);
+
+    return render_width * render_height * 2 * (sizeof(u32) + (2 * sizeof(f32)));
+}
+
+static void
+cpu_sdf_init(CpuSdf *sdf, JobPool *pool, f32 max_viewport_width, f32 max_viewport_height, void *memory)
+{
+    memset(sdf, 0, sizeof(CpuSdf));
+
+    s32 render_width;
+    s32 render_height;
+    cpu_render_size(max_viewport_width, max_viewport_height, &render_width, &render_height);
+
+    sdf->Pool          = pool;
+    sdf->MaxPixelCount = render_width * render_height;
+
+    u8 *memory_at = (u8 *)memory;
+    for (u32 texture_index = 0; texture_index < 2; texture_index++)
+    {
+        sdf->Texels[texture_index] = (u32 *)memory_at;  memory_at += sdf->MaxPixelCount * sizeof(u32);
+        sdf->SeedX[texture_index]  = (f32 *)memory_at;  memory_at += sdf->MaxPixelCount * sizeof(f32);
+        sdf->SeedY[texture_index]  = (f32 *)memory_at;  memory_at += sdf->MaxPixelCount * sizeof(f32);
+    }
+}
+
+// float to unorm byte, round to nearest even like the output merger
+static u32
+cpu_sdf_unorm(f32 value)
+{
+    return (u32)lrintf(clamp(0.0f, value, 1.0f) * 255.0f);
+}
+
+// F16V2, high part in the first byte
+static u32
+cpu_sdf_encode(f32 value)
+{
+    f32 scaled = value * 255.0f;
+    f32 high   = floorf(scaled) * kCpuSdfUnormStep;
+    f32 low    = scaled - floorf(scaled);
+    return cpu_sdf_unorm(high) | (cpu_sdf_unorm(low) << 8);
+}
+
+// V2F16 of the two bytes at the bottom of pair
+static f32
+cpu_sdf_decode(u32 pair)
+{
+    f32 high = (f32)(pair & 0xff) / 255.0f;
+    f32 low  = (f32)((pair >> 8) & 0xff) / 255.0f;
+    return (low * kCpuSdfUnormStep) + high;
+}
+
+// linear_wrap_sampler at texel centers
+static s32
+cpu_sdf_wrap(s32 value, s32 count)
+{
+    return ((value % count) + count) % count;
+}
+
+static void
+cpu_sdf_tile_rect(CpuSdf *sdf, u32 tile_index, s32 *x_begin, s32 *y_begin, s32 *x_end, s32 *y_end)
+{
+    *x_begin = (tile_index % sdf->TileColumnCount) * kCpuRenderTileWidth;
+    *y_begin = (tile_index / sdf->TileColumnCount) * kCpuRenderTileHeight;
+    *x_end   = min(*x_begin + kCpuRenderTileWidth, sdf->Width);
+    *y_end   = min(*y_begin + kCpuRenderTileHeight, sdf->Height);
+}
+
+// seed_jump_flood_pipeline: uv scaled by diffuse alpha, zero where nothing was drawn
+static void
+cpu_sdf_seed_tiles(void *data, u32 tile_begin, u32 tile_end)
+{
+    CpuSdf *sdf = (CpuSdf *)data;
+
+    u32 *target_texels = sdf->Texels[sdf->TargetIndex];
+    f32 *target_seed_x = sdf->SeedX[sdf->TargetIndex];
+    f32 *target_seed_y = sdf->SeedY[sdf->TargetIndex];
+
+    for (u32 tile_index = tile_begin; tile_index < tile_end; tile_index++)
+    {
+        s32 x_begin, y_begin, x_end, y_end;
+        cpu_sdf_tile_rect(sdf, tile_index, &x_begin, &y_begin, &x_end, &y_end);
+
+        for (s32 y = y_begin; y < y_end; y++)
+        {
+            f32 v = ((f32)y + 0.5f) / (f32)sdf->Height;
+            for (s32 x = x_begin; x < x_end; x++)
+            {
+                u32 pixel_at = (y * sdf->Width) + x;
+                f32 u        = ((f32)x + 0.5f) / (f32)sdf->Width;
+                f32 alpha    = (f32)sdf->Diffuse[(pixel_at * 4) + 3] / 255.0f;
+
+                u32 texel = cpu_sdf_encode(u * alpha) | (cpu_sdf_encode(v * alpha) << 16);
+
+                target_texels[pixel_at] = texel;
+                target_seed_x[pixel_at] = cpu_sdf_decode(texel);
+                target_seed_y[pixel_at] = cpu_sdf_decode(texel >> 16);
+            }
+        }
+    }
+}
+
+// jump_flood_pipeline for one pixel, also the tail of rows the SSE2 path does not cover
+static void
+cpu_sdf_flood_pixel(CpuSdf *sdf, s32 x, s32 y)
+{
+    u32 *source_texels = sdf->Texels[sdf->SourceIndex];
+    f32 *source_seed_x = sdf->SeedX[sdf->SourceIndex];
+    f32 *source_seed_y = sdf->SeedY[sdf->SourceIndex];
+
+    f32 closest_distance = kCpuSdfFarDistance;
+    u32 closest_at       = 0;
+    b32 closest_found    = 0;
+
+    for (u32 offset_index = 0; offset_index < ArrayCount(kCpuSdfOffsets); offset_index++)
+    {
+        s32 sample_x = cpu_sdf_wrap(x + (kCpuSdfOffsets[offset_index][0] * sdf->JumpDistance), sdf->Width);
+        s32 sample_y = cpu_sdf_wrap(y + (kCpuSdfOffsets[offset_index][1] * sdf->JumpDistance), sdf->Height);
+        u32 sample_at = (sample_y * sdf->Width) + sample_x;
+
+        f32 seed_x   = source_seed_x[sample_at];
+        f32 seed_y   = source_seed_y[sample_at];
+        f32 delta_x  = (seed_x * (f32)sdf->Width) - sdf->PixelU[x];
+        f32 delta_y  = (seed_y * (f32)sdf->Height) - sdf->PixelV[y];
+        f32 distance = sqrtf((delta_x * delta_x) + (delta_y * delta_y));
+
+        if ((seed_x != 0.0f) && (seed_y != 0.0f) && (distance <= closest_distance))
+        {
+            closest_distance = distance;
+            closest_at       = sample_at;
+            closest_found    = 1;
+        }
+    }
+
+    u32 pixel_at = (y * sdf->Width) + x;
+    sdf->Texels[sdf->TargetIndex][pixel_at] = closest_found ? source_texels[closest_at] : 0;
+    sdf->SeedX[sdf->TargetIndex][pixel_at]  = closest_found ? source_seed_x[closest_at] : 0.0f;
+    sdf->SeedY[sdf->TargetIndex][pixel_at]  = closest_found ? source_seed_y[closest_at] : 0.0f;
+}
+
+static void
+cpu_sdf_flood_tiles(void *data, u32 tile_begin, u32 tile_end)
+{
+    CpuSdf *sdf = (CpuSdf *)data;
+
+    #ifdef CPU_RENDER_SSE2
+    s32 width  = sdf->Width;
+    s32 height = sdf->Height;
+    s32 jump   = sdf->JumpDistance;
+
+    u32 *source_texels = sdf->Texels[sdf->SourceIndex];
+    f32 *source_seed_x = sdf->SeedX[sdf->SourceIndex];
+    f32 *source_seed_y = sdf->SeedY[sdf->SourceIndex];
+    u32 *target_texels = sdf->Texels[sdf->TargetIndex];
+    f32 *target_seed_x = sdf->SeedX[sdf->TargetIndex];
+    f32 *target_seed_y = sdf->SeedY[sdf->TargetIndex];
+    #endif
+
+    for (u32 tile_index = tile_begin; tile_index < tile_end; tile_index++)
+    {
+        s32 x_begin, y_begin, x_end, y_end;
+        cpu_sdf_tile_rect(sdf, tile_index, &x_begin, &y_begin, &x_end, &y_end);
+
+        for (s32 y = y_begin; y < y_end; y++)
+        {
+            s32 x = x_begin;
+
+            #ifdef CPU_RENDER_SSE2
+            // start of the three offset rows, wrapped once per row
+            s32 sample_rows_at[3];
+            for (s32 row_offset = -1; row_offset <= 1; row_offset++)
+            {
+                sample_rows_at[row_offset + 1] = cpu_sdf_wrap(y + (row_offset * jump), height) * width;
+            }
+
+            __m128 width4  = _mm_set1_ps((f32)width);
+            __m128 height4 = _mm_set1_ps((f32)height);
+            __m128 zero    = _mm_setzero_ps();
+            __m128 pixel_v = _mm_set1_ps(sdf->PixelV[y]);
+
+            for (; (x + 4) <= x_end; x += 4)
+            {
+                __m128 pixel_u          = _mm_loadu_ps(sdf->PixelU + x);
+                __m128 closest_distance = _mm_set1_ps(kCpuSdfFarDistance);
+                __m128i closest         = _mm_setzero_si128();
+                __m128 closest_x        = zero;
+                __m128 closest_y        = zero;
+
+                for (u32 offset_index = 0; offset_index < ArrayCount(kCpuSdfOffsets); offset_index++)
+                {
+                    s32 sample_x  = x + (kCpuSdfOffsets[offset_index][0] * jump);
+                    s32 row_at    = sample_rows_at[kCpuSdfOffsets[offset_index][1] + 1];
+
+                    // four neighbors of four adjacent pixels are adjacent too, unless the jump wraps inside them
+                    __m128i seed;
+                    __m128 seed_x;
+                    __m128 seed_y;
+                    if ((sample_x >= 0) && ((sample_x + 4) <= width))
+                    {
+                        seed   = _mm_loadu_si128((__m128i *)(source_texels + row_at + sample_x));
+                        seed_x = _mm_loadu_ps(source_seed_x + row_at + sample_x);
+                        seed_y = _mm_loadu_ps(source_seed_y + row_at + sample_x);
+                    }
+                    else
+                    {
+                        s32 lane_at[4];
+                        for (s32 lane = 0; lane < 4; lane++)
+                        {
+                            lane_at[lane] = row_at + cpu_sdf_wrap(sample_x + lane, width);
+                        }
+
+                        seed   = _mm_setr_epi32((s32)source_texels[lane_at[0]], (s32)source_texels[lane_at[1]], (s32)source_texels[lane_at[2]], (s32)source_texels[lane_at[3]]);
+                        seed_x = _mm_setr_ps(source_seed_x[lane_at[0]], source_seed_x[lane_at[1]], source_seed_x[lane_at[2]], source_seed_x[lane_at[3]]);
+                        seed_y = _mm_setr_ps(source_seed_y[lane_at[0]], source_seed_y[lane_at[1]], source_seed_y[lane_at[2]], source_seed_y[lane_at[3]]);
+                    }
+
+                    __m128 delta_x  = _mm_sub_ps(_mm_mul_ps(seed_x, width4), pixel_u);
+                    __m128 delta_y  = _mm_sub_ps(_mm_mul_ps(seed_y, height4), pixel_v);
+                    __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(delta_x, delta_x), _mm_mul_ps(delta_y, delta_y)));
+
+                    __m128 closer    = _mm_and_ps(_mm_and_ps(_mm_cmpneq_ps(seed_x, zero), _mm_cmpneq_ps(seed_y, zero)), _mm_cmple_ps(distance, closest_distance));
+                    __m128i closer_i = _mm_castps_si128(closer);
+
+                    closest_distance = _mm_or_ps(_mm_and_ps(closer, distance), _mm_andnot_ps(closer, closest_distance));
+                    closest_x        = _mm_or_ps(_mm_and_ps(closer, seed_x), _mm_andnot_ps(closer, closest_x));
+                    closest_y        = _mm_or_ps(_mm_and_ps(closer, seed_y), _mm_andnot_ps(closer, closest_y));
+                    closest          = _mm_or_si128(_mm_and_si128(closer_i, seed), _mm_andnot_si128(closer_i, closest));
+                }
+
+                u32 pixel_at = (y * width) + x;
+                _mm_storeu_si128((__m128i *)(target_texels + pixel_at), closest);
+                _mm_storeu_ps(target_seed_x + pixel_at, closest_x);
+                _mm_storeu_ps(target_seed_y + pixel_at, closest_y);
+            }
+            #endif
+
+            for (; x < x_end; x++)
+            {
+                cpu_sdf_flood_pixel(sdf, x, y);
+            }
+        }
+    }
+}
+
+// sdf_pipeline: distance to the flooded seed over the render diagonal
+static void
+cpu_sdf_distance_tiles(void *data, u32 tile_begin, u32 tile_end)
+{
+    CpuSdf *sdf = (CpuSdf *)data;
+
+    u32 *target_texels = sdf->Texels[sdf->TargetIndex];
+    f32 *source_seed_x = sdf->SeedX[sdf->SourceIndex];
+    f32 *source_seed_y = sdf->SeedY[sdf->SourceIndex];
+
+    f32 diagonal = sqrtf(((f32)sdf->Width * (f32)sdf->Width) + ((f32)sdf->Height * (f32)sdf->Height));
+
+    for (u32 tile_index = tile_begin; tile_index < tile_end; tile_index++)
+    {
+        s32 x_begin, y_begin, x_end, y_end;
+        cpu_sdf_tile_rect(sdf, tile_index, &x_begin, &y_begin, &x_end, &y_end);
+
+        for (s32 y = y_begin; y < y_end; y++)
+        {
+            for (s32 x = x_begin; x < x_end; x++)
+            {
+                u32 pixel_at = (y * sdf->Width) + x;
+
+                f32 delta_x  = sdf->PixelU[x] - (source_seed_x[pixel_at] * (f32)sdf->Width);
+                f32 delta_y  = sdf->PixelV[y] - (source_seed_y[pixel_at] * (f32)sdf->Height);
+                f32 distance = sqrtf((delta_x * delta_x) + (delta_y * delta_y));
+
+                target_texels[pixel_at] = cpu_sdf_encode(distance / diagonal) | (0xffu << 24);
+            }
+        }
+    }
+}
+
+// distance field of a width x height R8G8B8A8 diffuse target, usually CpuRender.Diffuse or a captured game_diffuse_color
+static void
+cpu_sdf_build(CpuSdf *sdf, u8 *diffuse, s32 width, s32 height)
+{
+    Assert((u32)(width * height) <= sdf->MaxPixelCount);
+    Assert((width <= kCpuRenderMaxWidth) && (height <= kCpuSdfMaxHeight));
+
+    sdf->Width           = width;
+    sdf->Height          = height;
+    sdf->TileColumnCount = (width + kCpuRenderTileWidth - 1) / kCpuRenderTileWidth;
+    sdf->TileRowCount    = (height + kCpuRenderTileHeight - 1) / kCpuRenderTileHeight;
+    sdf->PassCount       = (u32)ceilf(log_base(2.0f, (f32)max(width, height)));
+    sdf->Diffuse         = diffuse;
+
+    for (s32 x = 0; x < width; x++)
+    {
+        sdf->PixelU[x] = (((f32)x + 0.5f) / (f32)width) * (f32)width;
+    }
+    for (s32 y = 0; y < height; y++)
+    {
+        sdf->PixelV[y] = (((f32)y + 0.5f) / (f32)height) * (f32)height;
+    }
+
+    u32 tile_count = sdf->TileColumnCount * sdf->TileRowCount;
+
+    u64 seed_ticks = platform_ticks();
+
+    sdf->TargetIndex = kCpuSdfTextureJumpFlood;
+    job_pool_parallel_for(sdf->Pool, tile_count, 1, cpu_sdf_seed_tiles, sdf);
+
+    u64 flood_ticks = platform_ticks();
+
+    // ping-pong of EndFrameDirectX11, even passes read jf and write sdf
+    for (u32 pass_index = 0; pass_index < sdf->PassCount; pass_index++)
+    {
+        sdf->JumpDistance = 1 << (sdf->PassCount - pass_index - 1);
+        sdf->SourceIndex  = (pass_index & 1) ? kCpuSdfTextureSdf : kCpuSdfTextureJumpFlood;
+        sdf->TargetIndex  = (pass_index & 1) ? kCpuSdfTextureJumpFlood : kCpuSdfTextureSdf;
+        job_pool_parallel_for(sdf->Pool, tile_count, 1, cpu_sdf_flood_tiles, sdf);
+    }
+
+    u64 distance_ticks = platform_ticks();
+
+    sdf->SourceIndex = kCpuSdfTextureJumpFlood;
+    sdf->TargetIndex = kCpuSdfTextureSdf;
+    job_pool_parallel_for(sdf->Pool, tile_count, 1, cpu_sdf_distance_tiles, sdf);
+
+    u64 end_ticks = platform_ticks();
+
+    sdf->SeedTicks     = flood_ticks - seed_ticks;
+    sdf->FloodTicks    = distance_ticks - flood_ticks;
+    sdf->DistanceTicks = end_ticks - distance_ticks;
+}
+
+// binary PPM of the sdf texture rgb as stored, for byte diffs against a GPU capture
+static b32
+cpu_sdf_write_ppm(CpuSdf *sdf, const char *file_name)
+{
+    u8 row[3 * kCpuRenderMaxWidth];
+
+    FILE *file = fopen(file_name, "wb");
+    if (!file)
+    {
+        return 0;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", sdf->Width, sdf->Height);
+
+    for (s32 y = 0; y < sdf->Height; y++)
+    {
+        for (s32 x = 0; x < sdf->Width; x++)
+        {
+            u32 texel = sdf->Texels[kCpuSdfTextureSdf][(y * sdf->Width) + x];
+            row[(x * 3) + 0] = (u8)(texel & 0xff);
+            row[(x * 3) + 1] = (u8)((texel >> 8) & 0xff);
+            row[(x * 3) + 2] = (u8)((texel >> 16) & 0xff);
+        }
+        fwrite(row, 3, sdf->Width, file);
+    }
+
+    fclose(file);
+    return 1;
+}
@@ -6,12 +6,6 @@ enemy_instances_draw(EnemyInstancesDrawContext *context)
     EnemyInstances *enemy_instances              = context->EnemyInstancesBin;
     EnemyInstancesWave *enemy_instances_wave = EnemyInstancesEnemyInstancesWaveMapPrt(enemy_instances);
 
-    FrameDataFrameData *frame_data_sheet = FrameDataFrameDataPrt(frame_data);
-    FrameDataFrameDataObjectData *object_data_column = FrameDataFrameDataObjectDataPrt(frame_data, frame_data_sheet);
-
-    u16 *frame_data_count_ptr = FrameDataFrameDataCountPrt(frame_data);
-    u16 frame_data_capacity   = *FrameDataFrameDataCapacityPrt(frame_data);
-
     EnemyInstancesEnemyTypes *enemy_sheet = EnemyInstancesEnemyTypesPrt(enemy_instances);
 
     EnemyInstancesWaveEnemyInstances *enemy_instances_wave_sheet  = EnemyInstancesWaveEnemyInstancesPrt(enemy_instances_wave);
@@ -21,7 +15,6 @@ enemy_instances_draw(EnemyInstancesDrawContext *context)
     u8 *enemy_radius_q4 = EnemyInstancesEnemyTypesRadiusQ4Prt(enemy_instances, enemy_sheet);
 
     EnemyInstancesEnemyPositions *enemy_instances_positions_sheet = EnemyInstancesEnemyPositionsPrt(enemy_instances);
-    v2 *enemy_instances_positions                                 = (v2 *)EnemyInstancesEnemyPositionsPositionsPrt(enemy_instances, enemy_instances_positions_sheet);
 
     u16 enemy_positions_count    = *EnemyInstancesEnemyPositionsCountPrt(enemy_instances);
     u16 enemy_positions_capacity = *EnemyInstancesEnemyPositionsCapacityPrt(enemy_instances);
@@ -30,6 +23,9 @@ enemy_instances_draw(EnemyInstancesDrawContext *context)
 
     u64 enemy_instances_live  = *EnemyInstancesInstancesLivePrt(enemy_instances);
 
+    FrameDataCullBatch cull_batch;
+    frame_data_cull_begin(&cull_batch, frame_data);
+
     for (u8 wave_instance_index = 0; wave_instance_index < enemy_positions_count; wave_instance_index++)
     {
         if ((enemy_instances_live & (1ULL << wave_instance_index)) == 0)
@@ -42,17 +38,10 @@ enemy_instances_draw(EnemyInstancesDrawContext *context)
         u8 radius_q4 = enemy_radius_q4[flat_enemy_variation_index];
         f32 radius = ((f32)radius_q4) * kQ4ToFloat;
 
-        v2 enemy_instance_position = enemy_instances_positions[wave_instance_index];
-
-        u16 frame_data_count = (*frame_data_count_ptr) % frame_data_capacity;
-        FrameDataFrameDataObjectData *object_data = object_data_column + frame_data_count;
+        v2 enemy_instance_position = *(v2 *)EnemyInstancesEnemyPositionsPositionsAt(enemy_instances, enemy_instances_positions_sheet, wave_instance_index);
 
-        object_data->PositionAndScale[0] = enemy_instance_position.x;
-        object_data->PositionAndScale[1] = enemy_instance_position.y;
-        object_data->PositionAndScale[2] = radius;
-
-        object_data->MaterialIndex = 4;
-
-        (*frame_data_count_ptr)++;
+        frame_data_cull_push(&cull_batch, enemy_instance_position, radius, 4);
     }
+
+    frame_data_cull_flush(&cull_batch);
 }
\ No newline at end of file
@@ -1,10 +1,10 @@
 
 static v2 
-spawn_position(u8 index, EnemyInstancesSpawnPointsXYQ4 *spawn_points_xy_q4, v2 *enemy_instances_positions)
+spawn_position(u8 index, EnemyInstancesSpawnPointsXYQ4 *spawn_points_xy_q4, EnemyInstances *enemy_instances, EnemyInstancesEnemyPositions *enemy_instances_positions_sheet)
 {
     if (index > 63)
     {
-        return enemy_instances_positions[index - 64];
+        return *(v2 *)EnemyInstancesEnemyPositionsPositionsAt(enemy_instances, enemy_instances_positions_sheet, index - 64);
     }
 
     EnemyInstancesSpawnPointsXYQ4 spawn_point_xy_q4 = spawn_points_xy_q4[index];
@@ -34,8 +34,6 @@ enemy_instances_spawn(EnemyInstancesContext *context)
     EnemyInstancesSpawnPointsXYQ4 *spawn_points_xy_q4 = EnemyInstancesSpawnPointsXYQ4Prt(enemy_instances, spawn_points_sheet);
 
     EnemyInstancesEnemyPositions *enemy_instances_positions_sheet = EnemyInstancesEnemyPositionsPrt(enemy_instances);
-    uint8_t *enemy_instances_way_point_index                      = EnemyInstancesEnemyPositionsWayPointIndexPrt(enemy_instances, enemy_instances_positions_sheet);
-    v2 *enemy_instances_positions                                 = (v2 *)EnemyInstancesEnemyPositionsPositionsPrt(enemy_instances, enemy_instances_positions_sheet);
 
     u16 *enemy_positions_count_prt = EnemyInstancesEnemyPositionsCountPrt(enemy_instances);
     u64 *instances_live_ptr        = EnemyInstancesInstancesLivePrt(enemy_instances);
@@ -61,10 +59,10 @@ enemy_instances_spawn(EnemyInstancesContext *context)
 
         u8 flat_spawn_point_index = enemy_instances_flat_spawn_point_index[wave_instance_index];
 
-        v2 spawn_point = spawn_position(flat_spawn_point_index, spawn_points_xy_q4, enemy_instances_positions);
+        v2 spawn_point = spawn_position(flat_spawn_point_index, spawn_points_xy_q4, enemy_instances, enemy_instances_positions_sheet);
 
-        enemy_instances_positions[wave_instance_index] = spawn_point;
-        enemy_instances_way_point_index[wave_instance_index] = 0;
+        *(v2 *)EnemyInstancesEnemyPositionsPositionsAt(enemy_instances, enemy_instances_positions_sheet, wave_instance_index) = spawn_point;
+        *EnemyInstancesEnemyPositionsWayPointIndexAt(enemy_instances, enemy_instances_positions_sheet, wave_instance_index)   = 0;
         *instances_live_ptr |= 1ULL << wave_instance_index;
         *instances_reset_prt |= 1ULL << wave_instance_index;
 
@@ -103,8 +101,6 @@ enemy_instances_move(EnemyInstancesContext *context)
     u8 *enemy_instance_way_point_time_out_q4                             = EnemyInstancesWayPointPathsIndexTimeOutQ4Prt(enemy_instances, way_point_paths_index_sheet);
 
     EnemyInstancesEnemyPositions *enemy_instances_positions_sheet = EnemyInstancesEnemyPositionsPrt(enemy_instances);
-    uint8_t *enemy_instances_way_point_index                      = EnemyInstancesEnemyPositionsWayPointIndexPrt(enemy_instances, enemy_instances_positions_sheet);
-    v2 *enemy_instances_positions                                 = (v2 *)EnemyInstancesEnemyPositionsPositionsPrt(enemy_instances, enemy_instances_positions_sheet);
 
     u16 enemy_positions_count    = *EnemyInstancesEnemyPositionsCountPrt(enemy_instances);
     u16 enemy_positions_capacity = *EnemyInstancesEnemyPositionsCapacityPrt(enemy_instances);
@@ -154,9 +150,12 @@ enemy_instances_move(EnemyInstancesContext *context)
         u8 way_point_time_out_q4 = enemy_instance_way_point_time_out_q4[way_point_path_index];
         f32 way_point_time_out   = ((f32)way_point_time_out_q4) * kQ4ToFloat;
 
+        v2 *enemy_instance_position_prt       = (v2 *)EnemyInstancesEnemyPositionsPositionsAt(enemy_instances, enemy_instances_positions_sheet, wave_instance_index);
+        u8 *enemy_instance_way_point_index_prt = EnemyInstancesEnemyPositionsWayPointIndexAt(enemy_instances, enemy_instances_positions_sheet, wave_instance_index);
+
         for(u8 i = 0; i < 4; i++)
         {
-            u8 way_point_index = enemy_instances_way_point_index[wave_instance_index];
+            u8 way_point_index = *enemy_instance_way_point_index_prt;
 
             EnemyInstancesWayPointsRedusedXYQ4 way_point_xy_q4 = way_points[way_point_path_index_way_point.WayPointStartIndex + way_point_index];
 
@@ -164,7 +163,7 @@ enemy_instances_move(EnemyInstancesContext *context)
             f32 way_point_y = ((f32)way_point_xy_q4.RedusedYQ4) * kQ4ToFloat;
 
             v2 way_point        = V2(way_point_x, way_point_y);
-            v2 current_position = enemy_instances_positions[wave_instance_index];
+            v2 current_position = *enemy_instance_position_prt;
 
             v2  way_point_v         = v2_sub(way_point, current_position);
             f32 way_point_dist      = v2_length(way_point_v);
@@ -175,7 +174,7 @@ enemy_instances_move(EnemyInstancesContext *context)
                 v2 way_point_move_v = v2_scale(way_point_v, way_point_move_dist / way_point_dist);
                 v2 next_position = v2_add(current_position, way_point_move_v);
 
-                enemy_instances_positions[wave_instance_index] = next_position;
+                *enemy_instance_position_prt = next_position;
             }
 
             if (way_point_dist > frame_move_dist)
@@ -198,7 +197,7 @@ enemy_instances_move(EnemyInstancesContext *context)
                 break;
             }
 
-            enemy_instances_way_point_index[wave_instance_index]++;
+            (*enemy_instance_way_point_index_prt)++;
         }
     }
 }
@@ -212,8 +211,17 @@ enemy_instances_update(EnemyInstancesContext *context)
 
     u8 level_index = *LevelUpdateIndexPrt(level_update);
 
-    u8 wave_index  = *WaveUpdateIndexPrt(wave_update);
-    u32 wave_state = *WaveUpdateStatePrt(wave_update);
+    u8 wave_index = *WaveUpdateIndexPrt(wave_update);
+
+    // wave_update publishes at most one wave start per frame, earlier in the same frame
+    u32 wave_event_count = WaveUpdateWaveEventsRingAvailable(wave_update);
+    Assert(wave_event_count <= 1);
+    if (wave_event_count)
+    {
+        u32 row_index = WaveUpdateWaveEventsRingPeek(wave_update, 0);
+        Assert(*WaveUpdateWaveEventsWaveIndexAt(wave_update, WaveUpdateWaveEventsPrt(wave_update), row_index) == wave_index);
+        WaveUpdateWaveEventsRingConsume(wave_update, wave_event_count);
+    }
 
     u8 flat_wave_index = (level_index << 2) + wave_index;
 
@@ -224,7 +232,7 @@ enemy_instances_update(EnemyInstancesContext *context)
     EnemyInstancesLevelWaveIndexLevelWave *level_wave_index_instance = EnemyInstancesLevelWaveIndexLevelWavePrt(enemy_instances, level_wave_index_sheet);
     EnemyInstancesLevelWaveIndexLevelWave *wave_instance = &level_wave_index_instance[flat_wave_index];
 
-    if (wave_state & kWaveUpdateStateReset)
+    if (wave_event_count)
     {
         EnemyInstancesWave *enemy_instances_wave              = EnemyInstancesEnemyInstancesWaveMapPrt(enemy_instances);
         BulletSourceInstances *enemy_bullets_source_instances = EnemyInstancesBulletSourceInstancesMapPrt(enemy_instances);
@@ -272,8 +280,15 @@ enemy_instances_update(EnemyInstancesContext *context)
     enemy_instances_spawn(context);
 
     b32 is_wave_spawned_all = (*enemy_positions_count_prt) == wave_instance->EnemyInstancesCount;
-    if (is_wave_spawned_all)
+    if (is_wave_spawned_all && ((*wave_state_ptr & kEnemyInstancesWaveSpawnedAll) == 0))
     {
         *wave_state_ptr |= kEnemyInstancesWaveSpawnedAll;
+
+        // wave_update consumes it next frame, it is the only consumer of the ring
+        u32 row_index = EnemyInstancesSpawnEventsRingReserve(enemy_instances);
+        Assert(row_index != kSpscRingFull);
+
+        *EnemyInstancesSpawnEventsWaveIndexAt(enemy_instances, EnemyInstancesSpawnEventsPrt(enemy_instances), row_index) = wave_index;
+        EnemyInstancesSpawnEventsRingPublish(enemy_instances);
     }
 }
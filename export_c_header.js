@@ -1,11 +1,44 @@
 const yaml = require('js-yaml');
 const fs   = require('fs');
 const vm   = require('vm');
+const path = require('path');
 
 const vmContext = {};
 
-const schemaFile = process.argv[2];
-const outputFile = process.argv[3];
+const kRingCursorStride = 64;
+
+// ring cursors are touched from two threads, loads and stores must not be torn or reordered around row access
+const ringCursorText = `#ifndef SPSC_RING_CURSOR
+#define SPSC_RING_CURSOR
+#define kSpscRingFull 0xffffffff
+#ifdef _MSC_VER
+static inline uint32_t SpscRingLoadAcquire(uint32_t *cursor)
+{
+  uint32_t value = *(volatile uint32_t *)cursor;
+  _ReadWriteBarrier();
+  return value;
+}
+static inline void SpscRingStoreRelease(uint32_t *cursor, uint32_t value)
+{
+  _ReadWriteBarrier();
+  *(volatile uint32_t *)cursor = value;
+}
+#else
+static inline uint32_t SpscRingLoadAcquire(uint32_t *cursor)
+{
+  return __atomic_load_n(cursor, __ATOMIC_ACQUIRE);
+}
+static inline void SpscRingStoreRelease(uint32_t *cursor, uint32_t value)
+{
+  __atomic_store_n(cursor, value, __ATOMIC_RELEASE);
+}
+#endif
+#endif
+`;
+
+const schemaFile       = process.argv[2];
+const outputFile       = process.argv[3];
+const staticOutputFile = process.argv[4];
 
 const schema = yaml.load(fs.readFileSync(schemaFile), 'utf8');
 
@@ -17,17 +50,61 @@ if(schema.hasOwnProperty('constants'))
 	});
 }
 
+// a column with enabled: <expression over constants> is left out of the layout when the expression is false,
+// so a schema can switch between column variants with one constant
+if(schema.hasOwnProperty('sheets'))
+{
+    schema.sheets.forEach( sheet => {
+        sheet.columns = sheet.columns.filter( column => !column.hasOwnProperty('enabled') || resolveExpression(column.enabled) );
+    });
+}
+
+const importedSchemas = {};
+if(schema.meta.hasOwnProperty('import'))
+{
+    schema.meta.import.forEach( importName => {
+        const importSchemaFile = `${importName}.schema.yml`;
+        importedSchemas[importName] = yaml.load(fs.readFileSync(importSchemaFile), 'utf8');
+    });
+}
+
 const exportText = buildCHeader(schema);
 
-fs.writeFileSync(outputFile, exportText, 'utf8')
+fs.writeFileSync(outputFile, exportText.header, 'utf8')
+
+if(staticOutputFile)
+{
+    if(exportText.staticHeader)
+    {
+        fs.writeFileSync(staticOutputFile, exportText.staticHeader, 'utf8')
+    }
+    else
+    {
+        Log(`static layout is data dependent, ${staticOutputFile} not exported`);
+    }
+}
 
 function buildCHeader(schema)
 {
 	const exportTypes = exportSheets();
 	
 	const exportText = exportTypesToText(exportTypes);
+
+    let staticExportText = null;
+
+    if(staticOutputFile)
+    {
+        const staticLayout = buildStaticLayout(schema);
+        if(staticLayout)
+        {
+            staticExportText = exportStaticTypesToText(exportTypes, staticLayout);
+        }
+    }
 	
-	return exportText;
+	return {
+        header: exportText,
+        staticHeader: staticExportText
+    };
 	
 	function exportSheets()
 	{
@@ -37,6 +114,8 @@ function buildCHeader(schema)
             structs:     [],
 			functions:   [],
             refStructs:  [],
+            contextFunctions: [],
+            ringFunctions: [],
 		};
 		
 		const hasSheets    = schema.hasOwnProperty('sheets');
@@ -59,6 +138,14 @@ function buildCHeader(schema)
 			});
 			
 		}
+
+        if(schema.meta.hasOwnProperty('pad_to'))
+        {
+            exportTypes.constants.push({
+                key: `${rootStructName}PadTo`,
+                value: resolveExpression(schema.meta.pad_to)|0
+            });
+        }
 		
         const fields = [];
 
@@ -81,6 +168,9 @@ function buildCHeader(schema)
 
             	exportTypes.functions.push({
                     returnType: `${mapType}`,
+                    prefix: `${rootStructName}${mapNameInPascal}Map`,
+                    segment: mapName,
+                    field: `${mapNameInPascal}MapOffset`,
                     name: `*${mapName}_map_prt`,
                     call: `${rootStructName}${mapNameInPascal}MapPrt(${schema.meta.name}_bin)`,
 				    declaration: `${mapType} *${rootStructName}${mapNameInPascal}MapPrt(${rootStructName} *root)`,
@@ -97,12 +187,16 @@ function buildCHeader(schema)
             fields.push( ...sheets.flatMap((sheet) => 
 				[`${schema.meta.size} ${undersoreToPascal(sheet.name)}CountOffset`,
                  `${schema.meta.size} ${undersoreToPascal(sheet.name)}CapacityOffset`,
-				 `${schema.meta.size} ${undersoreToPascal(sheet.name)}Offset`]) 
+				 `${schema.meta.size} ${undersoreToPascal(sheet.name)}Offset`].concat(isRingSheet(sheet) ? 
+                [`${schema.meta.size} ${undersoreToPascal(sheet.name)}RingOffset`] : [])) 
             );
 
             sheets.forEach( sheet => {
             	exportTypes.functions.push({
                     returnType: `${schema.meta.size}`,
+                    prefix: `${rootStructName}${undersoreToPascal(sheet.name)}Count`,
+                    segment: `${sheet.name}Count`,
+                    field: `${undersoreToPascal(sheet.name)}CountOffset`,
                     name: `*${sheet.name}_count_prt`,
                     call: `${rootStructName}${undersoreToPascal(sheet.name)}CountPrt(${schema.meta.name}_bin)`,
 				    declaration: `${schema.meta.size} *${rootStructName}${undersoreToPascal(sheet.name)}CountPrt(${rootStructName} *root)`,
@@ -110,12 +204,20 @@ function buildCHeader(schema)
 			    });
                 exportTypes.functions.push({
                     returnType: `${schema.meta.size}`,
+                    prefix: `${rootStructName}${undersoreToPascal(sheet.name)}Capacity`,
+                    segment: `${sheet.name}Capacity`,
+                    field: `${undersoreToPascal(sheet.name)}CapacityOffset`,
                     name: `*${sheet.name}_capacity_prt`,
                     call: `${rootStructName}${undersoreToPascal(sheet.name)}CapacityPrt(${schema.meta.name}_bin)`,
 				    declaration: `${schema.meta.size} *${rootStructName}${undersoreToPascal(sheet.name)}CapacityPrt(${rootStructName} *root)`,
 				    body: `return (root->${undersoreToPascal(sheet.name)}CapacityOffset) ? (${schema.meta.size} *)((uintptr_t)root + root->${undersoreToPascal(sheet.name)}CapacityOffset) : NULL;`
 			    });
                 exportSheet(sheet, rootStructName, exportTypes);		
+
+                if(isRingSheet(sheet))
+                {
+                    exportRing(sheet, rootStructName, exportTypes);
+                }
             });
         }
 
@@ -165,6 +267,52 @@ function buildCHeader(schema)
             }));
 
             exportTypes.structs.push(contextStruct);
+
+            // root is always written, other blobs are read unless declared with access: write
+            const reads  = [];
+            const writes = [];
+
+            if(hasRootStruct)
+            {
+                writes.push('Root');
+            }
+
+            schema.context.forEach( ref => {
+                const refName = undersoreToPascal(ref.name);
+                const access  = ref.hasOwnProperty('access') ? ref.access : 'read';
+
+                if(access == 'write')
+                {
+                    writes.push(refName);
+                }
+                else if(access == 'read')
+                {
+                    reads.push(refName);
+                }
+                else
+                {
+                    Log(`context ${ref.name} has unknown access ${access}`);
+                    reads.push(refName);
+                }
+            });
+
+            exportTypes.constants.push({
+                key: `${contextStructName}ReadCount`,
+                value: reads.length
+            });
+            exportTypes.constants.push({
+                key: `${contextStructName}WriteCount`,
+                value: writes.length
+            });
+
+            exportTypes.contextFunctions.push({
+                declaration: `uint32_t ${contextStructName}Reads(${contextStructName} *context, void **reads)`,
+                body: [ ...reads.map( (refName, index) => `reads[${index}] = context->${refName};` ), `return ${reads.length};` ]
+            });
+            exportTypes.contextFunctions.push({
+                declaration: `uint32_t ${contextStructName}Writes(${contextStructName} *context, void **writes)`,
+                body: [ ...writes.map( (refName, index) => `writes[${index}] = context->${refName};` ), `return ${writes.length};` ]
+            });
         }
 
 		return exportTypes;
@@ -179,6 +327,9 @@ function buildCHeader(schema)
 
             exportTypes.functions.push({
                 returnType: `${variableType.type}`,
+                prefix: `${rootStructName}${variableName}`,
+                segment: `${schema.meta.name}:${variable.name}`,
+                field: `${variableName}Offset`,
                 name: `*${variable.name}_prt`,
                 call: `${rootStructName}${variableName}Prt(${schema.meta.name}_bin)`,
 				declaration: `${variableType.type} *${rootStructName}${variableName}Prt(${rootStructName} *root)`,
@@ -196,12 +347,15 @@ function buildCHeader(schema)
 			
 			exportTypes.packStructs.push({
 				name: sheetStructName,
-				fields: columns.flatMap((column) => [ 
-					`${schema.meta.size} ${undersoreToPascal(column.name)}Offset` ])
+				fields: [`${schema.meta.size} BlockRows`, `${schema.meta.size} BlockStride`].concat(columns.flatMap((column) => [ 
+					`${schema.meta.size} ${undersoreToPascal(column.name)}Offset` ]))
 			});
 			
 			exportTypes.functions.push({
                 returnType: `${sheetStructName}`,
+                prefix: sheetStructName,
+                segment: sheetName,
+                field: `${undersoreToPascal(sheetName)}Offset`,
                 name: `*${schema.meta.name}_${sheet.name}_sheet`,
                 call: `${sheetStructName}Prt(${schema.meta.name}_bin)`,
 				declaration: `${sheetStructName} *${sheetStructName}Prt(${rootStructName} *root)`,
@@ -213,6 +367,63 @@ function buildCHeader(schema)
 			});
 		}
 		
+        // producer: Reserve row, fill columns, Publish; consumer: Available, Peek rows, Consume
+        function exportRing(sheet, rootStructName, exportTypes)
+        {
+            const sheetStructName = `${rootStructName}${undersoreToPascal(sheet.name)}`;
+            const ringStructName  = `${sheetStructName}Ring`;
+
+            exportTypes.structs.push({
+                name: ringStructName,
+                fields: [`uint32_t Write`, `uint8_t WritePadding[${kRingCursorStride - 4}]`,
+                         `uint32_t Read`, `uint8_t ReadPadding[${kRingCursorStride - 4}]`]
+            });
+
+            exportTypes.functions.push({
+                returnType: `${ringStructName}`,
+                prefix: ringStructName,
+                segment: `${sheet.name}Ring`,
+                field: `${undersoreToPascal(sheet.name)}RingOffset`,
+                name: `*${schema.meta.name}_${sheet.name}_ring`,
+                call: `${ringStructName}Prt(${schema.meta.name}_bin)`,
+                declaration: `${ringStructName} *${ringStructName}Prt(${rootStructName} *root)`,
+                body: `return (root->${undersoreToPascal(sheet.name)}RingOffset) ? (${ringStructName} *)((uintptr_t)root + root->${undersoreToPascal(sheet.name)}RingOffset) : NULL;`
+            });
+
+            const ring     = `${ringStructName} *ring = ${ringStructName}Prt(root);`;
+            const capacity = `uint32_t capacity = *${sheetStructName}CapacityPrt(root);`;
+
+            exportTypes.ringFunctions.push({
+                declaration: `uint32_t ${ringStructName}Reserve(${rootStructName} *root)`,
+                body: [ring, capacity,
+                       `if ((ring->Write - SpscRingLoadAcquire(&ring->Read)) >= capacity)`,
+                       `{`,
+                       `  return kSpscRingFull;`,
+                       `}`,
+                       `return ring->Write % capacity;`]
+            });
+            exportTypes.ringFunctions.push({
+                declaration: `void ${ringStructName}Publish(${rootStructName} *root)`,
+                body: [ring,
+                       `SpscRingStoreRelease(&ring->Write, ring->Write + 1);`]
+            });
+            exportTypes.ringFunctions.push({
+                declaration: `uint32_t ${ringStructName}Available(${rootStructName} *root)`,
+                body: [ring,
+                       `return SpscRingLoadAcquire(&ring->Write) - ring->Read;`]
+            });
+            exportTypes.ringFunctions.push({
+                declaration: `uint32_t ${ringStructName}Peek(${rootStructName} *root, uint32_t index)`,
+                body: [ring, capacity,
+                       `return (ring->Read + index) % capacity;`]
+            });
+            exportTypes.ringFunctions.push({
+                declaration: `void ${ringStructName}Consume(${rootStructName} *root, uint32_t count)`,
+                body: [ring,
+                       `SpscRingStoreRelease(&ring->Read, ring->Read + count);`]
+            });
+        }
+
 		function exportColumn(column, rootStructName, sheetName, exportTypes)
 		{
 			const sources = column.sources;
@@ -222,13 +433,50 @@ function buildCHeader(schema)
 						
             const columnType = exportComplexTypes(columnStructName, sources, exportTypes);
 
+            // column data offset is multiple of align, storage has pad_to rows so vector tails stay in bounds
+            const columnAlign = getColumnAlign(column);
+            if(columnAlign > 1)
+            {
+                exportTypes.constants.push({
+                    key: `${columnStructName}Align`,
+                    value: columnAlign
+                });
+            }
+            if(column.hasOwnProperty('pad_to'))
+            {
+                exportTypes.constants.push({
+                    key: `${columnStructName}PadTo`,
+                    value: resolveExpression(column.pad_to)|0
+                });
+            }
+
 			exportTypes.functions.push({
                 returnType: `${columnType.type}`,
+                prefix: columnStructName,
+                segment: `${sheetName}:${column.name}`,
+                field: `${undersoreToPascal(column.name)}Offset`,
+                sheet: sheetName,
+                sheetPrefix: sheetStructName,
+                columnType: columnType.type,
                 name: `*${sheetName}_${column.name}_prt`,
                 call: `${columnStructName}Prt(${schema.meta.name}_bin, ${schema.meta.name}_${sheetName}_sheet)`,
 				declaration: `${columnType.type} *${columnStructName}Prt(${rootStructName} *root, ${sheetStructName} *sheet)`,
 				body: `return (sheet->${undersoreToPascal(column.name)}Offset) ? (${columnType.type} *)((uintptr_t)root + sheet->${undersoreToPascal(column.name)}Offset) : NULL;`
 			});
+
+            // same call for soa, aos and aosoa sheets, BlockRows is 0 for soa
+			exportTypes.functions.push({
+                returnType: `${columnType.type}`,
+                name: `*${sheetName}_${column.name}_at`,
+                call: `${columnStructName}At(${schema.meta.name}_bin, ${schema.meta.name}_${sheetName}_sheet, index)`,
+				declaration: `${columnType.type} *${columnStructName}At(${rootStructName} *root, ${sheetStructName} *sheet, uint32_t index)`,
+				body: [`uintptr_t column = (uintptr_t)root + sheet->${undersoreToPascal(column.name)}Offset;`,
+                       `if (sheet->BlockRows == 0)`,
+                       `{`,
+                       `  return (${columnType.type} *)column + index;`,
+                       `}`,
+                       `return (${columnType.type} *)(column + ((index / sheet->BlockRows) * sheet->BlockStride) + ((index % sheet->BlockRows) * sizeof(${columnType.type})));`].join('\n  ')
+			});
 			
 		}		
 	}
@@ -371,6 +619,26 @@ function buildCHeader(schema)
             text += '\n';
         }
 
+        if(exportTypes.contextFunctions.length > 0)
+        {
+            exportTypes.contextFunctions.forEach((fun) => {
+                text += `static inline`
+                text += '\n';
+                text += fun.declaration;
+                text += '\n';
+                text += '{';
+                text += '\n';
+                fun.body.forEach((line) => {
+                    text += `  ${line}`;
+                    text += '\n';
+                });
+                text += '}'
+                text += '\n';
+            });
+
+            text += '\n';
+        }
+
         if(exportTypes.functions.length > 0)
         {
             exportTypes.functions.forEach((fun) => {
@@ -396,6 +664,28 @@ function buildCHeader(schema)
             text += '*/\n';
         }
 
+        if(exportTypes.ringFunctions.length > 0)
+        {
+            text += '\n';
+            text += ringCursorText;
+            text += '\n';
+
+            exportTypes.ringFunctions.forEach((fun) => {
+                text += `static inline`
+                text += '\n';
+                text += fun.declaration;
+                text += '\n';
+                text += '{';
+                text += '\n';
+                fun.body.forEach((line) => {
+                    text += `  ${line}`;
+                    text += '\n';
+                });
+                text += '}'
+                text += '\n';
+            });
+        }
+
         if(schema.hasOwnProperty('context'))
         {
             text += '/* context\n';
@@ -426,6 +716,393 @@ function buildCHeader(schema)
 
 		return text;
 	}
+
+	function exportStaticTypesToText(exportTypes, staticLayout)
+	{
+        const rootStructName = undersoreToPascal(schema.meta.name);
+
+        const staticFunctions = exportTypes.functions.filter( fun => staticLayout.offsets.hasOwnProperty(fun.segment) );
+        const sheetFunctions  = staticFunctions.filter( fun => staticLayout.blocks.hasOwnProperty(fun.segment) );
+        const columnFunctions = staticFunctions.filter( fun => fun.hasOwnProperty('sheet') );
+
+		let text = '#pragma once\n';
+		text += '\n';
+
+		text += `#include "${path.basename(outputFile)}"\n`;
+		text += '\n';
+
+        text += `#define k${`${rootStructName}StaticSize`.padEnd(40, ' ')} ${staticLayout.size}\n`;
+        text += '\n';
+
+        staticFunctions.forEach((fun) => {
+            text += `#define k${`${fun.prefix}StaticOffset`.padEnd(40, ' ')} ${staticLayout.offsets[fun.segment]}\n`;
+        });
+        text += '\n';
+
+        if(Object.keys(staticLayout.capacities).length > 0)
+        {
+            Object.keys(staticLayout.capacities).forEach((sheetName) => {
+                text += `#define k${`${rootStructName}${undersoreToPascal(sheetName)}StaticCapacity`.padEnd(40, ' ')} ${staticLayout.capacities[sheetName]}\n`;
+            });
+            sheetFunctions.forEach((fun) => {
+                text += `#define k${`${fun.prefix}StaticBlockRows`.padEnd(40, ' ')} ${staticLayout.blocks[fun.segment].rows}\n`;
+                text += `#define k${`${fun.prefix}StaticBlockStride`.padEnd(40, ' ')} ${staticLayout.blocks[fun.segment].stride}\n`;
+            });
+            columnFunctions.forEach((fun) => {
+                text += `#define k${`${fun.prefix}StaticStride`.padEnd(40, ' ')} ${staticLayout.strides[fun.segment]}\n`;
+            });
+            text += '\n';
+        }
+
+        staticFunctions.forEach((fun) => {
+            text += `static inline`
+            text += '\n';
+            text += `${fun.returnType} *${fun.prefix}StaticPrt(${rootStructName} *root)`;
+            text += '\n';
+            text += '{';
+            text += '\n';
+            text += `  return (${fun.returnType} *)((uintptr_t)root + k${fun.prefix}StaticOffset);`;
+            text += '\n';
+            text += '}'
+            text += '\n';
+        });
+
+        // block layout is known at generation time, so element address has no branch
+        columnFunctions.forEach((fun) => {
+            const sheetPrefix = fun.sheetPrefix;
+
+            text += `static inline`
+            text += '\n';
+            text += `${fun.returnType} *${fun.prefix}StaticAt(${rootStructName} *root, uint32_t index)`;
+            text += '\n';
+            text += '{';
+            text += '\n';
+            if(staticLayout.blocks[fun.sheet].rows == 0)
+            {
+                text += `  return (${fun.returnType} *)((uintptr_t)root + k${fun.prefix}StaticOffset + (index * k${fun.prefix}StaticStride));`;
+            }
+            else
+            {
+                text += `  return (${fun.returnType} *)((uintptr_t)root + k${fun.prefix}StaticOffset + ((index / k${sheetPrefix}StaticBlockRows) * k${sheetPrefix}StaticBlockStride) + ((index % k${sheetPrefix}StaticBlockRows) * k${fun.prefix}StaticStride));`;
+            }
+            text += '\n';
+            text += '}'
+            text += '\n';
+        });
+
+        // debug check that binary was exported with the same layout this header was generated for
+        text += `static inline`
+        text += '\n';
+        text += `int ${rootStructName}StaticLayoutMatch(${rootStructName} *root)`;
+        text += '\n';
+        text += '{';
+        text += '\n';
+        text += '  return ';
+        text += staticFunctions.map((fun) => {
+            const owner = fun.hasOwnProperty('sheetPrefix') ? `${fun.sheetPrefix}StaticPrt(root)` : 'root';
+            return `(${owner}->${fun.field} == k${fun.prefix}StaticOffset)`;
+        }).concat(sheetFunctions.map((fun) => {
+            return `(${fun.prefix}StaticPrt(root)->BlockRows == k${fun.prefix}StaticBlockRows)`;
+        })).join(' &&\n         ');
+        text += ';';
+        text += '\n';
+        text += '}'
+        text += '\n';
+        text += '\n';
+
+        text += '/* functions\n';
+        staticFunctions.forEach((fun) => {
+            text += `${fun.returnType} ${fun.name} = ${fun.prefix}StaticPrt(${schema.meta.name}_bin);`
+            text += '\n';
+        });
+        text += '*/\n';
+
+        return text;
+	}
+}
+
+// Mirrors segment order of export_runtime_binary.js, returns null when layout depends on source data
+function buildStaticLayout(schema)
+{
+    const hasSheets    = schema.hasOwnProperty('sheets');
+    const hasVariables = schema.hasOwnProperty('variables');
+    const hasMaps      = schema.hasOwnProperty('maps');
+
+    const hasRootStruct = hasSheets || hasVariables || hasMaps;
+
+    if(!hasRootStruct)
+    {
+        return null;
+    }
+
+    if(hasSheets && schema.sheets.some( sheet => !sheet.hasOwnProperty('capacity') ))
+    {
+        return null;
+    }
+
+    const metaSize = getBytesSize(schema.meta.size);
+
+    const layout = {
+        offsets:    {},
+        capacities: {},
+        blocks:     {},
+        strides:    {},
+        size:       0
+    };
+
+    const dataSegments = [];
+
+    if(hasMaps)
+    {
+        schema.maps.forEach( map => {
+            const mapSegmentType = map.type;
+            let mapSegmentName = map.type;
+
+            if(map.hasOwnProperty('name'))
+            {
+                mapSegmentName = map.name;
+            }
+
+            if(!importedSchemas.hasOwnProperty(mapSegmentType))
+            {
+                Log(`missing import for map type ${mapSegmentName}`);
+                return;
+            }
+
+            const targetSchema = importedSchemas[mapSegmentType];
+
+            const targetHasSheets = targetSchema.hasOwnProperty('sheets');
+            const targetHasValues = targetSchema.hasOwnProperty('variables');
+
+            layout.size += metaSize;
+
+            if(targetHasSheets || targetHasValues)
+            {
+                dataSegments.push({
+                    name: mapSegmentName,
+                    getSize: () => {
+                        let size = 0;
+                        if(targetHasSheets)
+                        {
+                            targetSchema.sheets.forEach( targetSheet => {
+                                size += (isRingSheet(targetSheet) ? 4 : 3) * metaSize;
+                                dataSegments.push({
+                                    name: `${mapSegmentName}:${targetSheet.name}`,
+                                    getSize: () => (targetSheet.columns.length + 2) * metaSize
+                                });
+                            });
+                        }
+                        if(targetHasValues)
+                        {
+                            size += targetSchema.variables.length * metaSize;
+                        }
+                        return size;
+                    }
+                });
+            }
+        });
+    }
+
+    if(hasSheets)
+    {
+        schema.sheets.forEach( sheet => {
+            const sheetBlock = getSheetBlock(sheet);
+
+            let rowCapacity = getSheetCapacity(resolveExpression(sheet.capacity)|0);
+            if(sheetBlock.rows > 1)
+            {
+                rowCapacity = alignUp(rowCapacity, sheetBlock.rows);
+            }
+
+            layout.capacities[sheet.name] = rowCapacity;
+            layout.blocks[sheet.name] = sheetBlock;
+            layout.size += (isRingSheet(sheet) ? 4 : 3) * metaSize;
+
+            dataSegments.push({ name: `${sheet.name}Count`,    getSize: () => metaSize });
+            dataSegments.push({ name: `${sheet.name}Capacity`, getSize: () => metaSize });
+            if(isRingSheet(sheet))
+            {
+                dataSegments.push({ name: `${sheet.name}Ring`, align: kRingCursorStride, getSize: () => 2 * kRingCursorStride });
+            }
+            dataSegments.push({
+                name: sheet.name,
+                getSize: () => {
+                    sheet.columns.forEach( column => {
+                        const columnSegmentName = `${sheet.name}:${column.name}`;
+                        const stride = getTypesSize(column.sources);
+                        const columnRows = getColumnRows(column, rowCapacity);
+
+                        layout.strides[columnSegmentName] = stride;
+
+                        if(sheetBlock.rows == 0)
+                        {
+                            dataSegments.push({ name: columnSegmentName, align: getColumnAlign(column), getSize: () => columnRows * stride });
+                        }
+                    });
+
+                    if(sheetBlock.rows > 0)
+                    {
+                        dataSegments.push({
+                            name: `${sheet.name}:blocks`,
+                            align: Math.max(...sheet.columns.map( column => getColumnAlign(column) )),
+                            getSize: () => {
+                                let columnOffset = layout.size;
+                                sheet.columns.forEach( column => {
+                                    const columnSegmentName = `${sheet.name}:${column.name}`;
+                                    layout.offsets[columnSegmentName] = columnOffset;
+                                    columnOffset += sheetBlock.rows * layout.strides[columnSegmentName];
+                                });
+                                return (rowCapacity / sheetBlock.rows) * sheetBlock.stride;
+                            }
+                        });
+                    }
+
+                    return (sheet.columns.length + 2) * metaSize;
+                }
+            });
+        });
+    }
+
+    if(hasVariables)
+    {
+        schema.variables.forEach( variable => {
+            layout.size += metaSize;
+            dataSegments.push({ name: `${schema.meta.name}:${variable.name}`, getSize: () => getTypesSize(variable.types) });
+        });
+    }
+
+    while(dataSegments.length)
+    {
+        const dataSegment = dataSegments.shift();
+        if(dataSegment.hasOwnProperty('align'))
+        {
+            layout.size = alignUp(layout.size, dataSegment.align);
+        }
+        layout.offsets[dataSegment.name] = layout.size;
+        layout.size += dataSegment.getSize();
+    }
+
+    return layout;
+}
+
+function getSheetCapacity(rowCapacity)
+{
+    if(schema.meta.hasOwnProperty('pad_to'))
+    {
+        return alignUp(rowCapacity, resolveExpression(schema.meta.pad_to)|0);
+    }
+    return rowCapacity;
+}
+
+function getColumnRows(column, rowCapacity)
+{
+    if(column.hasOwnProperty('pad_to'))
+    {
+        return alignUp(rowCapacity, resolveExpression(column.pad_to)|0);
+    }
+    return rowCapacity;
+}
+
+function getColumnAlign(column)
+{
+    let align = 0;
+    if(schema.meta.hasOwnProperty('align'))
+    {
+        align = resolveExpression(schema.meta.align)|0;
+    }
+    if(column.hasOwnProperty('align'))
+    {
+        align = resolveExpression(column.align)|0;
+    }
+    return align;
+}
+
+function alignUp(value, alignment)
+{
+    if(alignment > 1)
+    {
+        return Math.ceil(value / alignment) * alignment;
+    }
+    return value;
+}
+
+function getSheetBlock(sheet)
+{
+    const block = {
+        rows:   0,
+        stride: 0
+    };
+
+    if(sheet && sheet.hasOwnProperty('layout'))
+    {
+        const [layoutType, layoutWidth] = `${sheet.layout}`.split(':');
+
+        if(layoutType == 'aos')
+        {
+            block.rows = 1;
+        }
+        else if((layoutType == 'aosoa') && layoutWidth)
+        {
+            block.rows = Math.max(resolveExpression(layoutWidth)|0, 0);
+        }
+
+        const rowSize = sheet.columns.reduce( (size, column) => size + getTypesSize(column.sources), 0);
+        block.stride = block.rows * rowSize;
+    }
+
+    return block;
+}
+
+function getTypesSize(types)
+{
+    let size = 0;
+    types.forEach( t => {
+        let count = 1;
+        if(t.hasOwnProperty('count'))
+        {
+            count = resolveExpression(t.count)|0;
+        }
+        size += getBytesSize(t.type) * count;
+    });
+    return size;
+}
+
+function getBytesSize(size)
+{
+    switch(size)
+    {
+        case 'uint8_t':
+        case 'int8_t':
+        {
+            return 1;
+        }
+        break;
+        case 'uint16_t':
+        case 'int16_t':
+        {
+            return 2;
+        }
+        break;
+        case 'uint32_t':
+        case 'int32_t':
+        case 'float':
+        {
+            return 4;
+        }
+        break;
+        case 'uint64_t':
+        case 'int64_t':
+        case 'double':
+        {
+            return 8;
+        }
+        break;
+    }
+}
+
+function isRingSheet(sheet)
+{
+    return sheet.hasOwnProperty('ring') && (sheet.ring == 'spsc');
 }
 
 function resolveExpression(text)
@@ -447,4 +1124,9 @@ function lowerFirstCharacter(text)
 {
 	const result = text.charAt(0).toLowerCase() + text.slice(1);
 	return result;
+}
+
+function Log(text)
+{
+    console.log(`${text} | ${schemaFile}`)
 }
\ No newline at end of file
@@ -17,6 +17,15 @@ if(schema.hasOwnProperty('constants'))
 	});
 }
 
+// a column with enabled: <expression over constants> is left out of the layout when the expression is false,
+// so a schema can switch between column variants with one constant
+if(schema.hasOwnProperty('sheets'))
+{
+    schema.sheets.forEach( sheet => {
+        sheet.columns = sheet.columns.filter( column => !column.hasOwnProperty('enabled') || resolveExpression(vmContext, column.enabled) );
+    });
+}
+
 const importedSchemas = {};
 if(schema.meta.hasOwnProperty('import'))
 {
@@ -174,6 +183,11 @@ function buildImHexPattern(schema)
                         `${imHexMetaSize} ${undersoreToPascal(targetSheet.name)}CapacityOffset`,
                         `${imHexMetaSize} ${undersoreToPascal(targetSheet.name)}Capacity @ ${imHexMetaSize}(${undersoreToPascal(targetSheet.name)}CapacityOffset + addressof(this))`,
                         `${imHexMetaSize} ${undersoreToPascal(targetSheet.name)}Offset`])
+
+                    if(isRingSheet(targetSheet))
+                    {
+                        mapFields.push(`${imHexMetaSize} ${undersoreToPascal(targetSheet.name)}RingOffset`);
+                    }
                     
                     let mapSourceSheet = null;
                     if(hasMapSheets)
@@ -265,7 +279,7 @@ function buildImHexPattern(schema)
             
             const targetColumns = targetSheet.columns;
 
-            const fields = [];
+            const fields = [`${imHexMetaSize} BlockRows`, `${imHexMetaSize} BlockStride`];
 
             mapFields.push(`if(${undersoreToPascal(targetSheet.name)}Offset > 0) ${mapSheetStructName} ${undersoreToPascal(targetSheet.name)} @ ${imHexMetaSize}(${undersoreToPascal(targetSheet.name)}Offset + addressof(this))`);
 
@@ -349,7 +363,8 @@ function buildImHexPattern(schema)
                 const columnStructName = `${sheetStructName}${undersoreToPascal(targetColumn.name)}`;
                 const columnType = exportComplexTypes(columnContext, columnStructName, columnSources, true, exportTypes);
 
-                fields.push(`if(${undersoreToPascal(targetColumn.name)}Offset > 0) ${columnType.type} ${undersoreToPascal(targetColumn.name)}[parent.${undersoreToPascal(targetSheet.name)}Capacity] @ ${imHexMetaSize}(${undersoreToPascal(targetColumn.name)}Offset + addressof(parent))`);
+                // interleaved source rows are shown by source sheet blocks
+                fields.push(`if(${undersoreToPascal(targetColumn.name)}Offset > 0 && BlockRows == 0) ${columnType.type} ${undersoreToPascal(targetColumn.name)}[parent.${undersoreToPascal(targetSheet.name)}Capacity] @ ${imHexMetaSize}(${undersoreToPascal(targetColumn.name)}Offset + addressof(parent))`);
             });
 
             exportTypes.structs.push({
@@ -374,20 +389,55 @@ function buildImHexPattern(schema)
                  `${imHexMetaSize} ${undersoreToPascal(sheet.name)}Capacity @ ${undersoreToPascal(sheet.name)}CapacityOffset`,
 				 `${imHexMetaSize} ${undersoreToPascal(sheet.name)}Offset`,
                  `if(${undersoreToPascal(sheet.name)}Offset > 0) ${sheetStructName} ${undersoreToPascal(sheet.name)} @ ${undersoreToPascal(sheet.name)}Offset`]);
+
+            if(isRingSheet(sheet))
+            {
+                const ringStructName = `${sheetStructName}Ring`;
+
+                exportTypes.structs.push({
+                    name: ringStructName,
+                    fields: [`u32 Write`, `padding[60]`, `u32 Read`, `padding[60]`]
+                });
+
+                fields.push( ...[`${imHexMetaSize} ${undersoreToPascal(sheet.name)}RingOffset`,
+                    `if(${undersoreToPascal(sheet.name)}RingOffset > 0) ${ringStructName} ${undersoreToPascal(sheet.name)}Ring @ ${undersoreToPascal(sheet.name)}RingOffset`]);
+            }
 			
-            const sheetFields = [];
+            const sheetFields = [`${imHexMetaSize} BlockRows`, `${imHexMetaSize} BlockStride`];
 
-			columns.forEach( column => {
-				exportColumn(sheetFields, column, rootStructName, sheetName, exportTypes);
+            const blockRows = getSheetBlockRows(sheet);
+
+			const columnTypes = columns.map( column => {
+				return exportColumn(sheetFields, column, rootStructName, sheetName, blockRows > 0, exportTypes);
 			});
 
+            if(blockRows > 0)
+            {
+                const blockStructName = `${sheetStructName}Block`;
+
+                exportTypes.structs.push({
+                    name: blockStructName,
+                    fields: columns.map( (column, index) => {
+                        const columnType = columnTypes[index];
+                        if(blockRows > 1)
+                        {
+                            return `${columnType.type} ${undersoreToPascal(column.name)}[${blockRows}]`;
+                        }
+                        return `${columnType.type} ${undersoreToPascal(column.name)}`;
+                    })
+                });
+
+                const firstColumnOffset = `${undersoreToPascal(columns[0].name)}Offset`;
+                sheetFields.push(`if(${firstColumnOffset} > 0) ${blockStructName} Blocks[parent.${undersoreToPascal(sheetName)}Capacity / BlockRows] @ ${firstColumnOffset}`);
+            }
+
 			exportTypes.structs.push({
 				name: sheetStructName,
 				fields: sheetFields
 			});
 		}
 		
-		function exportColumn(fields, column, rootStructName, sheetName, exportTypes)
+		function exportColumn(fields, column, rootStructName, sheetName, interleaved, exportTypes)
 		{
 			const sources = column.sources;
 			
@@ -397,7 +447,12 @@ function buildImHexPattern(schema)
             const columnType = exportComplexTypes(vmContext, columnStructName, sources, true, exportTypes);
 
             fields.push(`${imHexMetaSize} ${undersoreToPascal(column.name)}Offset`);
-            fields.push(`if(${undersoreToPascal(column.name)}Offset > 0) ${columnType.type} ${undersoreToPascal(column.name)}[parent.${undersoreToPascal(sheetName)}Capacity] @ ${undersoreToPascal(column.name)}Offset`);
+            if(!interleaved)
+            {
+                fields.push(`if(${undersoreToPascal(column.name)}Offset > 0) ${columnType.type} ${undersoreToPascal(column.name)}[parent.${undersoreToPascal(sheetName)}Capacity] @ ${undersoreToPascal(column.name)}Offset${getColumnLayoutAttribute(column)}`);
+            }
+
+            return columnType;
 		}
 	}
 	
@@ -506,6 +561,57 @@ function buildImHexPattern(schema)
 	}
 }
 
+// align and pad_to only move column data, so show them as comment on the column
+function getColumnLayoutAttribute(column)
+{
+    const layout = [];
+
+    let align = 0;
+    if(schema.meta.hasOwnProperty('align'))
+    {
+        align = resolveExpression(vmContext, schema.meta.align)|0;
+    }
+    if(column.hasOwnProperty('align'))
+    {
+        align = resolveExpression(vmContext, column.align)|0;
+    }
+    if(align > 1)
+    {
+        layout.push(`align: ${align}`);
+    }
+    if(column.hasOwnProperty('pad_to'))
+    {
+        layout.push(`pad_to: ${resolveExpression(vmContext, column.pad_to)|0}`);
+    }
+
+    if(layout.length == 0)
+    {
+        return '';
+    }
+    return ` [[comment("${layout.join(', ')}")]]`;
+}
+
+// 0 for soa, rows per interleaved block for aos and aosoa:<width>
+function getSheetBlockRows(sheet)
+{
+    if(!sheet.hasOwnProperty('layout'))
+    {
+        return 0;
+    }
+
+    const [layoutType, layoutWidth] = `${sheet.layout}`.split(':');
+
+    if(layoutType == 'aos')
+    {
+        return 1;
+    }
+    if((layoutType == 'aosoa') && layoutWidth)
+    {
+        return Math.max(resolveExpression(vmContext, layoutWidth)|0, 0);
+    }
+    return 0;
+}
+
 function getImHexType(type)
 {
     const typeMap = {
@@ -539,6 +645,11 @@ function findSheetByName(sheets, sheetName)
     return sheet;
 }
 
+function isRingSheet(sheet)
+{
+    return sheet.hasOwnProperty('ring') && (sheet.ring == 'spsc');
+}
+
 function resolveExpression(currentContext, text)
 {
 	const code = `_result = ${text};`;
@@ -0,0 +1,160 @@
+const yaml = require('js-yaml');
+const fs   = require('fs');
+const path = require('path');
+
+const packFile   = process.argv[2];
+const outputFile = process.argv[3];
+const headerFile = process.argv[4];
+
+const kPackFileMagic     = 0x4b434150;
+const kPackFileVersion   = 1;
+const kPackFileNameSize  = 32;
+const kPackFileEntrySize = kPackFileNameSize + 16;
+const kPackFileHeaderSize = 16;
+
+const permissionsValues = {
+    read: 0,
+    read_write_copy: 1
+};
+
+const pack = yaml.load(fs.readFileSync(packFile), 'utf8');
+
+// entry files are looked up next to the pack, runtime binaries are exported there first
+const inputDirectory = path.dirname(outputFile);
+
+const packData = buildPackBinary(pack);
+
+fs.writeFileSync(outputFile, Buffer.from(packData.data), 'binary')
+
+if(headerFile)
+{
+    fs.writeFileSync(headerFile, packData.header, 'utf8')
+}
+
+function buildPackBinary(pack)
+{
+    const pageSize = pack.meta.page_size|0;
+    const entries  = pack.entries.map( entry => {
+        const data = new Uint8Array(fs.readFileSync(path.join(inputDirectory, entry.file)));
+
+        let permissions = permissionsValues.read;
+        if(entry.hasOwnProperty('permissions'))
+        {
+            if(permissionsValues.hasOwnProperty(entry.permissions))
+            {
+                permissions = permissionsValues[entry.permissions];
+            }
+            else
+            {
+                Log(`${entry.name} has unsupported permissions ${entry.permissions}, pack is mapped copy-on-write so only read and read_write_copy are allowed`);
+            }
+        }
+
+        if(entry.name.length >= kPackFileNameSize)
+        {
+            Log(`${entry.name} is longer than ${kPackFileNameSize - 1} characters and will be truncated`);
+        }
+
+        return {
+            name: entry.name,
+            data: data,
+            permissions: permissions,
+            instanceCount: entry.hasOwnProperty('instances') ? (entry.instances|0) : 1,
+            instanceStride: alignUp(data.length, pageSize),
+            offset: 0
+        };
+    });
+
+    let size = alignUp(kPackFileHeaderSize + (entries.length * kPackFileEntrySize), pageSize);
+    entries.forEach( entry => {
+        entry.offset = size;
+        size += entry.instanceStride * entry.instanceCount;
+    });
+
+    const data = new Uint8Array(size);
+    const view = new DataView(data.buffer);
+
+    view.setUint32(0, kPackFileMagic, true);
+    view.setUint16(4, kPackFileVersion, true);
+    view.setUint16(6, entries.length, true);
+    view.setUint32(8, pageSize, true);
+    view.setUint32(12, size, true);
+
+    entries.forEach( (entry, index) => {
+        const entryOffset = kPackFileHeaderSize + (index * kPackFileEntrySize);
+
+        for(let i = 0; i < Math.min(entry.name.length, kPackFileNameSize - 1); i++)
+        {
+            data[entryOffset + i] = entry.name.charCodeAt(i);
+        }
+
+        view.setUint32(entryOffset + kPackFileNameSize + 0, entry.offset, true);
+        view.setUint32(entryOffset + kPackFileNameSize + 4, entry.data.length, true);
+        view.setUint32(entryOffset + kPackFileNameSize + 8, entry.instanceStride, true);
+        view.setUint16(entryOffset + kPackFileNameSize + 12, entry.instanceCount, true);
+        view.setUint16(entryOffset + kPackFileNameSize + 14, entry.permissions, true);
+
+        for(let instanceIndex = 0; instanceIndex < entry.instanceCount; instanceIndex++)
+        {
+            data.set(entry.data, entry.offset + (instanceIndex * entry.instanceStride));
+        }
+    });
+
+    return {
+        data: data,
+        header: exportHeaderText(entries)
+    };
+
+    function exportHeaderText(entries)
+    {
+        const rootName = undersoreToPascal(pack.meta.name);
+
+        const constants = [];
+        constants.push({
+            key: `${rootName}EntryCount`,
+            value: entries.length
+        });
+        entries.forEach( (entry, index) => {
+            constants.push({
+                key: `${rootName}${undersoreToPascal(entry.name)}`,
+                value: index
+            });
+        });
+        entries.forEach( entry => {
+            constants.push({
+                key: `${rootName}${undersoreToPascal(entry.name)}InstanceCount`,
+                value: entry.instanceCount
+            });
+        });
+
+        const maxKeyLength = Math.max(...constants.map( c => c.key.length ));
+
+        let text = '#pragma once\n\n';
+        constants.forEach( c => {
+            text += `#define k${c.key.padEnd(maxKeyLength + 1)} ${c.value}\n`;
+        });
+
+        return text;
+    }
+}
+
+function alignUp(value, alignment)
+{
+    if(alignment <= 1)
+    {
+        return value;
+    }
+    return Math.ceil(value / alignment) * alignment;
+}
+
+function undersoreToPascal(text)
+{
+	const words = text.split('_');
+	const capitalizedWords = words.map( word => word.charAt(0).toUpperCase() + word.slice(1).toLowerCase() );
+	return capitalizedWords.join('');
+}
+
+function Log(text)
+{
+    console.log(`${text} | ${packFile}`)
+}
@@ -5,6 +5,8 @@ const XLSX = require('xlsx');
 
 const vmContext = {};
 
+const kRingCursorStride = 64;
+
 const schemaFile = process.argv[2];
 const outputFile = process.argv[3];
 const sheetFile  = process.argv[4];
@@ -19,6 +21,15 @@ if(schema.hasOwnProperty('constants'))
 	});
 }
 
+// a column with enabled: <expression over constants> is left out of the layout when the expression is false,
+// so a schema can switch between column variants with one constant
+if(schema.hasOwnProperty('sheets'))
+{
+    schema.sheets.forEach( sheet => {
+        sheet.columns = sheet.columns.filter( column => !column.hasOwnProperty('enabled') || resolveExpression(column.enabled) );
+    });
+}
+
 const importedSchemas = {};
 if(schema.meta.hasOwnProperty('import'))
 {
@@ -131,6 +142,14 @@ function buildRuntimeBinary(schema, sourceWorkbook)
 		while(exportDataSegments.length)
 		{
 			const dataSegment = exportDataSegments.shift();
+            if(dataSegment.hasOwnProperty('align'))
+            {
+                // zero padding so segment start is multiple of align from root
+                while(data.length % dataSegment.align)
+                {
+                    data.push(0);
+                }
+            }
 			const dataSegmentOffset = data.length;
 			exportDataSegmentOffsets[dataSegment.name] = dataSegmentOffset;
 			dataSegment.getBytes(data, exportDataSegments);
@@ -304,21 +323,62 @@ function buildRuntimeBinary(schema, sourceWorkbook)
                     sourceCapacityOffsetSegmentName = `${sourceSheetNameSegmentName}Capacity`;
                 }
             }
+            const targetSheetOffsetNames = [sourceCountOffsetSegmentName, sourceCapacityOffsetSegmentName, targetSheetNameSegmentName];
+
+            // ring cursors are shared with the source sheet, a source without ring leaves offset zero
+            if(isRingSheet(targetSheet))
+            {
+                const sourceRingSheet = sourceSheetNameSegmentName ? findSheetByName(schema.sheets || [], sourceSheetNameSegmentName) : null;
+                targetSheetOffsetNames.push(isRingSheet(sourceRingSheet) ? `${sourceSheetNameSegmentName}Ring` : "");
+            }
+
             relocationTable.push({
                 offset: data.length,
-                names: [sourceCountOffsetSegmentName, sourceCapacityOffsetSegmentName, targetSheetNameSegmentName],
+                names: targetSheetOffsetNames,
                 size: schema.meta.size,
                 relativeSegment: mapSegmentName
             });
 
             // put space in data this will be patch by relocation table
-			data.push( ...bytesAsSize([0, 0, 0], schema.meta.size) );
+			data.push( ...bytesAsSize(new Array(targetSheetOffsetNames.length).fill(0), schema.meta.size) );
 
             const targetColumns = targetSheet.columns;
 
             exportDataSegments.push( {
                 name: targetSheetNameSegmentName,
                 getBytes: (data, exportDataSegments) => {
+                    // map view uses block layout of source sheet, so all mapped columns must share it
+                    let sourceBlock = { rows: 0, stride: 0 };
+                    if(sourceSheet)
+                    {
+                        const sourceSheetNames = new Set();
+                        if(sourceSheetNameSegmentName)
+                        {
+                            sourceSheetNames.add(sourceSheetNameSegmentName);
+                        }
+                        if(sourceSheet.hasOwnProperty("columns"))
+                        {
+                            sourceSheet.columns.forEach( sourceColumn => {
+                                if(sourceColumn.hasOwnProperty("sheet"))
+                                {
+                                    sourceSheetNames.add(sourceColumn.sheet);
+                                }
+                            });
+                        }
+
+                        const sourceBlocks = [...sourceSheetNames].map( name => getSheetBlock(findSheetByName(schema.sheets || [], name)) );
+                        if(sourceBlocks.length > 0)
+                        {
+                            sourceBlock = sourceBlocks[0];
+                            if(sourceBlocks.some( block => (block.rows != sourceBlock.rows) || (block.stride != sourceBlock.stride) ))
+                            {
+                                Log(`source sheets for ${targetSheet.name} in map ${mapSegmentName} have different layout`);
+                            }
+                        }
+                    }
+
+			        data.push( ...bytesAsSize([sourceBlock.rows, sourceBlock.stride], schema.meta.size) );
+
                     targetColumns.forEach( targetColumn => {
                         if(sourceSheet)
                         {
@@ -374,6 +434,7 @@ function buildRuntimeBinary(schema, sourceWorkbook)
 			const sheetSegmentName  = sheet.name;
             const countOffsetSegmentName = `${sheetSegmentName}Count`;
             const capacityOffsetSegmentName = `${sheetSegmentName}Capacity`;
+            const ringOffsetSegmentName = `${sheetSegmentName}Ring`;
 
 			let rowCount          = 0;
 			let rowCapacity       = 0;
@@ -410,15 +471,36 @@ function buildRuntimeBinary(schema, sourceWorkbook)
 			{
 				rowCapacity = Math.max(rowCapacity, resolveExpression(sheet.capacity)|0);
 			}
+
+            rowCapacity = getSheetCapacity(rowCapacity);
+
+            const sheetBlock = getSheetBlock(sheet);
+            if(sheetBlock.rows > 1)
+            {
+                rowCapacity = alignUp(rowCapacity, sheetBlock.rows);
+            }
 			
+            const sheetOffsetNames = [countOffsetSegmentName, capacityOffsetSegmentName, sheetSegmentName];
+
+            const ring = isRingSheet(sheet);
+            if(ring)
+            {
+                sheetOffsetNames.push(ringOffsetSegmentName);
+
+                if(rowCapacity & (rowCapacity - 1))
+                {
+                    Log(`ring sheet ${sheet.name} capacity ${rowCapacity} is not power of two`);
+                }
+            }
+
             relocationTable.push({
                 offset: data.length,
-                names: [countOffsetSegmentName, capacityOffsetSegmentName, sheetSegmentName],
+                names: sheetOffsetNames,
                 size: schema.meta.size
             });
 
             // put space in data this will be patch by relocation table
-			data.push( ...bytesAsSize([0, 0, 0], schema.meta.size) );
+			data.push( ...bytesAsSize(new Array(sheetOffsetNames.length).fill(0), schema.meta.size) );
 						
             exportDataSegments.push( {
                 name: countOffsetSegmentName,
@@ -432,22 +514,77 @@ function buildRuntimeBinary(schema, sourceWorkbook)
                     data.push( ...bytesAsSize([rowCapacity], schema.meta.size));
                 }
             });   
+
+            if(ring)
+            {
+                // write and read cursors on separate cache lines, rows exported from source are already published
+                exportDataSegments.push( {
+                    name: ringOffsetSegmentName,
+                    align: kRingCursorStride,
+                    getBytes: (data, exportDataSegments) => {
+                        data.push( ...bytesAsSize([rowCount], 'uint32_t'), ...new Array(kRingCursorStride - 4).fill(0));
+                        data.push( ...bytesAsSize([0], 'uint32_t'), ...new Array(kRingCursorStride - 4).fill(0));
+                    }
+                });
+            }
             
             const columns = sheet.columns;
 				
+            const interleaved = sheetBlock.rows > 0;
+
             exportDataSegments.push( {
                 name: sheetSegmentName,
                 getBytes: (data, exportDataSegments) => { 
-                    columns.forEach( column => {
+                    data.push( ...bytesAsSize([sheetBlock.rows, sheetBlock.stride], schema.meta.size));
+
+                    const blockColumns = columns.map( column => {
                         const columnSegmentName = sheetSegmentName + ":" + column.name;
 							
-                        exportColumn(data, columnSegmentName, rowCapacity, column, sourceSheetValues, sourceSheetHeader, exportDataSegments);
+                        return exportColumn(data, columnSegmentName, rowCapacity, column, sourceSheetValues, sourceSheetHeader, interleaved, exportDataSegments);
                     });
+
+                    if(interleaved)
+                    {
+                        exportBlocks(sheetSegmentName, rowCapacity, sheetBlock, blockColumns, exportDataSegments);
+                    }
                 }
             });
 		}
 
-		function exportColumn(data, columnSegmentName, rowCapacity, column, sourceSheetValues, sourceSheetHeader, exportDataSegments)
+        function exportBlocks(sheetSegmentName, rowCapacity, sheetBlock, blockColumns, exportDataSegments)
+        {
+            const blocksSegment = {
+                name: `${sheetSegmentName}:blocks`,
+                getBytes: (data, exportDataSegments) => {
+                    // column offset points to column in first block, next block is sheetBlock.stride bytes away
+                    let columnOffset = data.length;
+                    blockColumns.forEach( blockColumn => {
+                        exportDataSegmentOffsets[blockColumn.name] = columnOffset;
+                        columnOffset += sheetBlock.rows * blockColumn.stride;
+                    });
+
+                    for(let blockStart = 0; blockStart < rowCapacity; blockStart += sheetBlock.rows)
+                    {
+                        blockColumns.forEach( blockColumn => {
+                            for(let i = blockStart; i < (blockStart + sheetBlock.rows); i++)
+                            {
+                                pushColumnRow(data, blockColumn.values, i);
+                            }
+                        });
+                    }
+                }
+            };
+
+            const blocksAlign = Math.max(...blockColumns.map( blockColumn => blockColumn.align ));
+            if(blocksAlign > 1)
+            {
+                blocksSegment.align = blocksAlign;
+            }
+
+            exportDataSegments.push(blocksSegment);
+        }
+
+		function exportColumn(data, columnSegmentName, rowCapacity, column, sourceSheetValues, sourceSheetHeader, interleaved, exportDataSegments)
 		{
             relocationTable.push({
                 offset: data.length,
@@ -459,6 +596,9 @@ function buildRuntimeBinary(schema, sourceWorkbook)
 			data.push(...bytesAsSize([0], schema.meta.size));
 			
             const sources = column.sources;
+
+            const columnRows  = interleaved ? rowCapacity : getColumnRows(column, rowCapacity);
+            const columnAlign = getColumnAlign(column);
 				
             const columnValues = [];
 				
@@ -469,7 +609,7 @@ function buildRuntimeBinary(schema, sourceWorkbook)
                     columnCount = resolveExpression(source.count)|0;
                 }
 									
-                const elementCapacity = rowCapacity * columnCount;
+                const elementCapacity = columnRows * columnCount;
 
                 let defaultValue = 0;
 
@@ -513,7 +653,7 @@ function buildRuntimeBinary(schema, sourceWorkbook)
                     count: columnCount
                 });
             });
-            exportDataSegments.push( {
+            const columnSegment = {
                 name: columnSegmentName,
                 getBytes: (data, exportDataSegments) => {
                     if (columnValues.length == 1)
@@ -522,23 +662,178 @@ function buildRuntimeBinary(schema, sourceWorkbook)
                     }
                     else
                     {							
-                        for(let i = 0; i < rowCapacity; i++)
+                        for(let i = 0; i < columnRows; i++)
                         {
-                            for(let v = 0; v < columnValues.length; v++)
-                            {
-                                const value = columnValues[v];
-                                const index = i * value.count;
-                                const slice = value.values.slice(index, index + value.count);
-                                data.push( ...bytesAsSize(slice, value.type));
-                            }
+                            pushColumnRow(data, columnValues, i);
                         }
                     }
                 }
-            });
+            };
+
+            if(columnAlign > 1)
+            {
+                columnSegment.align = columnAlign;
+            }
+
+            if(!interleaved)
+            {
+                exportDataSegments.push(columnSegment);
+            }
+
+            return {
+                name: columnSegmentName,
+                values: columnValues,
+                stride: getTypesSize(sources),
+                align: columnAlign
+            };
 		}
+
+        function pushColumnRow(data, columnValues, row)
+        {
+            for(let v = 0; v < columnValues.length; v++)
+            {
+                const value = columnValues[v];
+                const index = row * value.count;
+                const slice = value.values.slice(index, index + value.count);
+                data.push( ...bytesAsSize(slice, value.type));
+            }
+        }
 	}
 }
 
+// meta.pad_to rounds capacity of every sheet up, so loops can run whole vectors
+function getSheetCapacity(rowCapacity)
+{
+    if(schema.meta.hasOwnProperty('pad_to'))
+    {
+        return alignUp(rowCapacity, resolveExpression(schema.meta.pad_to)|0);
+    }
+    return rowCapacity;
+}
+
+// column pad_to adds storage rows past capacity, so tail vector loads stay in bounds
+function getColumnRows(column, rowCapacity)
+{
+    if(column.hasOwnProperty('pad_to'))
+    {
+        return alignUp(rowCapacity, resolveExpression(column.pad_to)|0);
+    }
+    return rowCapacity;
+}
+
+// column align overrides meta.align, offset of column data from root is multiple of it
+function getColumnAlign(column)
+{
+    let align = 0;
+    if(schema.meta.hasOwnProperty('align'))
+    {
+        align = resolveExpression(schema.meta.align)|0;
+    }
+    if(column.hasOwnProperty('align'))
+    {
+        align = resolveExpression(column.align)|0;
+    }
+    if(align & (align - 1))
+    {
+        Log(`align ${align} for column ${column.name} is not power of two`);
+    }
+    return align;
+}
+
+// soa keeps every column in own array, aos interleaves whole rows,
+// aosoa:<width> interleaves blocks of width rows with per column arrays inside block
+function getSheetBlock(sheet)
+{
+    const block = {
+        rows:   0,
+        stride: 0
+    };
+
+    if(sheet && sheet.hasOwnProperty('layout'))
+    {
+        const [layoutType, layoutWidth] = `${sheet.layout}`.split(':');
+
+        if(layoutType == 'aos')
+        {
+            block.rows = 1;
+        }
+        else if(layoutType == 'aosoa')
+        {
+            if(layoutWidth)
+            {
+                block.rows = resolveExpression(layoutWidth)|0;
+            }
+            if(block.rows < 1)
+            {
+                Log(`layout ${sheet.layout} for sheet ${sheet.name} missing block width`);
+                block.rows = 0;
+            }
+        }
+        else if(layoutType != 'soa')
+        {
+            Log(`unknown layout ${sheet.layout} for sheet ${sheet.name}`);
+        }
+
+        const rowSize = sheet.columns.reduce( (size, column) => size + getTypesSize(column.sources), 0);
+        block.stride = block.rows * rowSize;
+    }
+
+    return block;
+}
+
+// ring: spsc turns sheet into single producer single consumer ring, cursors live in own segment
+function isRingSheet(sheet)
+{
+    if(sheet && sheet.hasOwnProperty('ring'))
+    {
+        if(sheet.ring == 'spsc')
+        {
+            return true;
+        }
+        Log(`unknown ring ${sheet.ring} for sheet ${sheet.name}`);
+    }
+    return false;
+}
+
+function findSheetByName(sheets, sheetName)
+{
+    let sheet = null;
+    const sheetIndex = sheets.findIndex( s => s.name == sheetName);
+    if(sheetIndex != -1)
+    {
+        sheet = sheets[sheetIndex];
+    }
+    else
+    {
+        Log(`Unable find sheet ${sheetName} mapping`);
+    }
+
+    return sheet;
+}
+
+function getTypesSize(types)
+{
+    let size = 0;
+    types.forEach( t => {
+        let count = 1;
+        if(t.hasOwnProperty('count'))
+        {
+            count = resolveExpression(t.count)|0;
+        }
+        size += getBytesSize(t.type) * count;
+    });
+    return size;
+}
+
+function alignUp(value, alignment)
+{
+    if(alignment > 1)
+    {
+        return Math.ceil(value / alignment) * alignment;
+    }
+    return value;
+}
+
 function getBytesSize(size)
 {
     switch(size)
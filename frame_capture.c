@@ -0,0 +1,612 @@
+// Records what the render side consumed, frame by frame, into a chunked file for offline rendering and for diffing builds.
+// The render thread only copies the live frame_data prefix, viewport and game time into one of two pages,
+// a full page is handed to a writer thread that compresses and writes it as one chunk while the other page fills.
+// Records in a chunk are XORed with the record before them (objects by index), so slow moving objects turn into zero bytes,
+// then zero runs are collapsed. The first record of a chunk is stored as is, so any chunk decodes on its own.
+// A chunk table after the last chunk gives first frame and file offset of every chunk, readers seek straight to a frame.
+//
+// file: FrameCaptureFileHeader, chunks (FrameCaptureChunkHeader + encoded bytes), FrameCaptureChunkEntry table, FrameCaptureFooter
+
+#ifndef __cplusplus
+typedef struct FrameCaptureFileHeader  FrameCaptureFileHeader;
+typedef struct FrameCaptureFrame       FrameCaptureFrame;
+typedef struct FrameCaptureChunkHeader FrameCaptureChunkHeader;
+typedef struct FrameCaptureChunkEntry  FrameCaptureChunkEntry;
+typedef struct FrameCaptureFooter      FrameCaptureFooter;
+typedef struct FrameCapturePage        FrameCapturePage;
+typedef struct FrameCapture            FrameCapture;
+typedef struct FrameCaptureReader      FrameCaptureReader;
+#endif
+
+#define kFrameCaptureMagic              0x50434446 // FDCP
+#define kFrameCaptureChunkMagic         0x4b4e4843 // CHNK
+#define kFrameCaptureVersion            1
+#define kFrameCaptureChunkMaxFrameCount 64
+#define kFrameCapturePageSize           (256 * 1024)
+// zero run encoding adds at most one control byte per 128 literal bytes
+#define kFrameCaptureEncodedPageSize    (kFrameCapturePageSize + (kFrameCapturePageSize / 128) + 1)
+#define kFrameCaptureDecodeFailed       0xffffffff
+// keeps frame_capture_reader_memory_size within 32 bits
+#define kFrameCaptureReaderMaxChunkCount ((0xffffffffu - kFrameCapturePageSize - kFrameCaptureEncodedPageSize) / sizeof(FrameCaptureChunkEntry))
+
+struct FrameCaptureFileHeader
+{
+    u32 Magic;
+    u32 Version;
+    u32 ObjectFormat;
+    u32 ObjectSize;
+};
+
+// one record: this header followed by ObjectCount objects
+struct FrameCaptureFrame
+{
+    u64 FrameCounter;
+    f64 Time;
+    s32 ScreenWidth;
+    s32 ScreenHeight;
+    f32 Viewport[4];
+    u16 FrameDataCount;
+    u16 ObjectCount;
+    u32 Padding;
+};
+
+struct FrameCaptureChunkHeader
+{
+    u32 Magic;
+    u32 FirstFrameIndex;
+    u32 FrameCount;
+    u32 RawByteCount;
+    u32 EncodedByteCount;
+    u32 RecordOffsets[kFrameCaptureChunkMaxFrameCount];
+};
+
+struct FrameCaptureChunkEntry
+{
+    u64 FileOffset;
+    u32 FirstFrameIndex;
+    u32 FrameCount;
+};
+
+struct FrameCaptureFooter
+{
+    u64 ChunkTableOffset;
+    u32 ChunkCount;
+    u32 FrameCount;
+    u32 Magic;
+    u32 Padding;
+};
+
+struct FrameCapturePage
+{
+    u8 *Raw;
+    FrameCaptureChunkHeader Chunk;
+};
+
+struct FrameCapture
+{
+    FILE *File;
+
+    PlatformMutex Mutex;
+    // signaled when a page is submitted, written or the writer quits
+    PlatformCondition Changed;
+
+    FrameCapturePage Pages[2];
+    u32 ActivePageIndex;
+    // page waiting for the writer, 0 when the writer is idle
+    FrameCapturePage *PendingPage;
+
+    // writer thread only
+    u8 *Delta;
+    u8 *Encoded;
+    u64 FileOffset;
+    u64 EncodedTotal;
+    u64 RawTotal;
+
+    u32 FrameCount;
+    u32 MaxFrameCount;
+    u32 DroppedFrameCount;
+    // times the render thread waited for the writer to finish the other page
+    u32 StallCount;
+    u64 RecordTicks;
+
+    u32 ChunkCount;
+    FrameCaptureChunkEntry *ChunkTable;
+
+    b32 Quit;
+    PlatformThread Thread;
+};
+
+struct FrameCaptureReader
+{
+    FILE *File;
+    FrameCaptureFooter Footer;
+
+    FrameCaptureChunkEntry *ChunkTable;
+    u8 *Raw;
+    u8 *Encoded;
+
+    u32 LoadedChunkIndex;
+    FrameCaptureChunkHeader LoadedChunk;
+};
+
+// every chunk holds at least one frame, the chunk table is sized for the worst case
+static u32
+frame_capture_memory_size(u32 max_frame_count)
+{
+    return (2 * kFrameCapturePageSize) + kFrameCapturePageSize + kFrameCaptureEncodedPageSize + (max_frame_count * sizeof(FrameCaptureChunkEntry));
+}
+
+static u32
+frame_capture_record_size(FrameCaptureFrame *frame)
+{
+    return sizeof(FrameCaptureFrame) + (frame->ObjectCount * sizeof(FrameDataObject));
+}
+
+static u32
+frame_capture_shared_size(FrameCaptureFrame *frame, FrameCaptureFrame *previous_frame)
+{
+    return sizeof(FrameCaptureFrame) + (min(frame->ObjectCount, previous_frame->ObjectCount) * sizeof(FrameDataObject));
+}
+
+// XOR of a record with the one before it, objects past the previous count are kept as is
+static void
+frame_capture_delta(u8 *delta, u8 *record, u8 *previous_record)
+{
+    u32 record_size = frame_capture_record_size((FrameCaptureFrame *)record);
+    u32 shared_size = previous_record ? frame_capture_shared_size((FrameCaptureFrame *)record, (FrameCaptureFrame *)previous_record) : 0;
+
+    for (u32 byte_index = 0; byte_index < record_size; byte_index++)
+    {
+        delta[byte_index] = (byte_index < shared_size) ? (record[byte_index] ^ previous_record[byte_index]) : record[byte_index];
+    }
+}
+
+// in place inverse of frame_capture_delta, the header comes back first so the object count is known
+// record_capacity bytes follow record, a restored record that does not fit them fails before any object is touched
+static b32
+frame_capture_undelta(u8 *record, u8 *previous_record, u32 record_capacity)
+{
+    if (record_capacity < sizeof(FrameCaptureFrame))
+    {
+        return 0;
+    }
+
+    for (u32 byte_index = 0; previous_record && (byte_index < sizeof(FrameCaptureFrame)); byte_index++)
+    {
+        record[byte_index] ^= previous_record[byte_index];
+    }
+
+    FrameCaptureFrame *frame = (FrameCaptureFrame *)record;
+    if ((frame->ObjectCount > kFrameDataMaxObjectDataCapacity) || (frame_capture_record_size(frame) > record_capacity))
+    {
+        return 0;
+    }
+
+    u32 shared_size = previous_record ? frame_capture_shared_size(frame, (FrameCaptureFrame *)previous_record) : 0;
+    for (u32 byte_index = sizeof(FrameCaptureFrame); byte_index < shared_size; byte_index++)
+    {
+        record[byte_index] ^= previous_record[byte_index];
+    }
+
+    return 1;
+}
+
+// control byte below 0x80 is followed by control + 1 literal bytes, from 0x80 up it stands for control - 0x7f zero bytes
+static u32
+frame_capture_encode(u8 *encoded, u8 *raw, u32 raw_byte_count)
+{
+    u32 encoded_byte_count = 0;
+    u32 byte_index         = 0;
+
+    while (byte_index < raw_byte_count)
+    {
+        u32 run_count = 0;
+        while (((byte_index + run_count) < raw_byte_count) && (raw[byte_index + run_count] == 0) && (run_count < 128))
+        {
+            run_count++;
+        }
+
+        if (run_count >= 2)
+        {
+            encoded[encoded_byte_count++] = (u8)(0x7f + run_count);
+            byte_index += run_count;
+            continue;
+        }
+
+        // literals run until the next pair of zeros
+        u32 literal_count = 0;
+        while (((byte_index + literal_count) < raw_byte_count) && (literal_count < 128))
+        {
+            u32 next_index = byte_index + literal_count;
+            if ((raw[next_index] == 0) && ((next_index + 1) < raw_byte_count) && (raw[next_index + 1] == 0))
+            {
+                break;
+            }
+            literal_count++;
+        }
+
+        encoded[encoded_byte_count++] = (u8)(literal_count - 1);
+        memcpy(encoded + encoded_byte_count, raw + byte_index, literal_count);
+        encoded_byte_count += literal_count;
+        byte_index         += literal_count;
+    }
+
+    return encoded_byte_count;
+}
+
+// returns kFrameCaptureDecodeFailed when a literal run reads past the encoded bytes or the output grows past raw_capacity
+static u32
+frame_capture_decode(u8 *raw, u32 raw_capacity, u8 *encoded, u32 encoded_byte_count)
+{
+    u32 raw_byte_count = 0;
+    u32 byte_index     = 0;
+
+    while (byte_index < encoded_byte_count)
+    {
+        u8 control = encoded[byte_index++];
+        u32 run_count = (control < 0x80) ? (control + 1) : (control - 0x7f);
+
+        if (((raw_capacity - raw_byte_count) < run_count) || ((control < 0x80) && ((encoded_byte_count - byte_index) < run_count)))
+        {
+            return kFrameCaptureDecodeFailed;
+        }
+
+        if (control < 0x80)
+        {
+            memcpy(raw + raw_byte_count, encoded + byte_index, control + 1);
+            raw_byte_count += control + 1;
+            byte_index     += control + 1;
+        }
+        else
+        {
+            memset(raw + raw_byte_count, 0, control - 0x7f);
+            raw_byte_count += control - 0x7f;
+        }
+    }
+
+    return raw_byte_count;
+}
+
+static void
+frame_capture_write_page(FrameCapture *capture, FrameCapturePage *page)
+{
+    FrameCaptureChunkHeader *chunk = &page->Chunk;
+
+    for (u32 frame_index = 0; frame_index < chunk->FrameCount; frame_index++)
+    {
+        u32 record_offset   = chunk->RecordOffsets[frame_index];
+        u8 *previous_record = (frame_index > 0) ? (page->Raw + chunk->RecordOffsets[frame_index - 1]) : NULL;
+
+        frame_capture_delta(capture->Delta + record_offset, page->Raw + record_offset, previous_record);
+    }
+
+    chunk->Magic            = kFrameCaptureChunkMagic;
+    chunk->EncodedByteCount = frame_capture_encode(capture->Encoded, capture->Delta, chunk->RawByteCount);
+
+    FrameCaptureChunkEntry *entry = &capture->ChunkTable[capture->ChunkCount++];
+    entry->FileOffset      = capture->FileOffset;
+    entry->FirstFrameIndex = chunk->FirstFrameIndex;
+    entry->FrameCount      = chunk->FrameCount;
+
+    fwrite(chunk, sizeof(FrameCaptureChunkHeader), 1, capture->File);
+    fwrite(capture->Encoded, chunk->EncodedByteCount, 1, capture->File);
+
+    capture->FileOffset   += sizeof(FrameCaptureChunkHeader) + chunk->EncodedByteCount;
+    capture->EncodedTotal += sizeof(FrameCaptureChunkHeader) + chunk->EncodedByteCount;
+    capture->RawTotal     += chunk->RawByteCount;
+}
+
+static void
+frame_capture_thread(void *parameter)
+{
+    FrameCapture *capture = (FrameCapture *)parameter;
+
+    platform_mutex_lock(&capture->Mutex);
+
+    for (;;)
+    {
+        while (!capture->Quit && (capture->PendingPage == NULL))
+        {
+            platform_condition_wait(&capture->Changed, &capture->Mutex);
+        }
+
+        if (capture->PendingPage == NULL)
+        {
+            break;
+        }
+
+        FrameCapturePage *page = capture->PendingPage;
+
+        platform_mutex_unlock(&capture->Mutex);
+        frame_capture_write_page(capture, page);
+        platform_mutex_lock(&capture->Mutex);
+
+        capture->PendingPage = NULL;
+        platform_condition_broadcast(&capture->Changed);
+    }
+
+    platform_mutex_unlock(&capture->Mutex);
+}
+
+// memory holds frame_capture_memory_size(max_frame_count) bytes, frames past max_frame_count are counted and dropped
+static b32
+frame_capture_open(FrameCapture *capture, const char *file_name, u32 max_frame_count, void *memory)
+{
+    memset(capture, 0, sizeof(FrameCapture));
+
+    capture->File = fopen(file_name, "wb");
+    if (capture->File == NULL)
+    {
+        return 0;
+    }
+
+    u8 *memory_bytes = (u8 *)memory;
+    capture->Pages[0].Raw = memory_bytes;
+    capture->Pages[1].Raw = memory_bytes + kFrameCapturePageSize;
+    capture->Delta        = memory_bytes + (2 * kFrameCapturePageSize);
+    capture->Encoded      = memory_bytes + (3 * kFrameCapturePageSize);
+    capture->ChunkTable   = (FrameCaptureChunkEntry *)(memory_bytes + (3 * kFrameCapturePageSize) + kFrameCaptureEncodedPageSize);
+    capture->MaxFrameCount = max_frame_count;
+
+    FrameCaptureFileHeader header = { 0 };
+    header.Magic        = kFrameCaptureMagic;
+    header.Version      = kFrameCaptureVersion;
+    header.ObjectFormat = kFrameDataObjectFormat;
+    header.ObjectSize   = sizeof(FrameDataObject);
+
+    fwrite(&header, sizeof(FrameCaptureFileHeader), 1, capture->File);
+    capture->FileOffset = sizeof(FrameCaptureFileHeader);
+
+    platform_mutex_init(&capture->Mutex);
+    platform_condition_init(&capture->Changed);
+    platform_thread_create(&capture->Thread, frame_capture_thread, capture);
+
+    return 1;
+}
+
+static void
+frame_capture_submit(FrameCapture *capture)
+{
+    FrameCapturePage *page = &capture->Pages[capture->ActivePageIndex];
+    if (page->Chunk.FrameCount == 0)
+    {
+        return;
+    }
+
+    platform_mutex_lock(&capture->Mutex);
+    if (capture->PendingPage)
+    {
+        capture->StallCount++;
+        while (capture->PendingPage)
+        {
+            platform_condition_wait(&capture->Changed, &capture->Mutex);
+        }
+    }
+    capture->PendingPage = page;
+    platform_condition_broadcast(&capture->Changed);
+    platform_mutex_unlock(&capture->Mutex);
+
+    capture->ActivePageIndex ^= 1;
+
+    FrameCapturePage *next_page = &capture->Pages[capture->ActivePageIndex];
+    next_page->Chunk.FirstFrameIndex = capture->FrameCount;
+    next_page->Chunk.FrameCount      = 0;
+    next_page->Chunk.RawByteCount    = 0;
+}
+
+// render side, between frame_pipeline_acquire and frame_pipeline_release
+static void
+frame_capture_record(FrameCapture *capture, FrameData *frame_data)
+{
+    u64 start_ticks = platform_ticks();
+
+    if (capture->FrameCount >= capture->MaxFrameCount)
+    {
+        capture->DroppedFrameCount++;
+        return;
+    }
+
+    FrameDataObjectStream object_stream = frame_data_object_stream(frame_data);
+    u32 record_size = sizeof(FrameCaptureFrame) + object_stream.ByteCount;
+    Assert(record_size <= kFrameCapturePageSize);
+
+    FrameCapturePage *page = &capture->Pages[capture->ActivePageIndex];
+    if ((page->Chunk.FrameCount == kFrameCaptureChunkMaxFrameCount) || ((page->Chunk.RawByteCount + record_size) > kFrameCapturePageSize))
+    {
+        frame_capture_submit(capture);
+        page = &capture->Pages[capture->ActivePageIndex];
+    }
+
+    u32 record_offset = page->Chunk.RawByteCount;
+    FrameCaptureFrame *frame = (FrameCaptureFrame *)(page->Raw + record_offset);
+
+    FrameDataGameTime *game_time_prt     = FrameDataGameTimePrt(frame_data);
+    FrameDataScreenSize *screen_size_prt = FrameDataScreenSizePrt(frame_data);
+    FrameDataViewport *viewport_prt      = FrameDataViewportPrt(frame_data);
+
+    frame->FrameCounter   = game_time_prt->FrameCounter;
+    frame->Time           = game_time_prt->Time;
+    frame->ScreenWidth    = screen_size_prt->Width;
+    frame->ScreenHeight   = screen_size_prt->Height;
+    frame->Viewport[0]    = viewport_prt->X;
+    frame->Viewport[1]    = viewport_prt->Y;
+    frame->Viewport[2]    = viewport_prt->Width;
+    frame->Viewport[3]    = viewport_prt->Height;
+    frame->FrameDataCount = *FrameDataFrameDataCountPrt(frame_data);
+    frame->ObjectCount    = (u16)object_stream.ObjectCount;
+    frame->Padding        = 0;
+
+    memcpy(frame + 1, object_stream.Objects, object_stream.ByteCount);
+
+    page->Chunk.RecordOffsets[page->Chunk.FrameCount++] = record_offset;
+    page->Chunk.RawByteCount += record_size;
+    capture->FrameCount++;
+
+    capture->RecordTicks += platform_ticks() - start_ticks;
+}
+
+static void
+frame_capture_close(FrameCapture *capture)
+{
+    frame_capture_submit(capture);
+
+    platform_mutex_lock(&capture->Mutex);
+    capture->Quit = 1;
+    platform_condition_broadcast(&capture->Changed);
+    platform_mutex_unlock(&capture->Mutex);
+
+    platform_thread_join(&capture->Thread);
+
+    FrameCaptureFooter footer = { 0 };
+    footer.ChunkTableOffset = capture->FileOffset;
+    footer.ChunkCount       = capture->ChunkCount;
+    footer.FrameCount       = capture->FrameCount;
+    footer.Magic            = kFrameCaptureMagic;
+
+    fwrite(capture->ChunkTable, sizeof(FrameCaptureChunkEntry), capture->ChunkCount, capture->File);
+    fwrite(&footer, sizeof(FrameCaptureFooter), 1, capture->File);
+    fclose(capture->File);
+}
+
+// reads header and footer, captures written with another object format are rejected,
+// as are footers whose chunk table does not end right before the footer
+static b32
+frame_capture_reader_open(FrameCaptureReader *reader, const char *file_name)
+{
+    memset(reader, 0, sizeof(FrameCaptureReader));
+
+    reader->File = fopen(file_name, "rb");
+    if (reader->File == NULL)
+    {
+        return 0;
+    }
+
+    FrameCaptureFileHeader header;
+    b32 valid = (fread(&header, sizeof(FrameCaptureFileHeader), 1, reader->File) == 1) &&
+                (header.Magic == kFrameCaptureMagic) && (header.Version == kFrameCaptureVersion) &&
+                (header.ObjectFormat == kFrameDataObjectFormat) && (header.ObjectSize == sizeof(FrameDataObject));
+
+    valid = valid && (platform_file_seek(reader->File, -(s64)sizeof(FrameCaptureFooter), SEEK_END) == 0) &&
+            (fread(&reader->Footer, sizeof(FrameCaptureFooter), 1, reader->File) == 1) && (reader->Footer.Magic == kFrameCaptureMagic);
+
+    // every chunk holds at least one frame
+    FrameCaptureFooter *footer = &reader->Footer;
+    valid = valid && (footer->ChunkCount <= footer->FrameCount) && (footer->ChunkCount <= kFrameCaptureReaderMaxChunkCount) &&
+            (footer->ChunkTableOffset >= sizeof(FrameCaptureFileHeader)) &&
+            ((u64)platform_file_tell(reader->File) == (footer->ChunkTableOffset + (footer->ChunkCount * sizeof(FrameCaptureChunkEntry)) + sizeof(FrameCaptureFooter)));
+
+    if (!valid)
+    {
+        fclose(reader->File);
+        reader->File = NULL;
+    }
+    return valid;
+}
+
+static u32
+frame_capture_reader_memory_size(FrameCaptureReader *reader)
+{
+    return (reader->Footer.ChunkCount * sizeof(FrameCaptureChunkEntry)) + kFrameCapturePageSize + kFrameCaptureEncodedPageSize;
+}
+
+// memory holds frame_capture_reader_memory_size bytes, fails when the chunk table can not be read
+// or its chunks do not cover frames [0, frame_count) in order, one to kFrameCaptureChunkMaxFrameCount frames each
+static b32
+frame_capture_reader_init(FrameCaptureReader *reader, void *memory)
+{
+    u8 *memory_bytes   = (u8 *)memory;
+    reader->ChunkTable = (FrameCaptureChunkEntry *)memory_bytes;
+    reader->Raw        = memory_bytes + (reader->Footer.ChunkCount * sizeof(FrameCaptureChunkEntry));
+    reader->Encoded    = reader->Raw + kFrameCapturePageSize;
+
+    reader->LoadedChunkIndex = 0xffffffff;
+
+    b32 valid = (platform_file_seek(reader->File, reader->Footer.ChunkTableOffset, SEEK_SET) == 0) &&
+                (fread(reader->ChunkTable, sizeof(FrameCaptureChunkEntry), reader->Footer.ChunkCount, reader->File) == reader->Footer.ChunkCount);
+
+    u32 frame_count = 0;
+    for (u32 chunk_index = 0; valid && (chunk_index < reader->Footer.ChunkCount); chunk_index++)
+    {
+        FrameCaptureChunkEntry *entry = &reader->ChunkTable[chunk_index];
+
+        valid = (entry->FirstFrameIndex == frame_count) &&
+                (entry->FrameCount > 0) && (entry->FrameCount <= kFrameCaptureChunkMaxFrameCount) &&
+                (entry->FileOffset >= sizeof(FrameCaptureFileHeader)) &&
+                ((entry->FileOffset + sizeof(FrameCaptureChunkHeader)) <= reader->Footer.ChunkTableOffset);
+
+        frame_count += entry->FrameCount;
+    }
+
+    return valid && (frame_count == reader->Footer.FrameCount);
+}
+
+// record of frame_index, objects follow the returned header, valid until the next call
+// NULL when the chunk holding it is truncated or corrupt
+static FrameCaptureFrame *
+frame_capture_reader_frame(FrameCaptureReader *reader, u32 frame_index)
+{
+    if (frame_index >= reader->Footer.FrameCount)
+    {
+        return NULL;
+    }
+
+    // last chunk starting at or before frame_index
+    u32 chunk_begin = 0;
+    u32 chunk_end   = reader->Footer.ChunkCount;
+    while ((chunk_end - chunk_begin) > 1)
+    {
+        u32 chunk_middle = (chunk_begin + chunk_end) / 2;
+        if (reader->ChunkTable[chunk_middle].FirstFrameIndex <= frame_index)
+        {
+            chunk_begin = chunk_middle;
+        }
+        else
+        {
+            chunk_end = chunk_middle;
+        }
+    }
+
+    FrameCaptureChunkHeader *chunk = &reader->LoadedChunk;
+
+    if (reader->LoadedChunkIndex != chunk_begin)
+    {
+        FrameCaptureChunkEntry *entry = &reader->ChunkTable[chunk_begin];
+        reader->LoadedChunkIndex      = 0xffffffff;
+
+        b32 valid = (platform_file_seek(reader->File, entry->FileOffset, SEEK_SET) == 0) &&
+                    (fread(chunk, sizeof(FrameCaptureChunkHeader), 1, reader->File) == 1) &&
+                    (chunk->Magic == kFrameCaptureChunkMagic) &&
+                    (chunk->FirstFrameIndex == entry->FirstFrameIndex) && (chunk->FrameCount == entry->FrameCount) &&
+                    (chunk->RawByteCount <= kFrameCapturePageSize) && (chunk->EncodedByteCount <= kFrameCaptureEncodedPageSize) &&
+                    (fread(reader->Encoded, 1, chunk->EncodedByteCount, reader->File) == chunk->EncodedByteCount) &&
+                    (frame_capture_decode(reader->Raw, kFrameCapturePageSize, reader->Encoded, chunk->EncodedByteCount) == chunk->RawByteCount);
+
+        // records follow each other 8 byte aligned inside the raw bytes, each one is checked before the next reads it as previous record
+        u32 record_end = 0;
+        for (u32 record_index = 0; valid && (record_index < chunk->FrameCount); record_index++)
+        {
+            u32 record_offset   = chunk->RecordOffsets[record_index];
+            u8 *previous_record = (record_index > 0) ? (reader->Raw + chunk->RecordOffsets[record_index - 1]) : NULL;
+
+            valid = (record_offset >= record_end) && (record_offset <= chunk->RawByteCount) && ((record_offset % sizeof(u64)) == 0) &&
+                    frame_capture_undelta(reader->Raw + record_offset, previous_record, chunk->RawByteCount - record_offset);
+
+            record_end = valid ? (record_offset + frame_capture_record_size((FrameCaptureFrame *)(reader->Raw + record_offset))) : 0;
+        }
+
+        if (!valid)
+        {
+            return NULL;
+        }
+
+        reader->LoadedChunkIndex = chunk_begin;
+    }
+
+    return (FrameCaptureFrame *)(reader->Raw + chunk->RecordOffsets[frame_index - chunk->FirstFrameIndex]);
+}
+
+static void
+frame_capture_reader_close(FrameCaptureReader *reader)
+{
+    fclose(reader->File);
+}
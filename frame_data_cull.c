@@ -0,0 +1,142 @@
+// Play area culling shared by the draw producers.
+// A producer pushes candidate circles into a batch, every kFrameDataCullBatchCount candidates are tested against the play area grown by cull_margin
+// (radiance reaches a bit past an object, an emitter just outside still lights the edge) and only the visible ones stay staged.
+// Flush reserves one contiguous range for everything the producer staged, so a producer still owns a single range (frame_data_reserve.c).
+// The test runs over plain float arrays with no branches so the compiler vectorizes it, culled and emitted are counted per frame.
+
+#define kFrameDataCullBatchCount 64
+
+// visible objects past capacity could never fit in frame_data, they are only counted and go to overflow_count at flush
+#define kFrameDataCullStageCapacity (kFrameDataMaxObjectDataCapacity + kFrameDataCullBatchCount)
+
+#ifndef __cplusplus
+typedef struct FrameDataCullBatch FrameDataCullBatch;
+#endif
+
+struct FrameDataCullBatch
+{
+    FrameData *FrameDataBin;
+
+    // [0, VisibleCount) passed the test, [VisibleCount, Count) are candidates waiting for it
+    u32 VisibleCount;
+    u32 Count;
+    u32 UnstagedCount;
+
+    f32 X[kFrameDataCullStageCapacity];
+    f32 Y[kFrameDataCullStageCapacity];
+    f32 Radius[kFrameDataCullStageCapacity];
+    u32 MaterialIndex[kFrameDataCullStageCapacity];
+};
+
+static void
+frame_data_cull_begin(FrameDataCullBatch *batch, FrameData *frame_data)
+{
+    batch->FrameDataBin  = frame_data;
+    batch->VisibleCount  = 0;
+    batch->Count         = 0;
+    batch->UnstagedCount = 0;
+}
+
+static void
+frame_data_cull_test(FrameDataCullBatch *batch)
+{
+    FrameData *frame_data = batch->FrameDataBin;
+    u32 candidate_begin   = batch->VisibleCount;
+    u32 candidate_count   = batch->Count - candidate_begin;
+
+    if (candidate_count == 0)
+    {
+        return;
+    }
+
+    f32 cull_margin      = *FrameDataCullMarginPrt(frame_data);
+    f32 cull_half_width  = kPlayAreaHalfWidth + cull_margin;
+    f32 cull_half_height = kPlayAreaHalfHeight + cull_margin;
+
+    f32 *x      = batch->X + candidate_begin;
+    f32 *y      = batch->Y + candidate_begin;
+    f32 *radius = batch->Radius + candidate_begin;
+
+    u8 visible[kFrameDataCullBatchCount];
+    u32 visible_count = 0;
+    for (u32 candidate_index = 0; candidate_index < candidate_count; candidate_index++)
+    {
+        visible[candidate_index] = ((fabsf(x[candidate_index]) - radius[candidate_index]) <= cull_half_width) &
+                                   ((fabsf(y[candidate_index]) - radius[candidate_index]) <= cull_half_height);
+        visible_count += visible[candidate_index];
+    }
+
+    FrameDataCullCounts *cull_counts_prt = FrameDataCullCountsPrt(frame_data);
+    platform_atomic_fetch_add_u16(&cull_counts_prt->CulledCount, (u16)(candidate_count - visible_count));
+    platform_atomic_fetch_add_u16(&cull_counts_prt->EmittedCount, (u16)visible_count);
+
+    // compaction writes at or below the candidate it reads, so it can run in place
+    u32 staged_index = candidate_begin;
+    for (u32 candidate_index = 0; candidate_index < candidate_count; candidate_index++)
+    {
+        if (visible[candidate_index] == 0)
+        {
+            continue;
+        }
+
+        if (staged_index == kFrameDataMaxObjectDataCapacity)
+        {
+            batch->UnstagedCount++;
+            continue;
+        }
+
+        u32 read_index = candidate_begin + candidate_index;
+        batch->X[staged_index]             = batch->X[read_index];
+        batch->Y[staged_index]             = batch->Y[read_index];
+        batch->Radius[staged_index]        = batch->Radius[read_index];
+        batch->MaterialIndex[staged_index] = batch->MaterialIndex[read_index];
+        staged_index++;
+    }
+
+    batch->VisibleCount = staged_index;
+    batch->Count        = staged_index;
+}
+
+static void
+frame_data_cull_flush(FrameDataCullBatch *batch)
+{
+    frame_data_cull_test(batch);
+
+    FrameData *frame_data = batch->FrameDataBin;
+
+    if ((batch->VisibleCount + batch->UnstagedCount) == 0)
+    {
+        return;
+    }
+
+    FrameDataFrameData *frame_data_sheet = FrameDataFrameDataPrt(frame_data);
+    FrameDataObject *object_data_column  = FrameDataObjectColumnPrt(frame_data, frame_data_sheet);
+
+    u32 reserved_count;
+    u32 object_index = frame_data_reserve(frame_data, batch->VisibleCount + batch->UnstagedCount, &reserved_count);
+    u32 write_count  = min(reserved_count, batch->VisibleCount);
+
+    for (u32 staged_index = 0; staged_index < write_count; staged_index++)
+    {
+        frame_data_object_encode(object_data_column + object_index + staged_index, batch->X[staged_index], batch->Y[staged_index],
+                                 batch->Radius[staged_index], batch->MaterialIndex[staged_index]);
+    }
+
+    frame_data_cull_begin(batch, frame_data);
+}
+
+static void
+frame_data_cull_push(FrameDataCullBatch *batch, v2 position, f32 radius, u32 material_index)
+{
+    u32 candidate_index = batch->Count++;
+
+    batch->X[candidate_index]             = position.x;
+    batch->Y[candidate_index]             = position.y;
+    batch->Radius[candidate_index]        = radius;
+    batch->MaterialIndex[candidate_index] = material_index;
+
+    if ((batch->Count - batch->VisibleCount) == kFrameDataCullBatchCount)
+    {
+        frame_data_cull_test(batch);
+    }
+}
@@ -0,0 +1,95 @@
+// Draw producers reserve a contiguous object range sized from their visible count (frame_data_cull.c), then fill it without touching the count again.
+// Reservation is one atomic fetch-add on the frame_data count, so producers may run on any thread without write conflicts,
+// objects that do not fit in capacity are not written and are counted in overflow_count instead of wrapping over earlier ones.
+// The count can end up above capacity, consumers read min(count, capacity) objects.
+
+static u32
+frame_data_reserve(FrameData *frame_data, u32 object_count, u32 *reserved_count)
+{
+    u16 *frame_data_count_prt = FrameDataFrameDataCountPrt(frame_data);
+    u16 frame_data_capacity   = *FrameDataFrameDataCapacityPrt(frame_data);
+
+    u32 first_object_index = platform_atomic_fetch_add_u16(frame_data_count_prt, (u16)object_count);
+    u32 fit_count          = (first_object_index < frame_data_capacity) ? min(object_count, frame_data_capacity - first_object_index) : 0;
+
+    if (fit_count < object_count)
+    {
+        platform_atomic_fetch_add_u16(FrameDataOverflowCountPrt(frame_data), (u16)(object_count - fit_count));
+    }
+
+    *reserved_count = fit_count;
+    return first_object_index;
+}
+
+// object_format in frame_data.schema.yml picks the object column: float position and scale with a u32 material (16 bytes),
+// or packed fixed point position, radius and u16 material (8 bytes). Producers encode and consumers decode through these,
+// positions are clamped to what an int16_t holds at packed_position_scale.
+#if kFrameDataObjectFormat == kFrameDataObjectFormatPacked
+typedef FrameDataFrameDataPackedObjectData FrameDataObject;
+#define FrameDataObjectColumnPrt FrameDataFrameDataPackedObjectDataPrt
+#else
+typedef FrameDataFrameDataObjectData FrameDataObject;
+#define FrameDataObjectColumnPrt FrameDataFrameDataObjectDataPrt
+#endif
+
+static void
+frame_data_object_encode(FrameDataObject *object, f32 x, f32 y, f32 radius, u32 material_index)
+{
+    #if kFrameDataObjectFormat == kFrameDataObjectFormatPacked
+    f32 position_limit = 32767.0f / kFrameDataPackedPositionScale;
+    f32 radius_limit   = 65535.0f / kFrameDataPackedRadiusScale;
+
+    object->Position[0]   = (s16)floorf((clamp(-position_limit, x, position_limit) * kFrameDataPackedPositionScale) + 0.5f);
+    object->Position[1]   = (s16)floorf((clamp(-position_limit, y, position_limit) * kFrameDataPackedPositionScale) + 0.5f);
+    object->Radius        = (u16)floorf((clamp(0.0f, radius, radius_limit) * kFrameDataPackedRadiusScale) + 0.5f);
+    object->MaterialIndex = (u16)material_index;
+    #else
+    object->PositionAndScale[0] = x;
+    object->PositionAndScale[1] = y;
+    object->PositionAndScale[2] = radius;
+    object->MaterialIndex       = material_index;
+    #endif
+}
+
+static void
+frame_data_object_decode(FrameDataObject *object, f32 *x, f32 *y, f32 *radius, u32 *material_index)
+{
+    #if kFrameDataObjectFormat == kFrameDataObjectFormatPacked
+    *x              = (f32)object->Position[0] / kFrameDataPackedPositionScale;
+    *y              = (f32)object->Position[1] / kFrameDataPackedPositionScale;
+    *radius         = (f32)object->Radius / kFrameDataPackedRadiusScale;
+    *material_index = object->MaterialIndex;
+    #else
+    *x              = object->PositionAndScale[0];
+    *y              = object->PositionAndScale[1];
+    *radius         = object->PositionAndScale[2];
+    *material_index = object->MaterialIndex;
+    #endif
+}
+
+#ifndef __cplusplus
+typedef struct FrameDataObjectStream FrameDataObjectStream;
+#endif
+
+// Packed live prefix of the frame objects, consumers copy or upload only these bytes instead of the whole capacity.
+struct FrameDataObjectStream
+{
+    u32 ObjectCount;
+    u32 ByteCount;
+    FrameDataObject *Objects;
+};
+
+static FrameDataObjectStream
+frame_data_object_stream(FrameData *frame_data)
+{
+    FrameDataFrameData *frame_data_sheet = FrameDataFrameDataPrt(frame_data);
+
+    u32 frame_object_count    = *FrameDataFrameDataCountPrt(frame_data);
+    u32 frame_object_capacity = *FrameDataFrameDataCapacityPrt(frame_data);
+
+    FrameDataObjectStream stream;
+    stream.ObjectCount = min(frame_object_count, frame_object_capacity);
+    stream.ByteCount   = stream.ObjectCount * sizeof(FrameDataObject);
+    stream.Objects     = FrameDataObjectColumnPrt(frame_data, frame_data_sheet);
+    return stream;
+}
@@ -0,0 +1,245 @@
+// Systems registered in frame order together with the blobs they read and write.
+// A system depends on every earlier system it conflicts with (write/read, read/write, write/write),
+// so running independent systems in parallel gives the same result as calling them in registration order.
+// Partitioned systems run begin, then every partition as a parallel for, then merge, before dependents start.
+
+#ifndef __cplusplus
+typedef struct FrameGraph    FrameGraph;
+typedef struct FrameGraphJob FrameGraphJob;
+#endif
+
+#define kFrameGraphMaxJobs 64
+
+typedef void FrameGraphSystem(void *context);
+typedef void FrameGraphPartitionSystem(void *context, u32 partition_index);
+
+struct FrameGraphJob
+{
+    const char *Name;
+    FrameGraphSystem *System;
+    void *Context;
+    FrameGraph *Graph;
+
+    // one bit per pack instance
+    u64 Reads;
+    u64 Writes;
+
+    // one bit per later job
+    u64 Dependents;
+    s32 DependencyCount;
+    volatile s32 PendingCount;
+
+    FrameGraphPartitionSystem *PartitionSystem;
+    FrameGraphSystem *MergeSystem;
+    u32 PartitionCount;
+};
+
+struct FrameGraph
+{
+    PackFile *Pack;
+    JobPool *Pool;
+
+    volatile s32 Remaining;
+
+    u32 JobCount;
+    FrameGraphJob Jobs[kFrameGraphMaxJobs];
+};
+
+#define frame_graph_add_system(graph, system, context_type, context)                                   \
+    do                                                                                                 \
+    {                                                                                                  \
+        void *system_reads[k##context_type##ReadCount + 1];                                            \
+        void *system_writes[k##context_type##WriteCount + 1];                                          \
+        u32 system_read_count  = context_type##Reads((context), system_reads);                        \
+        u32 system_write_count = context_type##Writes((context), system_writes);                      \
+        frame_graph_add((graph), #system, (FrameGraphSystem *)(system), (context),                     \
+                        system_reads, system_read_count, system_writes, system_write_count);           \
+    } while (0)
+
+#define frame_graph_add_partitioned_system(graph, begin, partition, partition_count, merge, context_type, context) \
+    do                                                                                                 \
+    {                                                                                                  \
+        frame_graph_add_system((graph), begin, context_type, (context));                               \
+        frame_graph_partition_last((graph), (FrameGraphPartitionSystem *)(partition), (partition_count), \
+                                   (FrameGraphSystem *)(merge));                                       \
+    } while (0)
+
+static void
+frame_graph_init(FrameGraph *graph, PackFile *pack, JobPool *pool)
+{
+    memset(graph, 0, sizeof(FrameGraph));
+    graph->Pack = pack;
+    graph->Pool = pool;
+}
+
+static u64
+frame_graph_access_mask(FrameGraph *graph, void **blobs, u32 blob_count)
+{
+    u64 result = 0;
+    for (u32 blob_index = 0; blob_index < blob_count; blob_index++)
+    {
+        u32 instance_index = pack_file_instance_index(graph->Pack, blobs[blob_index]);
+
+        // every blob a system touches must live in the pack, otherwise conflicts are invisible
+        Assert(instance_index < 64);
+
+        result |= 1ULL << instance_index;
+    }
+    return result;
+}
+
+static void
+frame_graph_add(FrameGraph *graph, const char *name, FrameGraphSystem *system, void *context, void **reads, u32 read_count, void **writes, u32 write_count)
+{
+    Assert(graph->JobCount < kFrameGraphMaxJobs);
+
+    u32 job_index = graph->JobCount++;
+
+    FrameGraphJob *job = &graph->Jobs[job_index];
+    job->Name    = name;
+    job->System  = system;
+    job->Context = context;
+    job->Graph   = graph;
+    job->Reads   = frame_graph_access_mask(graph, reads, read_count);
+    job->Writes  = frame_graph_access_mask(graph, writes, write_count);
+
+    for (u32 prev_job_index = 0; prev_job_index < job_index; prev_job_index++)
+    {
+        FrameGraphJob *prev_job = &graph->Jobs[prev_job_index];
+
+        b32 conflict = ((prev_job->Writes & (job->Reads | job->Writes)) != 0) ||
+                       ((prev_job->Reads & job->Writes) != 0);
+        if (conflict)
+        {
+            prev_job->Dependents |= 1ULL << job_index;
+            job->DependencyCount++;
+        }
+    }
+}
+
+static void
+frame_graph_partition_last(FrameGraph *graph, FrameGraphPartitionSystem *partition_system, u32 partition_count, FrameGraphSystem *merge_system)
+{
+    Assert(graph->JobCount > 0);
+    Assert(partition_count > 0);
+
+    FrameGraphJob *job = &graph->Jobs[graph->JobCount - 1];
+    job->PartitionSystem = partition_system;
+    job->MergeSystem     = merge_system;
+    job->PartitionCount  = partition_count;
+}
+
+static void frame_graph_job_run(void *data);
+
+static void
+frame_graph_job_complete(FrameGraphJob *job)
+{
+    FrameGraph *graph = job->Graph;
+
+    for (u32 job_index = 0; job_index < graph->JobCount; job_index++)
+    {
+        if ((job->Dependents & (1ULL << job_index)) == 0)
+        {
+            continue;
+        }
+
+        FrameGraphJob *dependent_job = &graph->Jobs[job_index];
+        if (platform_atomic_decrement(&dependent_job->PendingCount) == 0)
+        {
+            job_pool_push(graph->Pool, frame_graph_job_run, dependent_job);
+        }
+    }
+
+    job_pool_finish(graph->Pool, &graph->Remaining);
+}
+
+static void
+frame_graph_partition_run(void *data, u32 begin, u32 end)
+{
+    FrameGraphJob *job = (FrameGraphJob *)data;
+
+    for (u32 partition_index = begin; partition_index < end; partition_index++)
+    {
+        job->PartitionSystem(job->Context, partition_index);
+    }
+}
+
+static void
+frame_graph_job_run(void *data)
+{
+    FrameGraphJob *job = (FrameGraphJob *)data;
+    FrameGraph *graph  = job->Graph;
+
+    job->System(job->Context);
+
+    if (job->PartitionCount)
+    {
+        // this thread runs other jobs while partitions are in flight, merge always sees every partition done
+        job_pool_parallel_for(graph->Pool, job->PartitionCount, 1, frame_graph_partition_run, job);
+        job->MergeSystem(job->Context);
+    }
+
+    frame_graph_job_complete(job);
+}
+
+static void
+frame_graph_run(FrameGraph *graph)
+{
+    #ifdef FRAME_GRAPH_SERIAL
+    for (u32 job_index = 0; job_index < graph->JobCount; job_index++)
+    {
+        FrameGraphJob *job = &graph->Jobs[job_index];
+        job->System(job->Context);
+
+        for (u32 partition_index = 0; partition_index < job->PartitionCount; partition_index++)
+        {
+            job->PartitionSystem(job->Context, partition_index);
+        }
+        if (job->PartitionCount)
+        {
+            job->MergeSystem(job->Context);
+        }
+    }
+    return;
+    #endif
+
+    graph->Remaining = graph->JobCount;
+
+    for (u32 job_index = 0; job_index < graph->JobCount; job_index++)
+    {
+        FrameGraphJob *job = &graph->Jobs[job_index];
+        job->PendingCount = job->DependencyCount;
+    }
+
+    for (u32 job_index = 0; job_index < graph->JobCount; job_index++)
+    {
+        FrameGraphJob *job = &graph->Jobs[job_index];
+        if (job->DependencyCount == 0)
+        {
+            job_pool_push(graph->Pool, frame_graph_job_run, job);
+        }
+    }
+
+    job_pool_wait(graph->Pool, &graph->Remaining);
+}
+
+#ifndef NDEBUG
+static void
+frame_graph_print(FrameGraph *graph)
+{
+    for (u32 job_index = 0; job_index < graph->JobCount; job_index++)
+    {
+        FrameGraphJob *job = &graph->Jobs[job_index];
+
+        printf("%2u %-24s partitions %u, waits %d, unblocks", job_index, job->Name, job->PartitionCount, job->DependencyCount);
+        for (u32 dependent_index = 0; dependent_index < graph->JobCount; dependent_index++)
+        {
+            if (job->Dependents & (1ULL << dependent_index))
+            {
+                printf(" %u", dependent_index);
+            }
+        }
+        printf("\n");
+    }
+}
+#endif
@@ -0,0 +1,209 @@
+// Simulation thread builds frame N+1 into one frame_data slot while the render side consumes frame N from another.
+// Depth is how many simulated frames may sit between the simulation and present, the simulation blocks beyond it.
+// Depth 0 keeps everything on the render thread, each frame is simulated right before it is consumed.
+// Slots remember when the input they were simulated with was sampled, releasing a slot records input to present latency.
+
+#ifndef __cplusplus
+typedef struct FramePipeline        FramePipeline;
+typedef struct FramePipelineSlot    FramePipelineSlot;
+typedef struct FramePipelineLatency FramePipelineLatency;
+#endif
+
+#define kFramePipelineMaxDepth  2
+#define kFramePipelineSlotCount (kFramePipelineMaxDepth + 1)
+
+struct FramePipelineSlot
+{
+    FrameData *FrameDataBin;
+    u64 InputTicks;
+};
+
+struct FramePipelineLatency
+{
+    u32 FrameCount;
+    u64 TotalTicks;
+    u64 MaxTicks;
+};
+
+struct FramePipeline
+{
+    GameWorld *World;
+
+    PlatformMutex Mutex;
+    // signaled when a frame is published, a slot is released or the pipeline quits
+    PlatformCondition Changed;
+
+    u32 Depth;
+    u32 SlotCount;
+    FramePipelineSlot Slots[kFramePipelineSlotCount];
+
+    // frame N lives in slot N % SlotCount
+    u32 PublishedCount;
+    u32 ReleasedCount;
+
+    // latest input, the simulation copies it when it starts a frame
+    GameInput Input;
+
+    // 0 measures time between simulated frames
+    f32 FixedTimeDelta;
+    u64 TicksPerSecond;
+    u64 SimulatedTicks;
+
+    // touched by the render side only
+    FramePipelineLatency Latency;
+
+    b32 Quit;
+    PlatformThread Thread;
+};
+
+static void
+frame_pipeline_simulate(FramePipeline *pipeline, FramePipelineSlot *slot, GameInput *input)
+{
+    u64 ticks                = platform_ticks();
+    f32 time_delta           = (f32)((f64)(ticks - pipeline->SimulatedTicks) / pipeline->TicksPerSecond);
+    pipeline->SimulatedTicks = ticks;
+
+    if (pipeline->FixedTimeDelta > 0.0f)
+    {
+        time_delta = pipeline->FixedTimeDelta;
+    }
+
+    game_world_update(pipeline->World, input, time_delta, slot->FrameDataBin);
+    slot->InputTicks = input->ticks;
+}
+
+static void
+frame_pipeline_thread(void *parameter)
+{
+    FramePipeline *pipeline = (FramePipeline *)parameter;
+
+    platform_mutex_lock(&pipeline->Mutex);
+
+    for (;;)
+    {
+        // slot of the next frame is free once no more than depth frames are waiting or being presented
+        while (!pipeline->Quit && ((pipeline->PublishedCount - pipeline->ReleasedCount) > pipeline->Depth))
+        {
+            platform_condition_wait(&pipeline->Changed, &pipeline->Mutex);
+        }
+
+        if (pipeline->Quit)
+        {
+            break;
+        }
+
+        FramePipelineSlot *slot = &pipeline->Slots[pipeline->PublishedCount % pipeline->SlotCount];
+        GameInput input         = pipeline->Input;
+
+        platform_mutex_unlock(&pipeline->Mutex);
+        frame_pipeline_simulate(pipeline, slot, &input);
+        platform_mutex_lock(&pipeline->Mutex);
+
+        pipeline->PublishedCount++;
+        platform_condition_broadcast(&pipeline->Changed);
+    }
+
+    platform_mutex_unlock(&pipeline->Mutex);
+}
+
+static void
+frame_pipeline_init(FramePipeline *pipeline, GameWorld *world, u32 depth, f32 fixed_time_delta, GameInput *input)
+{
+    Assert(depth <= kFramePipelineMaxDepth);
+    Assert((depth + 1) <= kWorldPackFrameDataInstanceCount);
+
+    memset(pipeline, 0, sizeof(FramePipeline));
+
+    platform_mutex_init(&pipeline->Mutex);
+    platform_condition_init(&pipeline->Changed);
+
+    pipeline->World     = world;
+    pipeline->Depth     = depth;
+    pipeline->SlotCount = depth + 1;
+
+    for (u32 slot_index = 0; slot_index < pipeline->SlotCount; slot_index++)
+    {
+        pipeline->Slots[slot_index].FrameDataBin = (FrameData *)pack_file_instance_prt(world->world_pack, kWorldPackFrameData, slot_index);
+    }
+
+    pipeline->Input          = *input;
+    pipeline->FixedTimeDelta = fixed_time_delta;
+    pipeline->TicksPerSecond = platform_ticks_per_second();
+    pipeline->SimulatedTicks = platform_ticks();
+
+    if (pipeline->Depth > 0)
+    {
+        platform_thread_create(&pipeline->Thread, frame_pipeline_thread, pipeline);
+    }
+}
+
+static void
+frame_pipeline_input(FramePipeline *pipeline, GameInput *input)
+{
+    platform_mutex_lock(&pipeline->Mutex);
+    pipeline->Input = *input;
+    platform_mutex_unlock(&pipeline->Mutex);
+}
+
+// oldest simulated frame, stays untouched by the simulation until frame_pipeline_release
+static FrameData *
+frame_pipeline_acquire(FramePipeline *pipeline)
+{
+    FramePipelineSlot *slot = &pipeline->Slots[pipeline->ReleasedCount % pipeline->SlotCount];
+
+    if (pipeline->Depth == 0)
+    {
+        frame_pipeline_simulate(pipeline, slot, &pipeline->Input);
+        pipeline->PublishedCount++;
+        return slot->FrameDataBin;
+    }
+
+    platform_mutex_lock(&pipeline->Mutex);
+    while (pipeline->PublishedCount == pipeline->ReleasedCount)
+    {
+        platform_condition_wait(&pipeline->Changed, &pipeline->Mutex);
+    }
+    platform_mutex_unlock(&pipeline->Mutex);
+
+    return slot->FrameDataBin;
+}
+
+// call once the acquired frame is presented
+static void
+frame_pipeline_release(FramePipeline *pipeline)
+{
+    FramePipelineSlot *slot = &pipeline->Slots[pipeline->ReleasedCount % pipeline->SlotCount];
+
+    u64 latency_ticks = platform_ticks() - slot->InputTicks;
+
+    pipeline->Latency.FrameCount++;
+    pipeline->Latency.TotalTicks += latency_ticks;
+    pipeline->Latency.MaxTicks    = max(pipeline->Latency.MaxTicks, latency_ticks);
+
+    platform_mutex_lock(&pipeline->Mutex);
+    pipeline->ReleasedCount++;
+    platform_condition_broadcast(&pipeline->Changed);
+    platform_mutex_unlock(&pipeline->Mutex);
+}
+
+static f64
+frame_pipeline_ticks_to_ms(FramePipeline *pipeline, u64 ticks)
+{
+    return ((f64)ticks * 1000.0) / pipeline->TicksPerSecond;
+}
+
+static void
+frame_pipeline_shutdown(FramePipeline *pipeline)
+{
+    if (pipeline->Depth == 0)
+    {
+        return;
+    }
+
+    platform_mutex_lock(&pipeline->Mutex);
+    pipeline->Quit = 1;
+    platform_condition_broadcast(&pipeline->Changed);
+    platform_mutex_unlock(&pipeline->Mutex);
+
+    platform_thread_join(&pipeline->Thread);
+}
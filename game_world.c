@@ -0,0 +1,659 @@
+// Game world shared by every platform layer: pack blobs, system contexts and the update graph.
+// Platforms sample GameInput and hand in a frame_data blob, everything else happens in game_world_update.
+
+#include "pack_file.h"
+
+#include "world_pack.h"
+
+#include "game_state.h"
+#include "level_update.h"
+#include "wave_update.h"
+
+#include "play_clock.h"
+
+#include "play_area.h"
+#include "frame_data.h"
+#include "materials.h"
+
+#include "enemy_instances.h"
+#include "enemy_instances_wave.h"
+#include "hero_instances.h"
+
+#include "bullets.h"
+#include "bullets_update.h"
+#include "bullets_draw.h"
+#include "bullet_source_instances.h"
+
+#include "enemy_instances_draw.h"
+#include "hero_instances_draw.h"
+
+#include "collision_grid.h"
+#include "collision_source_instances.h"
+#include "collision_instances_damage.h"
+#include "collision_source_radius.h"
+#include "collision_source_damage.h"
+#include "damage_event_pool.h"
+#include "collision_damage.h"
+
+#include "game_state_static.h"
+#include "level_update_static.h"
+#include "wave_update_static.h"
+#include "frame_data_static.h"
+#include "bullets_update_static.h"
+#include "collision_grid_static.h"
+#include "damage_event_pool_static.h"
+#include "collision_damage_static.h"
+
+#include "platform_threads.c"
+#include "frame_data_reserve.c"
+#include "frame_data_cull.c"
+
+#include "enemy_instances_update.c"
+#include "enemy_instances_draw.c"
+
+#include "hero_instances_update.c"
+#include "hero_instances_draw.c"
+
+#include "bullets_update.c"
+#include "bullets_draw.c"
+#include "level_update.c"
+#include "wave_update.c"
+#include "collision_grid_update.c"
+#include "collision_damage_events.c"
+#include "collision_damage_update.c"
+
+#include "template_registry.c"
+#include "job_pool.c"
+#include "frame_graph.c"
+#include "collision_world.c"
+
+#ifndef __cplusplus
+typedef struct GameInput GameInput;
+typedef struct GameWorld GameWorld;
+#endif
+
+// game_state keeps clocks and input across runs, frame_data is rebuilt every frame
+#define kGameWorldTemplateEntriesMask ((1ULL << kWorldPackLevelUpdate) |        \
+                                       (1ULL << kWorldPackWaveUpdate) |         \
+                                       (1ULL << kWorldPackEnemyInstances) |     \
+                                       (1ULL << kWorldPackHeroInstances) |      \
+                                       (1ULL << kWorldPackEnemyBulletsUpdate) | \
+                                       (1ULL << kWorldPackHeroBulletsUpdate) |  \
+                                       (1ULL << kWorldPackCollisionGrid) |      \
+                                       (1ULL << kWorldPackDamageEventPool) |    \
+                                       (1ULL << kWorldPackCollisionDamage))
+
+// scratch arena of every job pool thread
+#define kGameWorldJobArenaSize (64 * 1024)
+
+struct GameInput
+{
+    // platform ticks when the input was sampled
+    u64 ticks;
+
+    s32 screen_width;
+    s32 screen_height;
+
+    // client area pixels, y goes up
+    f32 mouse_x;
+    f32 mouse_y;
+
+    // total presses so far, the world applies the ones it has not seen yet
+    u32 play_toggle_press_count;
+};
+
+struct GameWorld
+{
+    PackFile *world_pack;
+
+    m4x4_inv matrix;
+    f32 game_aspect;
+
+    u32 play_toggle_press_count;
+
+    GameState *game_state;
+    LevelUpdate *level_update_data;
+    WaveUpdate *wave_update_data;
+    EnemyInstances *enemy_instances;
+    Bullets *enemy_bullets;
+    Bullets *hero_bullets;
+    HeroInstances *hero_instances;
+    Materials *materials;
+
+    BulletsUpdate *enemy_bullets_update_data;
+    BulletsUpdate *hero_bullets_update_data;
+
+    CollisionGrid *hero_bullets_collision_grid;
+    CollisionGrid *enemy_bullets_collision_grid;
+    CollisionGrid *hero_instances_collision_grid;
+    CollisionGrid *enemy_instances_collision_grid;
+
+    CollisionDamage *enemy_instances_vs_hero_bullets_collision_damage;
+    CollisionDamage *hero_instances_vs_enemy_bullets_collision_damage;
+
+    DamageEventPool *damage_event_pool;
+
+    BulletsUpdateContext enemy_bullets_update_context;
+    BulletsDrawContext enemy_bullets_draw_context;
+    BulletsUpdateContext hero_bullets_update_context;
+    BulletsDrawContext hero_bullets_draw_context;
+    EnemyInstancesContext enemy_instances_context;
+    EnemyInstancesDrawContext enemy_instances_draw_context;
+    LevelUpdateContext level_update_context;
+    WaveUpdateContext wave_update_context;
+    HeroInstancesContext hero_instances_context;
+    HeroInstancesDrawContext hero_instances_draw_context;
+
+    CollisionWorld collision_world;
+
+    u32 hero_bullets_collision_group;
+    u32 enemy_bullets_collision_group;
+    u32 hero_instances_collision_group;
+    u32 enemy_instances_collision_group;
+
+    u32 enemy_instances_vs_hero_bullets_interaction;
+    u32 hero_instances_vs_enemy_bullets_interaction;
+
+    TemplateRegistry template_registry;
+    FrameGraph update_graph;
+};
+
+static void
+begin_frame(FrameData *frame_data, f32 game_aspect, s32 screen_width, s32 screen_height)
+{
+    u16 *frame_data_count_prt   = FrameDataFrameDataCountPrt(frame_data);
+
+    FrameDataViewport *viewport_prt      = FrameDataViewportPrt(frame_data);
+    FrameDataScreenSize *screen_size_prt = FrameDataScreenSizePrt(frame_data);
+
+    screen_size_prt->Width  = screen_width;
+    screen_size_prt->Height = screen_height;
+    *frame_data_count_prt   = 0;
+
+    *FrameDataOverflowCountPrt(frame_data) = 0;
+    memset(FrameDataCullCountsPrt(frame_data), 0, sizeof(FrameDataCullCounts));
+
+    f32 window_aspect = (f32)screen_size_prt->Width / screen_size_prt->Height;
+
+    if (window_aspect > game_aspect)
+    {
+        viewport_prt->Width  = screen_size_prt->Height * game_aspect;
+        viewport_prt->Height = (f32)screen_size_prt->Height;
+        viewport_prt->X      = (screen_size_prt->Width - viewport_prt->Width) * 0.5f;
+        viewport_prt->Y      = 0.0f;
+    }
+    else
+    {
+        viewport_prt->Width  = (f32)screen_size_prt->Width;
+        viewport_prt->Height = screen_size_prt->Width / game_aspect;
+        viewport_prt->X      = 0.0f;
+        viewport_prt->Y      = (screen_size_prt->Height - viewport_prt->Height) * 0.5f;
+    }
+}
+
+#ifndef NDEBUG
+static void
+collision_grid_print_draw(CollisionGridContext *context_a, CollisionGridContext *context_b)
+{
+    CollisionGrid *a_collision_grid = context_a->Root;
+
+    CollisionGridGridRowCount *a_collision_grid_row_count = CollisionGridGridRowCountPrt(a_collision_grid);
+    CollisionGridGridRows *a_collision_grid_rows = CollisionGridGridRowsPrt(a_collision_grid);
+
+    CollisionGrid *b_collision_grid = context_b->Root;
+
+    CollisionGridGridRowCount *b_collision_grid_row_count = CollisionGridGridRowCountPrt(b_collision_grid);
+    CollisionGridGridRows *b_collision_grid_rows = CollisionGridGridRowsPrt(b_collision_grid);
+    
+    printf("\033[0;0H");
+
+    // rows of all levels, finest first
+    for (s32 row_index = 0; row_index < (s32)collision_grid_level_row_offset(kCollisionGridLevelCount); row_index++)
+    {
+        printf("%02d ", row_index);
+
+        {
+            u8 count = a_collision_grid_row_count->GridRowCount[row_index];
+            if (count > kCollisionGridColCount)
+            {
+                printf("\033[1;31m");
+            }
+            else
+            {
+                printf("\033[34m");
+            }
+            printf("%02x ", count);
+
+            printf("\033[32m");
+            s32 col_index = 0;
+            for (; col_index < count; col_index++)
+            {
+                u8 source_index = a_collision_grid_rows->GridRows[(row_index * kCollisionGridColCount) + col_index];
+                printf("%02x ", source_index);
+            }
+            printf("\033[37m");
+            for (; col_index < kCollisionGridColCount; col_index++)
+            {
+                u8 source_index = a_collision_grid_rows->GridRows[(row_index * kCollisionGridColCount) + col_index];
+                printf("%02x ", source_index);
+            }
+        }
+
+        printf("  ");
+
+        {
+            u8 count = b_collision_grid_row_count->GridRowCount[row_index];
+            if (count > kCollisionGridColCount)
+            {
+                printf("\033[1;31m");
+            }
+            else
+            {
+                printf("\033[34m");
+            }
+            printf("%02x ", count);
+
+            printf("\033[32m");
+            s32 col_index = 0;
+            for (; col_index < count; col_index++)
+            {
+                u8 source_index = b_collision_grid_rows->GridRows[(row_index * kCollisionGridColCount) + col_index];
+                printf("%02x ", source_index);
+            }
+            printf("\033[37m");
+            for (; col_index < kCollisionGridColCount; col_index++)
+            {
+                u8 source_index = b_collision_grid_rows->GridRows[(row_index * kCollisionGridColCount) + col_index];
+                printf("%02x ", source_index);
+            }
+        }
+
+        printf("\n");
+    }
+}
+
+static void
+collision_damage_print_draw(CollisionDamageContext *context)
+{
+    CollisionDamage *collision_damage_bin = context->Root;
+    DamageEventPool *damage_event_pool_bin = context->DamageEventPoolBin;
+
+    f32 *damage_events_time_prt = DamageEventPoolDamageEventsTimeStaticPrt(damage_event_pool_bin);
+    u8 *damage_events_a_source_instance_index_prt = DamageEventPoolDamageEventsASourceInstanceIndexStaticPrt(damage_event_pool_bin);
+    u8 *damage_events_b_source_instance_index_prt = DamageEventPoolDamageEventsBSourceInstanceIndexStaticPrt(damage_event_pool_bin);
+
+    CollisionDamageAccumulatedDamage *collision_damage_accumulated_damage_sheet = CollisionDamageAccumulatedDamagePrt(collision_damage_bin);
+    u16 *accumulated_damage_a_value_prt = CollisionDamageAccumulatedDamageAValuePrt(collision_damage_bin, collision_damage_accumulated_damage_sheet);
+    u16 *accumulated_damage_b_value_prt = CollisionDamageAccumulatedDamageBValuePrt(collision_damage_bin, collision_damage_accumulated_damage_sheet);
+
+    u16 *a_damage_value_prt = DamageEventPoolDamageEventsAValueStaticPrt(damage_event_pool_bin);
+    u16 *b_damage_value_prt = DamageEventPoolDamageEventsBValueStaticPrt(damage_event_pool_bin);
+
+    // events the draw consumer has not consumed yet, oldest first
+    u32 damage_events_count = min(collision_damage_event_available(collision_damage_bin, kCollisionDamageDamageEventConsumerDraw), 32);
+
+    printf("\033[0;0H");
+    
+    for (u32 event_index = 0; event_index < damage_events_count; event_index++)
+    {
+        u32 damage_index = collision_damage_event_peek(collision_damage_bin, kCollisionDamageDamageEventConsumerDraw, event_index);
+
+        printf("\033[1;35m");
+
+        printf("%5.2f ", damage_events_time_prt[damage_index]);
+
+        printf("\033[37m");
+
+        u16 a_source_index = damage_events_a_source_instance_index_prt[damage_index];
+        u16 b_source_index = damage_events_b_source_instance_index_prt[damage_index];
+
+        printf("%02x %02x", a_source_index, b_source_index);
+
+        printf(" ");
+
+        printf("%04x %04x", a_damage_value_prt[damage_index], b_damage_value_prt[damage_index]);
+
+        printf(" ");
+
+        printf("%04x %04x", accumulated_damage_a_value_prt[a_source_index], accumulated_damage_b_value_prt[b_source_index]);
+
+        printf("\n");
+    }
+
+}
+#endif
+
+static void
+collision_damage_draw(CollisionDamageContext *context, FrameData *frame_data)
+{
+    CollisionDamage *collision_damage_bin = context->Root;
+    LevelUpdate *level_update_bin = context->LevelUpdateBin;
+    DamageEventPool *damage_event_pool_bin = context->DamageEventPoolBin;
+
+    v2 *a_damage_position_prt = (v2*)DamageEventPoolDamageEventsAPositionStaticPrt(damage_event_pool_bin);
+    v2 *b_damage_position_prt = (v2*)DamageEventPoolDamageEventsBPositionStaticPrt(damage_event_pool_bin);
+
+    f32 *damage_time_prt = DamageEventPoolDamageEventsTimeStaticPrt(damage_event_pool_bin);
+
+    f32 level_time = *LevelUpdateTimePrt(level_update_bin);
+
+    // lifetime comes from the material each side is drawn with, an event stays queued while either side is alive
+    CollisionDamageDamageEffectMaterial damage_effect_material = *CollisionDamageDamageEffectMaterialStaticPrt(collision_damage_bin);
+    f32 *damage_effect_lifetime_prt = CollisionDamageDamageEffectLifetimeStaticPrt(collision_damage_bin)->DamageEffectLifetime;
+
+    Assert((damage_effect_material.AMaterialIndex < kCollisionDamageMaxEffectMaterialCount) && (damage_effect_material.BMaterialIndex < kCollisionDamageMaxEffectMaterialCount));
+
+    f32 a_effect_lifetime = damage_effect_lifetime_prt[damage_effect_material.AMaterialIndex];
+    f32 b_effect_lifetime = damage_effect_lifetime_prt[damage_effect_material.BMaterialIndex];
+    f32 effect_lifetime   = max(a_effect_lifetime, b_effect_lifetime);
+
+    // the draw cursor is the head of the effect queue: events are published in time order and every event of this log
+    // lives as long, so expired ones are only at the front and retire by advancing the cursor, the rest are all active
+    // events from before a level reset are ahead of level time and expire as well
+    u32 damage_events_count = collision_damage_event_available(collision_damage_bin, kCollisionDamageDamageEventConsumerDraw);
+    u32 expired_count = 0;
+
+    while (expired_count < damage_events_count)
+    {
+        f32 damage_time = damage_time_prt[collision_damage_event_peek(collision_damage_bin, kCollisionDamageDamageEventConsumerDraw, expired_count)];
+        if (((level_time - damage_time) < effect_lifetime) && (damage_time <= level_time))
+        {
+            break;
+        }
+        expired_count++;
+    }
+
+    collision_damage_event_consume(collision_damage_bin, damage_event_pool_bin, kCollisionDamageDamageEventConsumerDraw, expired_count);
+
+    // peek indices are relative to the cursor, which is now past the expired events
+    u32 active_count = damage_events_count - expired_count;
+
+    FrameDataCullBatch cull_batch;
+    frame_data_cull_begin(&cull_batch, frame_data);
+
+    for (u32 event_index = 0; event_index < active_count; event_index++)
+    {
+        u32 damage_index = collision_damage_event_peek(collision_damage_bin, kCollisionDamageDamageEventConsumerDraw, event_index);
+        f32 damage_age   = level_time - damage_time_prt[damage_index];
+
+        if (damage_age < a_effect_lifetime)
+        {
+            frame_data_cull_push(&cull_batch, a_damage_position_prt[damage_index], 0.1f, damage_effect_material.AMaterialIndex);
+        }
+
+        if (damage_age < b_effect_lifetime)
+        {
+            frame_data_cull_push(&cull_batch, b_damage_position_prt[damage_index], 0.1f, damage_effect_material.BMaterialIndex);
+        }
+    }
+
+    frame_data_cull_flush(&cull_batch);
+}
+
+// second consumer of the damage event log: totals every event once, headless prints them
+static void
+collision_damage_stats(CollisionDamageContext *context)
+{
+    CollisionDamage *collision_damage_bin = context->Root;
+    DamageEventPool *damage_event_pool_bin = context->DamageEventPoolBin;
+
+    u16 *a_damage_value_prt = DamageEventPoolDamageEventsAValueStaticPrt(damage_event_pool_bin);
+    u16 *b_damage_value_prt = DamageEventPoolDamageEventsBValueStaticPrt(damage_event_pool_bin);
+
+    CollisionDamageDamageEventStats *damage_event_stats = CollisionDamageDamageEventStatsStaticPrt(collision_damage_bin);
+
+    u32 damage_events_count = collision_damage_event_available(collision_damage_bin, kCollisionDamageDamageEventConsumerStats);
+
+    for (u32 event_index = 0; event_index < damage_events_count; event_index++)
+    {
+        u32 damage_index = collision_damage_event_peek(collision_damage_bin, kCollisionDamageDamageEventConsumerStats, event_index);
+
+        damage_event_stats->AValueTotal += a_damage_value_prt[damage_index];
+        damage_event_stats->BValueTotal += b_damage_value_prt[damage_index];
+    }
+
+    damage_event_stats->EventCount += damage_events_count;
+
+    collision_damage_event_consume(collision_damage_bin, damage_event_pool_bin, kCollisionDamageDamageEventConsumerStats, damage_events_count);
+}
+
+static void
+game_world_init(GameWorld *world, PackFile *world_pack, JobPool *job_pool, void *template_memory, u32 template_memory_size)
+{
+    memset(world, 0, sizeof(GameWorld));
+
+    world->world_pack = world_pack;
+
+    v2 game_area = V2(kPlayAreaWidth, kPlayAreaHeight);
+
+    v2 half_game_area = v2_scale(game_area, 0.5f);
+
+    f32 left = -half_game_area.x;
+    f32 right = half_game_area.x;
+    f32 bottom = -half_game_area.y;
+    f32 top = half_game_area.y;
+
+    f32 near_clip_plane = 0.0f;
+    f32 far_clip_plane = 1.0f;
+
+    world->matrix      = orthographic_projection(left, right, bottom, top, near_clip_plane, far_clip_plane);
+    world->game_aspect = game_area.x / game_area.y;
+
+    template_registry_init(&world->template_registry, world_pack, kGameWorldTemplateEntriesMask, template_memory, template_memory_size);
+
+    world->game_state        = (GameState *)pack_file_instance_prt(world_pack, kWorldPackGameState, 0);
+    world->level_update_data = (LevelUpdate *)pack_file_instance_prt(world_pack, kWorldPackLevelUpdate, 0);
+    world->wave_update_data  = (WaveUpdate *)pack_file_instance_prt(world_pack, kWorldPackWaveUpdate, 0);
+    world->enemy_instances   = (EnemyInstances *)pack_file_instance_prt(world_pack, kWorldPackEnemyInstances, 0);
+    world->enemy_bullets     = (Bullets *)pack_file_instance_prt(world_pack, kWorldPackEnemyBullets, 0);
+    world->hero_bullets      = (Bullets *)pack_file_instance_prt(world_pack, kWorldPackHeroBullets, 0);
+    world->hero_instances    = (HeroInstances *)pack_file_instance_prt(world_pack, kWorldPackHeroInstances, 0);
+    world->materials         = (Materials *)pack_file_instance_prt(world_pack, kWorldPackMaterials, 0);
+
+    world->enemy_bullets_update_data = (BulletsUpdate *)pack_file_instance_prt(world_pack, kWorldPackEnemyBulletsUpdate, 0);
+    world->hero_bullets_update_data  = (BulletsUpdate *)pack_file_instance_prt(world_pack, kWorldPackHeroBulletsUpdate, 0);
+
+    world->hero_bullets_collision_grid    = (CollisionGrid *)pack_file_instance_prt(world_pack, kWorldPackCollisionGrid, 0);
+    world->enemy_bullets_collision_grid   = (CollisionGrid *)pack_file_instance_prt(world_pack, kWorldPackCollisionGrid, 1);
+    world->hero_instances_collision_grid  = (CollisionGrid *)pack_file_instance_prt(world_pack, kWorldPackCollisionGrid, 2);
+    world->enemy_instances_collision_grid = (CollisionGrid *)pack_file_instance_prt(world_pack, kWorldPackCollisionGrid, 3);
+
+    world->enemy_instances_vs_hero_bullets_collision_damage = (CollisionDamage *)pack_file_instance_prt(world_pack, kWorldPackCollisionDamage, 0);
+    world->hero_instances_vs_enemy_bullets_collision_damage = (CollisionDamage *)pack_file_instance_prt(world_pack, kWorldPackCollisionDamage, 1);
+    world->damage_event_pool = (DamageEventPool *)pack_file_instance_prt(world_pack, kWorldPackDamageEventPool, 0);
+
+    // systems use static offsets for runtime blobs, binaries must be exported with the same schemas
+    Assert(GameStateStaticLayoutMatch(world->game_state));
+    Assert(LevelUpdateStaticLayoutMatch(world->level_update_data));
+    Assert(WaveUpdateStaticLayoutMatch(world->wave_update_data));
+    Assert(BulletsUpdateStaticLayoutMatch(world->enemy_bullets_update_data));
+    Assert(BulletsUpdateStaticLayoutMatch(world->hero_bullets_update_data));
+    Assert(CollisionGridStaticLayoutMatch(world->hero_bullets_collision_grid));
+    Assert(CollisionGridStaticLayoutMatch(world->enemy_bullets_collision_grid));
+    Assert(CollisionGridStaticLayoutMatch(world->hero_instances_collision_grid));
+    Assert(CollisionGridStaticLayoutMatch(world->enemy_instances_collision_grid));
+    Assert(CollisionDamageStaticLayoutMatch(world->enemy_instances_vs_hero_bullets_collision_damage));
+    Assert(CollisionDamageStaticLayoutMatch(world->hero_instances_vs_enemy_bullets_collision_damage));
+    Assert(DamageEventPoolStaticLayoutMatch(world->damage_event_pool));
+
+    world->enemy_bullets_update_context.Root                        = world->enemy_bullets_update_data;
+    world->enemy_bullets_update_context.BulletsBin                  = world->enemy_bullets;
+    world->enemy_bullets_update_context.BulletSourceInstancesBin    = EnemyInstancesBulletSourceInstancesMapPrt(world->enemy_instances);
+    world->enemy_bullets_update_context.GameStateBin                = world->game_state;
+    world->enemy_bullets_update_context.PlayClockBin                = WaveUpdatePlayClockMapPrt(world->wave_update_data);
+    world->enemy_bullets_update_context.CollisionInstancesDamageBin = CollisionDamageBCollisionInstancesDamageMapPrt(world->hero_instances_vs_enemy_bullets_collision_damage);
+
+    world->enemy_bullets_draw_context.BulletsBin       = world->enemy_bullets;
+    world->enemy_bullets_draw_context.BulletsUpdateBin = world->enemy_bullets_update_data;
+
+    world->hero_bullets_update_context.Root                        = world->hero_bullets_update_data;
+    world->hero_bullets_update_context.BulletsBin                  = world->hero_bullets;
+    world->hero_bullets_update_context.BulletSourceInstancesBin    = HeroInstancesBulletSourceInstancesMapPrt(world->hero_instances);
+    world->hero_bullets_update_context.GameStateBin                = world->game_state;
+    world->hero_bullets_update_context.PlayClockBin                = LevelUpdatePlayClockMapPrt(world->level_update_data);
+    world->hero_bullets_update_context.CollisionInstancesDamageBin = CollisionDamageBCollisionInstancesDamageMapPrt(world->enemy_instances_vs_hero_bullets_collision_damage);
+
+    world->hero_bullets_draw_context.BulletsBin       = world->hero_bullets;
+    world->hero_bullets_draw_context.BulletsUpdateBin = world->hero_bullets_update_data;
+
+    world->enemy_instances_context.Root           = world->enemy_instances;
+    world->enemy_instances_context.GameStateBin   = world->game_state;
+    world->enemy_instances_context.WaveUpdateBin  = world->wave_update_data;
+    world->enemy_instances_context.LevelUpdateBin = world->level_update_data;
+    world->enemy_instances_context.CollisionInstancesDamageBin = CollisionDamageACollisionInstancesDamageMapPrt(world->enemy_instances_vs_hero_bullets_collision_damage);
+
+    world->enemy_instances_draw_context.EnemyInstancesBin = world->enemy_instances;
+
+    world->level_update_context.Root                  = world->level_update_data;
+    world->level_update_context.GameStateBin          = world->game_state;
+    world->level_update_context.EnemyInstancesBin     = world->enemy_instances;
+    world->level_update_context.EnemyBulletsUpdateBin = world->enemy_bullets_update_data;
+
+    world->wave_update_context.Root                  = world->wave_update_data;
+    world->wave_update_context.GameStateBin          = world->game_state;
+    world->wave_update_context.EnemyInstancesBin     = world->enemy_instances;
+    world->wave_update_context.EnemyBulletsUpdateBin = world->enemy_bullets_update_data;
+    world->wave_update_context.LevelUpdateBin        = world->level_update_data;
+
+    world->hero_instances_context.Root         = world->hero_instances;
+    world->hero_instances_context.GameStateBin = world->game_state;
+    world->hero_instances_context.CollisionInstancesDamageBin = CollisionDamageACollisionInstancesDamageMapPrt(world->hero_instances_vs_enemy_bullets_collision_damage);
+
+    world->hero_instances_draw_context.HeroInstancesBin = world->hero_instances;
+
+    // collision groups build their grids once, interactions are cells of the group x group matrix
+    CollisionWorld *collision_world = &world->collision_world;
+    collision_world_init(collision_world, world->level_update_data, world->damage_event_pool);
+
+    world->hero_bullets_collision_group    = collision_world_add_group(collision_world, world->hero_bullets_collision_grid,
+                                                                       BulletsUpdateCollisionSourceInstancesMapPrt(world->hero_bullets_update_data),
+                                                                       BulletsCollisionSourceRadiusMapPrt(world->hero_bullets),
+                                                                       BulletsCollisionSourceDamageMapPrt(world->hero_bullets));
+    world->enemy_bullets_collision_group   = collision_world_add_group(collision_world, world->enemy_bullets_collision_grid,
+                                                                       BulletsUpdateCollisionSourceInstancesMapPrt(world->enemy_bullets_update_data),
+                                                                       BulletsCollisionSourceRadiusMapPrt(world->enemy_bullets),
+                                                                       BulletsCollisionSourceDamageMapPrt(world->enemy_bullets));
+    world->hero_instances_collision_group  = collision_world_add_group(collision_world, world->hero_instances_collision_grid,
+                                                                       HeroInstancesCollisionSourceInstancesMapPrt(world->hero_instances),
+                                                                       HeroInstancesCollisionSourceRadiusMapPrt(world->hero_instances),
+                                                                       HeroInstancesCollisionSourceDamageMapPrt(world->hero_instances));
+    world->enemy_instances_collision_group = collision_world_add_group(collision_world, world->enemy_instances_collision_grid,
+                                                                       EnemyInstancesCollisionSourceInstancesMapPrt(world->enemy_instances),
+                                                                       EnemyInstancesCollisionSourceRadiusMapPrt(world->enemy_instances),
+                                                                       EnemyInstancesCollisionSourceDamageMapPrt(world->enemy_instances));
+
+    world->enemy_instances_vs_hero_bullets_interaction = collision_world_add_interaction(collision_world, world->enemy_instances_collision_group, world->hero_bullets_collision_group,
+                                                                                         world->enemy_instances_vs_hero_bullets_collision_damage);
+    world->hero_instances_vs_enemy_bullets_interaction = collision_world_add_interaction(collision_world, world->hero_instances_collision_group, world->enemy_bullets_collision_group,
+                                                                                         world->hero_instances_vs_enemy_bullets_collision_damage);
+
+    // registration order is the serial frame order, read/write sets come from schema contexts
+    frame_graph_init(&world->update_graph, world_pack, job_pool);
+
+    frame_graph_add_system(&world->update_graph, level_update, LevelUpdateContext, &world->level_update_context);
+    frame_graph_add_system(&world->update_graph, wave_update, WaveUpdateContext, &world->wave_update_context);
+
+    frame_graph_add_system(&world->update_graph, enemy_instances_update, EnemyInstancesContext, &world->enemy_instances_context);
+    frame_graph_add_system(&world->update_graph, hero_instances_update, HeroInstancesContext, &world->hero_instances_context);
+
+    frame_graph_add_partitioned_system(&world->update_graph, bullets_update_begin, bullets_move, kBulletsUpdateMovePartitionCount, bullets_spawn,
+                                       BulletsUpdateContext, &world->enemy_bullets_update_context);
+    frame_graph_add_partitioned_system(&world->update_graph, bullets_update_begin, bullets_move, kBulletsUpdateMovePartitionCount, bullets_spawn,
+                                       BulletsUpdateContext, &world->hero_bullets_update_context);
+
+    collision_world_add_systems(&world->collision_world, &world->update_graph);
+
+    #ifndef NDEBUG
+    //frame_graph_print(&world->update_graph);
+    #endif
+
+    // every frame_data instance is a frame slot, draws write into the one passed to game_world_update
+    for (u32 frame_data_index = 0; frame_data_index < kWorldPackFrameDataInstanceCount; frame_data_index++)
+    {
+        Assert(FrameDataStaticLayoutMatch((FrameData *)pack_file_instance_prt(world_pack, kWorldPackFrameData, frame_data_index)));
+    }
+
+    *GameStateStatePrt(world->game_state) |= kGameStateReset|kGameStatePlayEnable;
+}
+
+static void
+game_world_update(GameWorld *world, GameInput *input, f32 time_delta, FrameData *frame_data)
+{
+    f32 *time_delta_ptr          = GameStateTimeDeltaPrt(world->game_state);
+    f64 *time_ptr                = GameStateTimePrt(world->game_state);
+    f32 *play_time_ptr           = GameStatePlayTimePrt(world->game_state);
+    u64 *frame_count_ptr         = GameStateFrameCounterPrt(world->game_state);
+    u32 *state_ptr               = GameStateStatePrt(world->game_state);
+    v2 *world_mouse_position_ptr = (v2 *)GameStateWorldMousePositionPrt(world->game_state);
+
+    u64 *hero_instances_live_ptr = HeroInstancesInstancesLivePrt(world->hero_instances);
+
+    // input may be sampled several times per simulated frame, apply every press since the last one
+    while (world->play_toggle_press_count != input->play_toggle_press_count)
+    {
+        world->play_toggle_press_count++;
+
+        if ((*hero_instances_live_ptr) == 0)
+        {
+            template_registry_reset(&world->template_registry);
+            *state_ptr |= kGameStateReset|kGameStatePlayEnable;
+        }
+        else
+        {
+            *state_ptr ^= kGameStatePlayEnable;
+        }
+    }
+
+    begin_frame(frame_data, world->game_aspect, input->screen_width, input->screen_height);
+
+    FrameDataGameTime *frame_game_time_prt = FrameDataGameTimePrt(frame_data);
+    frame_game_time_prt->Time         = *time_ptr;
+    frame_game_time_prt->FrameCounter = *frame_count_ptr;
+
+    if (input->screen_width == 0 || input->screen_height == 0)
+    {
+        return;
+    }
+
+    *time_delta_ptr = time_delta;
+
+    if ((*state_ptr) & kGameStatePlayEnable)
+    {
+        FrameDataViewport viewport = *FrameDataViewportPrt(frame_data);
+
+        f32 clip_space_mouseX = clamp_binormal_map_to_range(viewport.X, input->mouse_x, viewport.X + viewport.Width);
+        f32 clip_space_mouseY = clamp_binormal_map_to_range(viewport.Y, input->mouse_y, viewport.Y + viewport.Height);
+
+        *world_mouse_position_ptr = transform(world->matrix.inverse, V2(clip_space_mouseX, clip_space_mouseY));
+
+        *play_time_ptr += *time_delta_ptr;
+
+        frame_graph_run(&world->update_graph);
+
+        *state_ptr &= ~kGameStateReset;
+    }
+
+    #ifndef NDEBUG
+    //collision_damage_print_draw(&world->collision_world.Interactions[world->enemy_instances_vs_hero_bullets_interaction].DamageContext);
+    //collision_grid_print_draw(&world->collision_world.Groups[world->enemy_instances_collision_group].GridContext, &world->collision_world.Groups[world->hero_bullets_collision_group].GridContext);
+    #endif
+
+    world->enemy_bullets_draw_context.FrameDataBin   = frame_data;
+    world->enemy_instances_draw_context.FrameDataBin = frame_data;
+    world->hero_bullets_draw_context.FrameDataBin    = frame_data;
+    world->hero_instances_draw_context.FrameDataBin  = frame_data;
+
+    bullets_draw(&world->enemy_bullets_draw_context);
+    enemy_instances_draw(&world->enemy_instances_draw_context);
+    bullets_draw(&world->hero_bullets_draw_context);
+    hero_instances_draw(&world->hero_instances_draw_context);
+
+    for (u32 interaction_index = 0; interaction_index < world->collision_world.InteractionCount; interaction_index++)
+    {
+        collision_damage_draw(&world->collision_world.Interactions[interaction_index].DamageContext, frame_data);
+        collision_damage_stats(&world->collision_world.Interactions[interaction_index].DamageContext);
+    }
+
+    *time_ptr += *time_delta_ptr;
+    (*frame_count_ptr)++;
+}
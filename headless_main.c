@@ -0,0 +1,438 @@
+// Windowless build for Linux: the render side of the frame pipeline is a CPU consumer.
+// Every frame_data slot it gets is checksummed, optionally held for a while in place of present, then checksummed again,
+// so a slot written by the simulation while still being consumed shows up as a torn frame.
+// Input is constant and the time step fixed, the combined checksum must not depend on depth or worker count.
+//
+// With a capture file every consumed frame is recorded (frame_capture.c), then read back and checksummed again,
+// the replayed checksum must match the live one.
+//
+// With an image directory every consumed frame is also drawn by the CPU renderer (cpu_render.c) on a pool of its own,
+// scaled to a screen of the given height, and the last frame is written as diffuse and light PPMs. Pass - to skip the capture file.
+// The distance field of the last frame is then built by cpu_sdf.c a few times for timing and written as the sdf texture PPM.
+//
+// usage: headless_main [frame count] [pipeline depth] [worker count] [present microseconds] [capture file] [image directory] [render screen height]
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "types.h"
+#include "math.h"
+#include "game_world.c"
+#include "frame_pipeline.c"
+#include "frame_capture.c"
+#include "cpu_render.c"
+#include "cpu_sdf.c"
+
+#define kHeadlessScreenWidth  1280
+#define kHeadlessScreenHeight 720
+#define kHeadlessSdfRunCount  8
+
+static void *
+MapPackFile(const char *file_name, u32 *size)
+{
+    int file = open(file_name, O_RDONLY);
+    Assert(file >= 0);
+
+    struct stat file_stat;
+    int stat_result = fstat(file, &file_stat);
+    Assert(stat_result == 0);
+
+    // private mapping is the copy-on-write view the Win32 build gets from FILE_MAP_COPY
+    void *data = mmap(NULL, (size_t)file_stat.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, file, 0);
+    Assert(data != MAP_FAILED);
+
+    close(file);
+
+    *size = (u32)file_stat.st_size;
+    return data;
+}
+
+static void
+ProtectPackFile(PackFile *pack)
+{
+    for (u32 entry_index = 0; entry_index < pack->EntryCount; entry_index++)
+    {
+        PackFileEntry *entry = pack_file_entry_prt(pack, entry_index);
+        if (entry->Permissions == kPackFilePermissionsRead)
+        {
+            int protect_result = mprotect((u8 *)pack + entry->Offset, entry->InstanceStride * entry->InstanceCount, PROT_READ);
+            Assert(protect_result == 0);
+        }
+    }
+}
+
+static u64
+checksum_bytes(u64 checksum, void *data, u32 size)
+{
+    // FNV-1a
+    u8 *bytes = (u8 *)data;
+    for (u32 byte_index = 0; byte_index < size; byte_index++)
+    {
+        checksum ^= bytes[byte_index];
+        checksum *= 0x100000001b3ULL;
+    }
+    return checksum;
+}
+
+static u64
+checksum_frame(u16 frame_data_count, void *screen_size, void *viewport, void *objects, u32 object_byte_count)
+{
+    u64 checksum = 0xcbf29ce484222325ULL;
+    checksum = checksum_bytes(checksum, &frame_data_count, sizeof(frame_data_count));
+    checksum = checksum_bytes(checksum, screen_size, sizeof(FrameDataScreenSize));
+    checksum = checksum_bytes(checksum, viewport, sizeof(FrameDataViewport));
+    checksum = checksum_bytes(checksum, objects, object_byte_count);
+    return checksum;
+}
+
+// what the renderer reads: screen size, viewport and the live object prefix
+static u64
+consume_frame(FrameData *frame_data)
+{
+    FrameDataObjectStream object_stream = frame_data_object_stream(frame_data);
+
+    return checksum_frame(*FrameDataFrameDataCountPrt(frame_data), FrameDataScreenSizePrt(frame_data), FrameDataViewportPrt(frame_data),
+                          object_stream.Objects, object_stream.ByteCount);
+}
+
+// same combined checksum as the live run, from the records of a capture file
+static u64
+replay_capture(const char *file_name, u32 *replayed_frame_count)
+{
+    u64 checksum          = 0xcbf29ce484222325ULL;
+    *replayed_frame_count = 0;
+
+    FrameCaptureReader reader;
+    if (!frame_capture_reader_open(&reader, file_name))
+    {
+        return checksum;
+    }
+
+    u32 reader_memory_size = frame_capture_reader_memory_size(&reader);
+    void *reader_memory    = mmap(NULL, reader_memory_size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    Assert(reader_memory != MAP_FAILED);
+
+    // a truncated or corrupt capture stops the replay, the frame count then falls short of the live one
+    u32 frame_count = frame_capture_reader_init(&reader, reader_memory) ? reader.Footer.FrameCount : 0;
+
+    for (u32 frame_index = 0; frame_index < frame_count; frame_index++)
+    {
+        FrameCaptureFrame *frame = frame_capture_reader_frame(&reader, frame_index);
+        if (frame == NULL)
+        {
+            break;
+        }
+
+        u64 frame_checksum = checksum_frame(frame->FrameDataCount, &frame->ScreenWidth, frame->Viewport,
+                                            frame + 1, frame->ObjectCount * sizeof(FrameDataObject));
+        checksum = checksum_bytes(checksum, &frame_checksum, sizeof(frame_checksum));
+        (*replayed_frame_count)++;
+    }
+
+    frame_capture_reader_close(&reader);
+    munmap(reader_memory, reader_memory_size);
+
+    return checksum;
+}
+
+// stands in for the renderer mapping its object buffer, copies only the live prefix like win32_d3d11 does
+static u32
+upload_frame(FrameData *frame_data)
+{
+    static FrameDataObject upload_objects[kFrameDataMaxObjectDataCapacity];
+
+    FrameDataObjectStream object_stream = frame_data_object_stream(frame_data);
+    memcpy(upload_objects, object_stream.Objects, object_stream.ByteCount);
+    return object_stream.ByteCount;
+}
+
+int
+main(int argc, char **argv)
+{
+    u32 frame_count      = (argc > 1) ? (u32)atoi(argv[1]) : 3600;
+    u32 depth            = (argc > 2) ? (u32)atoi(argv[2]) : 1;
+    u32 worker_count     = (argc > 3) ? (u32)atoi(argv[3]) : (u32)sysconf(_SC_NPROCESSORS_ONLN) - 1;
+    u32 present_duration = (argc > 4) ? (u32)atoi(argv[4]) : 0;
+    const char *capture_file_name = ((argc > 5) && strcmp(argv[5], "-")) ? argv[5] : NULL;
+    const char *image_directory   = (argc > 6) ? argv[6] : NULL;
+    u32 render_screen_height      = (argc > 7) ? (u32)atoi(argv[7]) : kHeadlessScreenHeight;
+
+    if (depth > kFramePipelineMaxDepth)
+    {
+        fprintf(stderr, "pipeline depth %u is above %u\n", depth, kFramePipelineMaxDepth);
+        return 1;
+    }
+
+    u32 world_pack_size  = 0;
+    PackFile *world_pack = (PackFile *)MapPackFile("world.pack", &world_pack_size);
+
+    Assert(pack_file_valid(world_pack, kWorldPackEntryCount));
+    ProtectPackFile(world_pack);
+
+    u32 template_memory_size = template_registry_memory_size(world_pack, kGameWorldTemplateEntriesMask);
+    void *template_memory    = mmap(NULL, template_memory_size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    Assert(template_memory != MAP_FAILED);
+
+    u32 job_arena_memory_size = job_pool_arena_memory_size(worker_count, kGameWorldJobArenaSize);
+    void *job_arena_memory    = mmap(NULL, job_arena_memory_size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    Assert(job_arena_memory != MAP_FAILED);
+
+    JobPool job_pool;
+    job_pool_init(&job_pool, worker_count, job_arena_memory, kGameWorldJobArenaSize);
+
+    #ifndef NDEBUG
+    static JobPoolCheck job_pool_check;
+    job_pool_self_check(&job_pool, &job_pool_check);
+    #endif
+
+    GameWorld world;
+    game_world_init(&world, world_pack, &job_pool, template_memory, template_memory_size);
+
+    // hero parked in the lower half of the play area, fire lines up with the enemy waves
+    GameInput input     = { 0 };
+    input.screen_width  = kHeadlessScreenWidth;
+    input.screen_height = kHeadlessScreenHeight;
+    input.mouse_x       = kHeadlessScreenWidth * 0.5f;
+    input.mouse_y       = kHeadlessScreenHeight * 0.15f;
+    input.ticks         = platform_ticks();
+
+    FramePipeline frame_pipeline;
+    frame_pipeline_init(&frame_pipeline, &world, depth, 1.0f / 60.0f, &input);
+
+    u64 checksum         = 0xcbf29ce484222325ULL;
+    u32 torn_frame_count = 0;
+    u32 overflow_count   = 0;
+    u64 culled_count     = 0;
+    u64 emitted_count    = 0;
+
+    u64 upload_byte_total = 0;
+    u32 upload_byte_peak  = 0;
+
+    u64 object_total = 0;
+
+    FrameCapture capture;
+    u32 capture_memory_size = frame_capture_memory_size(frame_count);
+    void *capture_memory    = NULL;
+    if (capture_file_name)
+    {
+        capture_memory = mmap(NULL, capture_memory_size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        Assert(capture_memory != MAP_FAILED);
+
+        if (!frame_capture_open(&capture, capture_file_name, frame_count, capture_memory))
+        {
+            fprintf(stderr, "can not create capture file %s\n", capture_file_name);
+            return 1;
+        }
+    }
+
+    // begin_frame viewports scale with the screen, the render screen keeps the headless aspect
+    f32 render_scale = (f32)render_screen_height / kHeadlessScreenHeight;
+
+    static CpuRender render;
+    static CpuSdf sdf;
+    JobPool render_pool;
+    u32 render_arena_memory_size = job_pool_arena_memory_size(worker_count, kCpuRenderJobArenaSize);
+    u32 render_memory_size       = cpu_render_memory_size(kHeadlessScreenWidth * render_scale, kHeadlessScreenHeight * render_scale);
+    u32 sdf_memory_size          = cpu_sdf_memory_size(kHeadlessScreenWidth * render_scale, kHeadlessScreenHeight * render_scale);
+    void *render_arena_memory    = NULL;
+    void *render_memory          = NULL;
+    void *sdf_memory             = NULL;
+    if (image_directory)
+    {
+        render_arena_memory = mmap(NULL, render_arena_memory_size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        render_memory       = mmap(NULL, render_memory_size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        sdf_memory          = mmap(NULL, sdf_memory_size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        Assert((render_arena_memory != MAP_FAILED) && (render_memory != MAP_FAILED) && (sdf_memory != MAP_FAILED));
+
+        job_pool_init(&render_pool, worker_count, render_arena_memory, kCpuRenderJobArenaSize);
+        cpu_render_init(&render, &render_pool, world.materials, world.matrix.forward,
+                        kHeadlessScreenWidth * render_scale, kHeadlessScreenHeight * render_scale, render_memory);
+        cpu_sdf_init(&sdf, &render_pool, kHeadlessScreenWidth * render_scale, kHeadlessScreenHeight * render_scale, sdf_memory);
+    }
+
+    u64 render_ticks        = 0;
+    u64 render_ticks_peak   = 0;
+    u64 image_frame_counter = 0;
+
+    u64 start_ticks = platform_ticks();
+
+    for (u32 frame_index = 0; frame_index < frame_count; frame_index++)
+    {
+        input.ticks = platform_ticks();
+        frame_pipeline_input(&frame_pipeline, &input);
+
+        FrameData *frame_data = frame_pipeline_acquire(&frame_pipeline);
+
+        u64 frame_checksum = consume_frame(frame_data);
+        if (present_duration)
+        {
+            usleep(present_duration);
+        }
+        if (consume_frame(frame_data) != frame_checksum)
+        {
+            torn_frame_count++;
+        }
+
+        overflow_count += *FrameDataOverflowCountPrt(frame_data);
+        culled_count   += FrameDataCullCountsPrt(frame_data)->CulledCount;
+        emitted_count  += FrameDataCullCountsPrt(frame_data)->EmittedCount;
+
+        u32 upload_byte_count = upload_frame(frame_data);
+        upload_byte_total += upload_byte_count;
+        upload_byte_peak   = max(upload_byte_peak, upload_byte_count);
+
+        object_total += frame_data_object_stream(frame_data).ObjectCount;
+
+        if (capture_file_name)
+        {
+            frame_capture_record(&capture, frame_data);
+        }
+
+        if (image_directory)
+        {
+            u64 render_start_ticks = platform_ticks();
+            cpu_render_frame(&render, frame_data, render_scale);
+            u64 frame_render_ticks = platform_ticks() - render_start_ticks;
+
+            render_ticks       += frame_render_ticks;
+            render_ticks_peak   = max(render_ticks_peak, frame_render_ticks);
+            image_frame_counter = FrameDataGameTimePrt(frame_data)->FrameCounter;
+        }
+
+        frame_pipeline_release(&frame_pipeline);
+
+        checksum = checksum_bytes(checksum, &frame_checksum, sizeof(frame_checksum));
+    }
+
+    u64 end_ticks = platform_ticks();
+
+    frame_pipeline_shutdown(&frame_pipeline);
+    job_pool_shutdown(&job_pool);
+
+    FramePipelineLatency *latency = &frame_pipeline.Latency;
+
+    printf("frames %u, depth %u, workers %u, present %u us\n", frame_count, depth, job_pool.WorkerCount, present_duration);
+    printf("checksum %016llx, torn frames %u\n", (unsigned long long)checksum, torn_frame_count);
+    printf("frame_data overflow %u objects\n", overflow_count);
+    printf("play area cull culled %llu, emitted %llu objects\n", (unsigned long long)culled_count, (unsigned long long)emitted_count);
+    printf("object upload avg %llu bytes, peak %u bytes per frame, full capacity %u bytes\n",
+           (unsigned long long)(upload_byte_total / max(frame_count, 1)), upload_byte_peak,
+           (u32)(kFrameDataMaxObjectDataCapacity * sizeof(FrameDataObject)));
+    printf("objects avg %.1f per frame\n", (f64)object_total / max(frame_count, 1));
+
+    u32 job_run_count        = 0;
+    u32 job_steal_count      = 0;
+    u32 job_arena_high_water = 0;
+    for (u32 worker_index = 0; worker_index < job_pool.ThreadCount; worker_index++)
+    {
+        job_run_count       += job_pool.Workers[worker_index].RunCount;
+        job_steal_count     += job_pool.Workers[worker_index].StealCount;
+        job_arena_high_water = max(job_arena_high_water, job_pool.Workers[worker_index].Arena.HighWater);
+    }
+    printf("jobs %u, stolen %u, scratch high water %u bytes\n", job_run_count, job_steal_count, job_arena_high_water);
+
+    CollisionGrid *collision_grids[] = { world.hero_bullets_collision_grid, world.enemy_bullets_collision_grid,
+                                         world.hero_instances_collision_grid, world.enemy_instances_collision_grid };
+    const char *collision_grid_names[] = { "hero bullets", "enemy bullets", "hero", "enemies" };
+    for (u32 grid_index = 0; grid_index < ArrayCount(collision_grids); grid_index++)
+    {
+        CollisionGridChurn *churn = CollisionGridChurnStaticPrt(collision_grids[grid_index]);
+        u32 update_count = churn->IncrementalUpdateCount + churn->FullRebuildCount;
+        printf("grid %-13s incremental %u, rebuilt %u, changed spans avg %.2f\n", collision_grid_names[grid_index],
+               churn->IncrementalUpdateCount, churn->FullRebuildCount, (f32)churn->ChangedInstanceTotal / max(update_count, 1));
+    }
+
+    CollisionDamage *collision_damages[] = { world.enemy_instances_vs_hero_bullets_collision_damage, world.hero_instances_vs_enemy_bullets_collision_damage };
+    const char *collision_damage_names[] = { "enemies/hero bullets", "hero/enemy bullets" };
+    for (u32 damage_index = 0; damage_index < ArrayCount(collision_damages); damage_index++)
+    {
+        CollisionDamageDamageEventStats *damage_event_stats = CollisionDamageDamageEventStatsStaticPrt(collision_damages[damage_index]);
+        CollisionDamageDamageEventLog *damage_event_log     = CollisionDamageDamageEventLogStaticPrt(collision_damages[damage_index]);
+        u32 *partition_hit_overflow_count = CollisionDamagePartitionHitOverflowCountStaticPrt(collision_damages[damage_index])->PartitionHitOverflowCount;
+        u32 hit_overflow_count = 0;
+        for (u32 partition_index = 0; partition_index < kCollisionDamagePartitionCount; partition_index++)
+        {
+            hit_overflow_count += partition_hit_overflow_count[partition_index];
+        }
+        printf("damage %-20s events %u, dropped %u, hit overflow %u\n", collision_damage_names[damage_index], damage_event_stats->EventCount,
+               damage_event_log->DroppedCount, hit_overflow_count);
+    }
+    printf("damage event pages used %u of %u\n", *DamageEventPoolAllocatedPageCountStaticPrt(world.damage_event_pool), kDamageEventPoolPageCount);
+    printf("frame time %.3f ms, input latency avg %.3f ms, max %.3f ms\n",
+           frame_pipeline_ticks_to_ms(&frame_pipeline, end_ticks - start_ticks) / max(frame_count, 1),
+           frame_pipeline_ticks_to_ms(&frame_pipeline, latency->TotalTicks) / max(latency->FrameCount, 1),
+           frame_pipeline_ticks_to_ms(&frame_pipeline, latency->MaxTicks));
+
+    b32 capture_match = 1;
+    if (capture_file_name)
+    {
+        frame_capture_close(&capture);
+
+        u32 replayed_frame_count = 0;
+        u64 replay_checksum      = replay_capture(capture_file_name, &replayed_frame_count);
+        capture_match            = (replay_checksum == checksum) && (replayed_frame_count == frame_count);
+
+        printf("capture %u frames in %u chunks, %llu of %llu bytes, record avg %.3f us, writer stalls %u\n",
+               capture.FrameCount, capture.ChunkCount, (unsigned long long)capture.EncodedTotal, (unsigned long long)capture.RawTotal,
+               frame_pipeline_ticks_to_ms(&frame_pipeline, capture.RecordTicks) * 1000.0f / max(capture.FrameCount, 1), capture.StallCount);
+        printf("capture replay %u frames, checksum %016llx %s\n", replayed_frame_count, (unsigned long long)replay_checksum, capture_match ? "matches" : "differs");
+
+        munmap(capture_memory, capture_memory_size);
+    }
+
+    b32 images_written = 1;
+    if (image_directory)
+    {
+        u64 seed_ticks     = 0;
+        u64 flood_ticks    = 0;
+        u64 distance_ticks = 0;
+        for (u32 run_index = 0; run_index < kHeadlessSdfRunCount; run_index++)
+        {
+            cpu_sdf_build(&sdf, render.Diffuse, render.Width, render.Height);
+            seed_ticks     += sdf.SeedTicks;
+            flood_ticks    += sdf.FloodTicks;
+            distance_ticks += sdf.DistanceTicks;
+        }
+
+        job_pool_shutdown(&render_pool);
+
+        char diffuse_file_name[1024];
+        char light_file_name[1024];
+        char sdf_file_name[1024];
+        snprintf(diffuse_file_name, sizeof(diffuse_file_name), "%s/frame_%06llu_diffuse.ppm", image_directory, (unsigned long long)image_frame_counter);
+        snprintf(light_file_name, sizeof(light_file_name), "%s/frame_%06llu_light.ppm", image_directory, (unsigned long long)image_frame_counter);
+        snprintf(sdf_file_name, sizeof(sdf_file_name), "%s/frame_%06llu_sdf.ppm", image_directory, (unsigned long long)image_frame_counter);
+
+        images_written = cpu_render_write_ppm(&render, kCpuRenderTargetDiffuse, diffuse_file_name) &&
+                         cpu_render_write_ppm(&render, kCpuRenderTargetLight, light_file_name) &&
+                         cpu_sdf_write_ppm(&sdf, sdf_file_name);
+
+        printf("cpu render %dx%d, workers %u, avg %.3f ms, peak %.3f ms per frame\n", render.Width, render.Height, render_pool.WorkerCount,
+               frame_pipeline_ticks_to_ms(&frame_pipeline, render_ticks) / max(frame_count, 1),
+               frame_pipeline_ticks_to_ms(&frame_pipeline, render_ticks_peak));
+        printf("cpu sdf %dx%d, %u passes, seed %.3f ms, flood %.3f ms, distance %.3f ms\n", sdf.Width, sdf.Height, sdf.PassCount,
+               frame_pipeline_ticks_to_ms(&frame_pipeline, seed_ticks) / kHeadlessSdfRunCount,
+               frame_pipeline_ticks_to_ms(&frame_pipeline, flood_ticks) / kHeadlessSdfRunCount,
+               frame_pipeline_ticks_to_ms(&frame_pipeline, distance_ticks) / kHeadlessSdfRunCount);
+        printf("cpu render images %s, %s, %s %s\n", diffuse_file_name, light_file_name, sdf_file_name, images_written ? "written" : "failed");
+
+        munmap(sdf_memory, sdf_memory_size);
+        munmap(render_memory, render_memory_size);
+        munmap(render_arena_memory, render_arena_memory_size);
+    }
+
+    munmap(job_arena_memory, job_arena_memory_size);
+    munmap(template_memory, template_memory_size);
+    munmap(world_pack, world_pack_size);
+
+    return ((torn_frame_count == 0) && capture_match && images_written) ? 0 : 1;
+}
@@ -0,0 +1,522 @@
+// Worker threads with one job queue each, a thread pushes to its own queue and takes newest jobs from it first,
+// idle threads steal oldest jobs from other queues. The waiting thread runs jobs too, so a pool without workers runs everything inline.
+// Every thread owns a bump arena for scratch data, scratch pushed by a job is released when that job returns.
+// Threads outside the pool share the last queue and arena, only one of them may use the pool at a time.
+// A push to a full queue runs the job on the pushing thread instead.
+
+#ifndef __cplusplus
+typedef struct Job            Job;
+typedef struct JobArena       JobArena;
+typedef struct JobParallelFor JobParallelFor;
+typedef struct JobWorker      JobWorker;
+typedef struct JobPool        JobPool;
+#endif
+
+#define kJobPoolMaxWorkers    16
+#define kJobPoolMaxThreads    (kJobPoolMaxWorkers + 1)
+#define kJobPoolQueueCapacity 256
+#define kJobArenaAlign        16
+
+typedef void JobFunction(void *data);
+typedef void JobRangeFunction(void *data, u32 begin, u32 end);
+
+struct JobArena
+{
+    u8 *Base;
+    u32 Size;
+    u32 Used;
+    u32 HighWater;
+};
+
+struct JobParallelFor
+{
+    JobRangeFunction *Function;
+    void *Data;
+    u32 Grain;
+    volatile s32 Remaining;
+};
+
+struct Job
+{
+    JobFunction *Function;
+    void *Data;
+
+    // set for parallel for ranges, Function is unused then
+    JobParallelFor *ParallelFor;
+    u32 Begin;
+    u32 End;
+};
+
+struct JobWorker
+{
+    JobPool *Pool;
+    u32 Index;
+
+    // owner pushes and takes at Bottom, thieves take at Top
+    PlatformMutex Mutex;
+    Job Queue[kJobPoolQueueCapacity];
+    u32 Top;
+    u32 Bottom;
+
+    JobArena Arena;
+
+    u32 RunCount;
+    u32 StealCount;
+
+    PlatformThread Thread;
+};
+
+struct JobPool
+{
+    PlatformMutex Mutex;
+    // signaled when a job is queued to a sleeping pool, a wait counter reaches zero, the pool goes idle under job_pool_wait_idle or the pool quits
+    PlatformCondition Changed;
+    u32 SleepingCount;
+    u32 IdleWaitingCount;
+
+    // jobs pushed and not yet taken, over all queues
+    volatile s32 QueuedCount;
+    // jobs taken and not yet past the arena reset and run count of job_pool_run
+    volatile s32 RunningCount;
+
+    b32 Quit;
+
+    u32 WorkerCount;
+    u32 ThreadCount;
+    JobWorker Workers[kJobPoolMaxThreads];
+};
+
+static platform_thread_local JobWorker *job_pool_current_worker;
+
+static u32
+job_pool_arena_memory_size(u32 worker_count, u32 arena_size)
+{
+    u32 thread_count = min(worker_count, kJobPoolMaxWorkers) + 1;
+    return thread_count * arena_size;
+}
+
+static JobWorker *
+job_pool_worker_self(JobPool *pool)
+{
+    JobWorker *worker = job_pool_current_worker;
+    if (worker && (worker->Pool == pool))
+    {
+        return worker;
+    }
+    return &pool->Workers[pool->WorkerCount];
+}
+
+// returns 0 without queueing when the queue of the calling thread is full
+static b32
+job_pool_push_job(JobPool *pool, Job *job)
+{
+    JobWorker *worker = job_pool_worker_self(pool);
+
+    platform_mutex_lock(&worker->Mutex);
+
+    if ((worker->Bottom - worker->Top) == kJobPoolQueueCapacity)
+    {
+        platform_mutex_unlock(&worker->Mutex);
+        return 0;
+    }
+
+    worker->Queue[worker->Bottom % kJobPoolQueueCapacity] = *job;
+    worker->Bottom++;
+
+    platform_mutex_unlock(&worker->Mutex);
+
+    platform_atomic_increment(&pool->QueuedCount);
+
+    platform_mutex_lock(&pool->Mutex);
+    if (pool->SleepingCount)
+    {
+        platform_condition_broadcast(&pool->Changed);
+    }
+    platform_mutex_unlock(&pool->Mutex);
+
+    return 1;
+}
+
+static void job_pool_run(JobPool *pool, JobWorker *worker, Job *job);
+
+static void
+job_pool_push(JobPool *pool, JobFunction *function, void *data)
+{
+    Job job      = { 0 };
+    job.Function = function;
+    job.Data     = data;
+
+    if (!job_pool_push_job(pool, &job))
+    {
+        platform_atomic_increment(&pool->RunningCount);
+        job_pool_run(pool, job_pool_worker_self(pool), &job);
+    }
+}
+
+static b32
+job_pool_take(JobPool *pool, JobWorker *worker, Job *job)
+{
+    b32 taken = 0;
+
+    platform_mutex_lock(&worker->Mutex);
+    if (worker->Bottom != worker->Top)
+    {
+        worker->Bottom--;
+        *job  = worker->Queue[worker->Bottom % kJobPoolQueueCapacity];
+        taken = 1;
+    }
+    platform_mutex_unlock(&worker->Mutex);
+
+    for (u32 victim_offset = 1; !taken && (victim_offset < pool->ThreadCount); victim_offset++)
+    {
+        JobWorker *victim = &pool->Workers[(worker->Index + victim_offset) % pool->ThreadCount];
+
+        platform_mutex_lock(&victim->Mutex);
+        if (victim->Bottom != victim->Top)
+        {
+            *job  = victim->Queue[victim->Top % kJobPoolQueueCapacity];
+            victim->Top++;
+            taken = 1;
+            worker->StealCount++;
+        }
+        platform_mutex_unlock(&victim->Mutex);
+    }
+
+    // counted as running before it stops counting as queued, so the pool never looks idle in between
+    if (taken)
+    {
+        platform_atomic_increment(&pool->RunningCount);
+        platform_atomic_decrement(&pool->QueuedCount);
+    }
+
+    return taken;
+}
+
+// marks one unit of work done
+static void
+job_pool_finish(JobPool *pool, volatile s32 *counter)
+{
+    s32 remaining = platform_atomic_decrement(counter);
+    Assert(remaining >= 0);
+
+    if (remaining == 0)
+    {
+        platform_mutex_lock(&pool->Mutex);
+        platform_condition_broadcast(&pool->Changed);
+        platform_mutex_unlock(&pool->Mutex);
+    }
+}
+
+static void job_pool_run_range(JobPool *pool, JobParallelFor *parallel_for, u32 begin, u32 end);
+
+// job was counted in RunningCount by job_pool_take or by an inline push
+static void
+job_pool_run(JobPool *pool, JobWorker *worker, Job *job)
+{
+    u32 arena_used = worker->Arena.Used;
+
+    if (job->ParallelFor)
+    {
+        job_pool_run_range(pool, job->ParallelFor, job->Begin, job->End);
+    }
+    else
+    {
+        job->Function(job->Data);
+    }
+
+    worker->Arena.Used = arena_used;
+    worker->RunCount++;
+
+    if (platform_atomic_decrement(&pool->RunningCount) == 0)
+    {
+        platform_mutex_lock(&pool->Mutex);
+        if (pool->IdleWaitingCount)
+        {
+            platform_condition_broadcast(&pool->Changed);
+        }
+        platform_mutex_unlock(&pool->Mutex);
+    }
+}
+
+// splits off upper halves for other threads until the range is one grain, boundaries stay multiples of grain
+static void
+job_pool_run_range(JobPool *pool, JobParallelFor *parallel_for, u32 begin, u32 end)
+{
+    while ((end - begin) > parallel_for->Grain)
+    {
+        u32 grain_count = ((end - begin) + parallel_for->Grain - 1) / parallel_for->Grain;
+        u32 middle      = begin + ((grain_count / 2) * parallel_for->Grain);
+
+        platform_atomic_increment(&parallel_for->Remaining);
+
+        Job job         = { 0 };
+        job.ParallelFor = parallel_for;
+        job.Begin       = middle;
+        job.End         = end;
+        if (!job_pool_push_job(pool, &job))
+        {
+            // queue full, the upper half runs here and still splits at grain boundaries
+            job_pool_run_range(pool, parallel_for, middle, end);
+        }
+
+        end = middle;
+    }
+
+    JobArena *arena = &job_pool_worker_self(pool)->Arena;
+    u32 arena_used  = arena->Used;
+
+    parallel_for->Function(parallel_for->Data, begin, end);
+
+    arena->Used = arena_used;
+    job_pool_finish(pool, &parallel_for->Remaining);
+}
+
+// runs queued jobs on the calling thread until counter drops to zero
+static void
+job_pool_wait(JobPool *pool, volatile s32 *counter)
+{
+    JobWorker *worker = job_pool_worker_self(pool);
+
+    while (platform_atomic_load(counter))
+    {
+        Job job;
+        if (job_pool_take(pool, worker, &job))
+        {
+            job_pool_run(pool, worker, &job);
+            continue;
+        }
+
+        platform_mutex_lock(&pool->Mutex);
+        pool->SleepingCount++;
+        while (platform_atomic_load(counter) && (platform_atomic_load(&pool->QueuedCount) == 0))
+        {
+            platform_condition_wait(&pool->Changed, &pool->Mutex);
+        }
+        pool->SleepingCount--;
+        platform_mutex_unlock(&pool->Mutex);
+    }
+}
+
+// calls function over [0, count) in ranges of grain indices, returns when every range is done
+// the calling thread runs the first range and helps with the rest
+static void
+job_pool_parallel_for(JobPool *pool, u32 count, u32 grain, JobRangeFunction *function, void *data)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    JobParallelFor parallel_for;
+    parallel_for.Function  = function;
+    parallel_for.Data      = data;
+    parallel_for.Grain     = max(grain, 1);
+    parallel_for.Remaining = 1;
+
+    job_pool_run_range(pool, &parallel_for, 0, count);
+    job_pool_wait(pool, &parallel_for.Remaining);
+}
+
+// runs queued jobs on the calling thread until no job is queued or running,
+// worker arenas and counters are safe to read once it returns
+static void
+job_pool_wait_idle(JobPool *pool)
+{
+    JobWorker *worker = job_pool_worker_self(pool);
+
+    while (platform_atomic_load(&pool->QueuedCount) || platform_atomic_load(&pool->RunningCount))
+    {
+        Job job;
+        if (job_pool_take(pool, worker, &job))
+        {
+            job_pool_run(pool, worker, &job);
+            continue;
+        }
+
+        platform_mutex_lock(&pool->Mutex);
+        pool->SleepingCount++;
+        pool->IdleWaitingCount++;
+        while (platform_atomic_load(&pool->RunningCount) && (platform_atomic_load(&pool->QueuedCount) <= 0))
+        {
+            platform_condition_wait(&pool->Changed, &pool->Mutex);
+        }
+        pool->IdleWaitingCount--;
+        pool->SleepingCount--;
+        platform_mutex_unlock(&pool->Mutex);
+    }
+}
+
+// scratch memory of the calling thread, valid until the job that pushed it returns
+static void *
+job_pool_scratch_push(JobPool *pool, u32 size)
+{
+    JobArena *arena = &job_pool_worker_self(pool)->Arena;
+
+    u32 offset = (arena->Used + (kJobArenaAlign - 1)) & ~(kJobArenaAlign - 1);
+    Assert((offset + size) <= arena->Size);
+
+    arena->Used      = offset + size;
+    arena->HighWater = max(arena->HighWater, arena->Used);
+
+    return arena->Base + offset;
+}
+
+static void
+job_pool_worker_loop(JobPool *pool, JobWorker *worker)
+{
+    for (;;)
+    {
+        Job job;
+        if (job_pool_take(pool, worker, &job))
+        {
+            job_pool_run(pool, worker, &job);
+            continue;
+        }
+
+        platform_mutex_lock(&pool->Mutex);
+        if (pool->Quit)
+        {
+            platform_mutex_unlock(&pool->Mutex);
+            break;
+        }
+        pool->SleepingCount++;
+        while (!pool->Quit && (platform_atomic_load(&pool->QueuedCount) == 0))
+        {
+            platform_condition_wait(&pool->Changed, &pool->Mutex);
+        }
+        pool->SleepingCount--;
+        platform_mutex_unlock(&pool->Mutex);
+    }
+}
+
+static void
+job_pool_worker(void *parameter)
+{
+    JobWorker *worker       = (JobWorker *)parameter;
+    job_pool_current_worker = worker;
+    job_pool_worker_loop(worker->Pool, worker);
+}
+
+// arena_memory holds job_pool_arena_memory_size(worker_count, arena_size) bytes
+static void
+job_pool_init(JobPool *pool, u32 worker_count, void *arena_memory, u32 arena_size)
+{
+    memset(pool, 0, sizeof(JobPool));
+
+    platform_mutex_init(&pool->Mutex);
+    platform_condition_init(&pool->Changed);
+
+    pool->WorkerCount = min(worker_count, kJobPoolMaxWorkers);
+    pool->ThreadCount = pool->WorkerCount + 1;
+
+    for (u32 worker_index = 0; worker_index < pool->ThreadCount; worker_index++)
+    {
+        JobWorker *worker = &pool->Workers[worker_index];
+        worker->Pool       = pool;
+        worker->Index      = worker_index;
+        worker->Arena.Base = (u8 *)arena_memory + (worker_index * arena_size);
+        worker->Arena.Size = arena_size;
+        platform_mutex_init(&worker->Mutex);
+    }
+
+    for (u32 worker_index = 0; worker_index < pool->WorkerCount; worker_index++)
+    {
+        platform_thread_create(&pool->Workers[worker_index].Thread, job_pool_worker, &pool->Workers[worker_index]);
+    }
+}
+
+static void
+job_pool_shutdown(JobPool *pool)
+{
+    platform_mutex_lock(&pool->Mutex);
+    pool->Quit = 1;
+    platform_condition_broadcast(&pool->Changed);
+    platform_mutex_unlock(&pool->Mutex);
+
+    for (u32 worker_index = 0; worker_index < pool->WorkerCount; worker_index++)
+    {
+        platform_thread_join(&pool->Workers[worker_index].Thread);
+    }
+}
+
+#ifndef NDEBUG
+#ifndef __cplusplus
+typedef struct JobPoolCheck JobPoolCheck;
+#endif
+
+#define kJobPoolCheckIndexCount 4096
+
+struct JobPoolCheck
+{
+    JobPool *Pool;
+    u32 Grain;
+    volatile s32 Visits[kJobPoolCheckIndexCount];
+};
+
+static void
+job_pool_check_inner(void *data, u32 begin, u32 end)
+{
+    JobPoolCheck *check = (JobPoolCheck *)data;
+
+    Assert(((begin % check->Grain) == 0) && (begin < end) && (end <= kJobPoolCheckIndexCount));
+
+    for (u32 index = begin; index < end; index++)
+    {
+        platform_atomic_increment(&check->Visits[index]);
+    }
+}
+
+static void
+job_pool_check_outer(void *data, u32 begin, u32 end)
+{
+    JobPoolCheck *check = (JobPoolCheck *)data;
+
+    // scratch of a range must survive the nested parallel for, which pushes and pops its own scratch on this thread
+    u32 *scratch = (u32 *)job_pool_scratch_push(check->Pool, 64 * sizeof(u32));
+    for (u32 scratch_index = 0; scratch_index < 64; scratch_index++)
+    {
+        scratch[scratch_index] = begin + scratch_index;
+    }
+
+    for (u32 outer_index = begin; outer_index < end; outer_index++)
+    {
+        job_pool_parallel_for(check->Pool, kJobPoolCheckIndexCount, check->Grain, job_pool_check_inner, check);
+    }
+
+    for (u32 scratch_index = 0; scratch_index < 64; scratch_index++)
+    {
+        Assert(scratch[scratch_index] == begin + scratch_index);
+    }
+}
+
+// stress check for nested parallel for, grain boundaries and scratch lifetime, every index must be visited once per outer index
+static void
+job_pool_self_check(JobPool *pool, JobPoolCheck *check)
+{
+    static const u32 grains[] = { 1, 3, 64, 1000, kJobPoolCheckIndexCount };
+
+    for (u32 grain_index = 0; grain_index < ArrayCount(grains); grain_index++)
+    {
+        memset(check, 0, sizeof(JobPoolCheck));
+        check->Pool  = pool;
+        check->Grain = grains[grain_index];
+
+        u32 outer_count = 16;
+        job_pool_parallel_for(pool, outer_count, 1, job_pool_check_outer, check);
+
+        for (u32 index = 0; index < kJobPoolCheckIndexCount; index++)
+        {
+            Assert(check->Visits[index] == (s32)outer_count);
+        }
+    }
+
+    // parallel for returns once every range is done, workers may still be in the epilogue of job_pool_run
+    job_pool_wait_idle(pool);
+
+    for (u32 worker_index = 0; worker_index < pool->ThreadCount; worker_index++)
+    {
+        Assert(pool->Workers[worker_index].Arena.Used == 0);
+    }
+    Assert(pool->QueuedCount == 0);
+}
+#endif
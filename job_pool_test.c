@@ -0,0 +1,204 @@
+// Stress test for job_pool.c, built next to the headless executables by build_headless.sh:
+// - many small pushed jobs, more than a queue holds, so full queues run jobs inline
+// - a grain 1 parallel for over many indices, every index must be visited once
+// - a parallel for of one range per thread whose ranges wait for each other, so it only finishes when every worker steals a range
+// - the nested parallel for and scratch check of job_pool_self_check
+// After every case the pool must go idle with empty queues and arenas.
+//
+// usage: job_pool_test [worker count] [round count]
+
+#include <math.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "types.h"
+#include "math.h"
+#include "platform_threads.c"
+#include "job_pool.c"
+
+#define kJobPoolTestArenaSize      (64 * 1024)
+#define kJobPoolTestPushCount      20000
+#define kJobPoolTestIndexCount     (1 << 16)
+#define kJobPoolTestBarrierSeconds 10
+
+#ifndef __cplusplus
+typedef struct JobPoolTest     JobPoolTest;
+typedef struct JobPoolTestPush JobPoolTestPush;
+#endif
+
+struct JobPoolTestPush
+{
+    JobPoolTest *Test;
+    u32 Index;
+};
+
+struct JobPoolTest
+{
+    JobPool *Pool;
+
+    volatile s32 Remaining;
+    JobPoolTestPush Pushes[kJobPoolTestPushCount];
+
+    volatile s32 Visits[kJobPoolTestIndexCount];
+
+    volatile s32 Arrived;
+    b32 BarrierTimedOut;
+};
+
+static void
+job_pool_test_pushed(void *data)
+{
+    JobPoolTestPush *push = (JobPoolTestPush *)data;
+    JobPoolTest *test     = push->Test;
+
+    platform_atomic_increment(&test->Visits[push->Index]);
+    job_pool_finish(test->Pool, &test->Remaining);
+}
+
+static void
+job_pool_test_visit(void *data, u32 begin, u32 end)
+{
+    JobPoolTest *test = (JobPoolTest *)data;
+
+    // scratch must be released when the range returns
+    u32 *scratch = (u32 *)job_pool_scratch_push(test->Pool, 16 * sizeof(u32));
+    scratch[0]   = begin;
+
+    for (u32 index = begin; index < end; index++)
+    {
+        platform_atomic_increment(&test->Visits[index]);
+    }
+
+    Assert(scratch[0] == begin);
+}
+
+static void
+job_pool_test_barrier(void *data, u32 begin, u32 end)
+{
+    JobPoolTest *test = (JobPoolTest *)data;
+
+    platform_atomic_increment(&test->Arrived);
+
+    u64 timeout_ticks = platform_ticks() + (kJobPoolTestBarrierSeconds * platform_ticks_per_second());
+    while (platform_atomic_load(&test->Arrived) < (s32)test->Pool->ThreadCount)
+    {
+        if (platform_ticks() > timeout_ticks)
+        {
+            test->BarrierTimedOut = 1;
+            break;
+        }
+    }
+}
+
+static b32
+job_pool_test_idle(JobPool *pool)
+{
+    job_pool_wait_idle(pool);
+
+    b32 idle = (platform_atomic_load(&pool->QueuedCount) == 0) && (platform_atomic_load(&pool->RunningCount) == 0);
+    for (u32 worker_index = 0; worker_index < pool->ThreadCount; worker_index++)
+    {
+        JobWorker *worker = &pool->Workers[worker_index];
+        idle = idle && (worker->Arena.Used == 0) && (worker->Bottom == worker->Top);
+    }
+    return idle;
+}
+
+static b32
+job_pool_test_visits(JobPoolTest *test, u32 count, s32 expected)
+{
+    for (u32 index = 0; index < count; index++)
+    {
+        if (test->Visits[index] != expected)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static b32
+job_pool_test_report(const char *name, b32 passed)
+{
+    printf("%-14s %s\n", name, passed ? "ok" : "FAILED");
+    return passed;
+}
+
+int
+main(int argument_count, char **arguments)
+{
+    u32 worker_count = (argument_count > 1) ? (u32)atoi(arguments[1]) : 3;
+    u32 round_count  = (argument_count > 2) ? (u32)atoi(arguments[2]) : 4;
+
+    u32 arena_memory_size = job_pool_arena_memory_size(worker_count, kJobPoolTestArenaSize);
+    void *arena_memory    = malloc(arena_memory_size);
+    JobPoolTest *test     = (JobPoolTest *)malloc(sizeof(JobPoolTest));
+    Assert(arena_memory && test);
+
+    JobPool pool;
+    job_pool_init(&pool, worker_count, arena_memory, kJobPoolTestArenaSize);
+
+    b32 passed = 1;
+    for (u32 round_index = 0; round_index < round_count; round_index++)
+    {
+        memset(test, 0, sizeof(JobPoolTest));
+        test->Pool      = &pool;
+        test->Remaining = kJobPoolTestPushCount;
+
+        for (u32 push_index = 0; push_index < kJobPoolTestPushCount; push_index++)
+        {
+            test->Pushes[push_index].Test  = test;
+            test->Pushes[push_index].Index = push_index;
+            job_pool_push(&pool, job_pool_test_pushed, &test->Pushes[push_index]);
+        }
+        job_pool_wait(&pool, &test->Remaining);
+
+        passed &= job_pool_test_report("pushed jobs", job_pool_test_visits(test, kJobPoolTestPushCount, 1) && job_pool_test_idle(&pool));
+
+        memset((void *)test->Visits, 0, sizeof(test->Visits));
+        job_pool_parallel_for(&pool, kJobPoolTestIndexCount, 1, job_pool_test_visit, test);
+
+        passed &= job_pool_test_report("parallel for", job_pool_test_visits(test, kJobPoolTestIndexCount, 1) && job_pool_test_idle(&pool));
+
+        u32 run_counts[kJobPoolMaxThreads];
+        for (u32 worker_index = 0; worker_index < pool.ThreadCount; worker_index++)
+        {
+            run_counts[worker_index] = pool.Workers[worker_index].RunCount;
+        }
+
+        job_pool_parallel_for(&pool, pool.ThreadCount, 1, job_pool_test_barrier, test);
+
+        b32 idle      = job_pool_test_idle(&pool);
+        b32 all_stole = 1;
+        for (u32 worker_index = 0; worker_index < pool.WorkerCount; worker_index++)
+        {
+            all_stole = all_stole && (pool.Workers[worker_index].RunCount > run_counts[worker_index]) && pool.Workers[worker_index].StealCount;
+        }
+
+        passed &= job_pool_test_report("steal barrier", !test->BarrierTimedOut && all_stole && idle);
+
+        #ifndef NDEBUG
+        static JobPoolCheck job_pool_check;
+        job_pool_self_check(&pool, &job_pool_check);
+        passed &= job_pool_test_report("self check", job_pool_test_idle(&pool));
+        #endif
+    }
+
+    u32 run_count   = 0;
+    u32 steal_count = 0;
+    for (u32 worker_index = 0; worker_index < pool.ThreadCount; worker_index++)
+    {
+        run_count   += pool.Workers[worker_index].RunCount;
+        steal_count += pool.Workers[worker_index].StealCount;
+    }
+    printf("workers %u, rounds %u, jobs run %u, stolen %u, %s\n", pool.WorkerCount, round_count, run_count, steal_count, passed ? "passed" : "FAILED");
+
+    job_pool_shutdown(&pool);
+
+    free(test);
+    free(arena_memory);
+
+    return passed ? 0 : 1;
+}
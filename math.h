@@ -3,6 +3,7 @@
 #define kQ4ToFloat 0.0625f
 #define kQ7ToFloat 0.0078125f
 #define kQ8ToFloat 0.00390625f
+#define kFloatToQ8 256.0f
 
 inline v2
 V2(f32 x, f32 y)
@@ -136,6 +137,13 @@ clamp_s32(s32 min, s32 value, s32 Max)
     return result;
 }
 
+// round to nearest, same result on every compiler as long as the float input is the same
+inline s32
+f32_to_q8(f32 value)
+{
+    return (s32)floorf((value * kFloatToQ8) + 0.5f);
+}
+
 inline f32
 clamp(f32 min, f32 value, f32 Max)
 {
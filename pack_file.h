@@ -0,0 +1,79 @@
+#pragma once
+
+// Pack file written by export_pack_binary.js:
+// PackFile header, PackFileEntry directory, then every entry instance on its own pages.
+// The whole file is mapped once copy-on-write, writing into one instance never touches pages of another.
+
+#ifndef __cplusplus
+typedef struct PackFile      PackFile;
+typedef struct PackFileEntry PackFileEntry;
+#endif
+
+#define kPackFileMagic    0x4b434150 // 'PACK'
+#define kPackFileVersion  1
+#define kPackFileNameSize 32
+
+#define kPackFilePermissionsRead          0
+#define kPackFilePermissionsReadWriteCopy 1
+
+#pragma pack(push, 1)
+struct PackFile
+{
+    u32 Magic;
+    u16 Version;
+    u16 EntryCount;
+    u32 PageSize;
+    u32 Size;
+};
+struct PackFileEntry
+{
+    char Name[kPackFileNameSize];
+    u32 Offset;
+    u32 Size;
+    u32 InstanceStride;
+    u16 InstanceCount;
+    u16 Permissions;
+};
+#pragma pack(pop)
+
+static inline b32
+pack_file_valid(PackFile *pack, u32 entry_count)
+{
+    return (pack->Magic == kPackFileMagic) && (pack->Version == kPackFileVersion) && (pack->EntryCount == entry_count);
+}
+
+static inline PackFileEntry *
+pack_file_entry_prt(PackFile *pack, u32 entry_index)
+{
+    Assert(entry_index < pack->EntryCount);
+    return (PackFileEntry *)(pack + 1) + entry_index;
+}
+
+static inline void *
+pack_file_instance_prt(PackFile *pack, u32 entry_index, u32 instance_index)
+{
+    PackFileEntry *entry = pack_file_entry_prt(pack, entry_index);
+    Assert(instance_index < entry->InstanceCount);
+    return (void *)((uintptr_t)pack + entry->Offset + (instance_index * entry->InstanceStride));
+}
+
+#define kPackFileInvalidIndex 0xffffffff
+
+// flat index over all instances of all entries, names the blob an address belongs to
+static inline u32
+pack_file_instance_index(PackFile *pack, void *address)
+{
+    uintptr_t offset = (uintptr_t)address - (uintptr_t)pack;
+
+    u32 result = 0;
+    for (u32 entry_index = 0; entry_index < pack->EntryCount; entry_index++)
+    {
+        PackFileEntry *entry = pack_file_entry_prt(pack, entry_index);
+        if ((offset >= entry->Offset) && (offset < (entry->Offset + (entry->InstanceCount * entry->InstanceStride))))
+        {
+            return result + (u32)((offset - entry->Offset) / entry->InstanceStride);
+        }
+        result += entry->InstanceCount;
+    }
+    return kPackFileInvalidIndex;
+}
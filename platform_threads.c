@@ -0,0 +1,192 @@
+// Threads, locks and clocks shared by the job pool and the frame pipeline, and 64 bit file offsets for frame captures.
+// Win32 and pthread builds expose the same names.
+
+#ifndef __cplusplus
+typedef struct PlatformThread PlatformThread;
+#endif
+
+typedef void PlatformThreadFunction(void *parameter);
+
+#ifdef _WIN32
+
+typedef SRWLOCK            PlatformMutex;
+typedef CONDITION_VARIABLE PlatformCondition;
+
+#define platform_mutex_init(mutex)                 InitializeSRWLock(mutex)
+#define platform_mutex_lock(mutex)                 AcquireSRWLockExclusive(mutex)
+#define platform_mutex_unlock(mutex)               ReleaseSRWLockExclusive(mutex)
+#define platform_condition_init(condition)         InitializeConditionVariable(condition)
+#define platform_condition_wait(condition, mutex)  SleepConditionVariableSRW(condition, mutex, INFINITE, 0)
+#define platform_condition_broadcast(condition)    WakeAllConditionVariable(condition)
+
+// fseek takes a long offset, which stays 32 bits on Win64
+#define platform_file_seek(file, offset, origin)   _fseeki64(file, (s64)(offset), origin)
+#define platform_file_tell(file)                   ((s64)_ftelli64(file))
+
+struct PlatformThread
+{
+    HANDLE Handle;
+    PlatformThreadFunction *Function;
+    void *Parameter;
+};
+
+#define platform_thread_local __declspec(thread)
+
+static inline s32
+platform_atomic_increment(volatile s32 *value)
+{
+    return (s32)InterlockedIncrement((volatile LONG *)value);
+}
+
+static inline s32
+platform_atomic_decrement(volatile s32 *value)
+{
+    return (s32)InterlockedDecrement((volatile LONG *)value);
+}
+
+static inline s32
+platform_atomic_load(volatile s32 *value)
+{
+    return (s32)InterlockedCompareExchange((volatile LONG *)value, 0, 0);
+}
+
+// returns the value before the add
+static inline u16
+platform_atomic_fetch_add_u16(volatile u16 *value, u16 add)
+{
+    return (u16)_InterlockedExchangeAdd16((volatile short *)value, (short)add);
+}
+
+static inline u64
+platform_ticks(void)
+{
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (u64)counter.QuadPart;
+}
+
+static inline u64
+platform_ticks_per_second(void)
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    return (u64)frequency.QuadPart;
+}
+
+static DWORD WINAPI
+platform_thread_entry(LPVOID parameter)
+{
+    PlatformThread *thread = (PlatformThread *)parameter;
+    thread->Function(thread->Parameter);
+    return 0;
+}
+
+// thread must stay alive until platform_thread_join
+static void
+platform_thread_create(PlatformThread *thread, PlatformThreadFunction *function, void *parameter)
+{
+    thread->Function  = function;
+    thread->Parameter = parameter;
+    thread->Handle    = CreateThread(NULL, 0, platform_thread_entry, thread, 0, NULL);
+    Assert(thread->Handle != NULL);
+}
+
+static void
+platform_thread_join(PlatformThread *thread)
+{
+    WaitForSingleObject(thread->Handle, INFINITE);
+    CloseHandle(thread->Handle);
+}
+
+#else
+
+#include <pthread.h>
+#include <time.h>
+
+typedef pthread_mutex_t PlatformMutex;
+typedef pthread_cond_t  PlatformCondition;
+
+#define platform_mutex_init(mutex)                 pthread_mutex_init(mutex, NULL)
+#define platform_mutex_lock(mutex)                 pthread_mutex_lock(mutex)
+#define platform_mutex_unlock(mutex)               pthread_mutex_unlock(mutex)
+#define platform_condition_init(condition)         pthread_cond_init(condition, NULL)
+#define platform_condition_wait(condition, mutex)  pthread_cond_wait(condition, mutex)
+#define platform_condition_broadcast(condition)    pthread_cond_broadcast(condition)
+
+#define platform_file_seek(file, offset, origin)   fseeko(file, (off_t)(offset), origin)
+#define platform_file_tell(file)                   ((s64)ftello(file))
+
+struct PlatformThread
+{
+    pthread_t Handle;
+    PlatformThreadFunction *Function;
+    void *Parameter;
+};
+
+#define platform_thread_local __thread
+
+static inline s32
+platform_atomic_increment(volatile s32 *value)
+{
+    return __atomic_add_fetch(value, 1, __ATOMIC_ACQ_REL);
+}
+
+static inline s32
+platform_atomic_decrement(volatile s32 *value)
+{
+    return __atomic_sub_fetch(value, 1, __ATOMIC_ACQ_REL);
+}
+
+static inline s32
+platform_atomic_load(volatile s32 *value)
+{
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+// returns the value before the add
+static inline u16
+platform_atomic_fetch_add_u16(volatile u16 *value, u16 add)
+{
+    return __atomic_fetch_add(value, add, __ATOMIC_ACQ_REL);
+}
+
+static inline u64
+platform_ticks(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((u64)now.tv_sec * 1000000000ULL) + (u64)now.tv_nsec;
+}
+
+static inline u64
+platform_ticks_per_second(void)
+{
+    return 1000000000ULL;
+}
+
+static void *
+platform_thread_entry(void *parameter)
+{
+    PlatformThread *thread = (PlatformThread *)parameter;
+    thread->Function(thread->Parameter);
+    return NULL;
+}
+
+// thread must stay alive until platform_thread_join
+static void
+platform_thread_create(PlatformThread *thread, PlatformThreadFunction *function, void *parameter)
+{
+    thread->Function  = function;
+    thread->Parameter = parameter;
+
+    int result = pthread_create(&thread->Handle, NULL, platform_thread_entry, thread);
+    Assert(result == 0);
+}
+
+static void
+platform_thread_join(PlatformThread *thread)
+{
+    pthread_join(thread->Handle, NULL);
+}
+
+#endif
@@ -0,0 +1,98 @@
+// Pristine images of runtime pack entries, taken right after the pack is mapped.
+// Resetting or stamping out an instance is a single memcpy from its image.
+
+#ifndef __cplusplus
+typedef struct TemplateRegistry      TemplateRegistry;
+typedef struct TemplateRegistryImage TemplateRegistryImage;
+#endif
+
+#define kTemplateRegistryImageAlign 64
+
+struct TemplateRegistryImage
+{
+    u8 *Data;
+    u32 Size;
+};
+
+struct TemplateRegistry
+{
+    PackFile *Pack;
+    u64 EntriesMask;
+    TemplateRegistryImage Images[kWorldPackEntryCount];
+};
+
+static u32
+template_registry_memory_size(PackFile *pack, u64 entries_mask)
+{
+    u32 result = 0;
+    for (u32 entry_index = 0; entry_index < pack->EntryCount; entry_index++)
+    {
+        if ((entries_mask & (1ULL << entry_index)) == 0)
+        {
+            continue;
+        }
+
+        PackFileEntry *entry = pack_file_entry_prt(pack, entry_index);
+        result += (entry->Size + (kTemplateRegistryImageAlign - 1)) & ~(kTemplateRegistryImageAlign - 1);
+    }
+    return result;
+}
+
+static void
+template_registry_init(TemplateRegistry *registry, PackFile *pack, u64 entries_mask, void *memory, u32 memory_size)
+{
+    Assert(pack->EntryCount <= 64);
+    Assert(template_registry_memory_size(pack, entries_mask) <= memory_size);
+
+    memset(registry, 0, sizeof(TemplateRegistry));
+    registry->Pack        = pack;
+    registry->EntriesMask = entries_mask;
+
+    u8 *image_data = (u8 *)memory;
+    for (u32 entry_index = 0; entry_index < pack->EntryCount; entry_index++)
+    {
+        if ((entries_mask & (1ULL << entry_index)) == 0)
+        {
+            continue;
+        }
+
+        PackFileEntry *entry = pack_file_entry_prt(pack, entry_index);
+        Assert(entry->Permissions == kPackFilePermissionsReadWriteCopy);
+
+        // must run before systems touch the pack, every instance is still the exported image
+        memcpy(image_data, pack_file_instance_prt(pack, entry_index, 0), entry->Size);
+
+        registry->Images[entry_index].Data = image_data;
+        registry->Images[entry_index].Size = entry->Size;
+
+        image_data += (entry->Size + (kTemplateRegistryImageAlign - 1)) & ~(kTemplateRegistryImageAlign - 1);
+    }
+}
+
+static void
+template_registry_stamp(TemplateRegistry *registry, u32 entry_index, void *instance)
+{
+    TemplateRegistryImage *image = &registry->Images[entry_index];
+    Assert(image->Data);
+
+    memcpy(instance, image->Data, image->Size);
+}
+
+static void
+template_registry_reset(TemplateRegistry *registry)
+{
+    PackFile *pack = registry->Pack;
+    for (u32 entry_index = 0; entry_index < pack->EntryCount; entry_index++)
+    {
+        if ((registry->EntriesMask & (1ULL << entry_index)) == 0)
+        {
+            continue;
+        }
+
+        PackFileEntry *entry = pack_file_entry_prt(pack, entry_index);
+        for (u32 instance_index = 0; instance_index < entry->InstanceCount; instance_index++)
+        {
+            template_registry_stamp(registry, entry_index, pack_file_instance_prt(pack, entry_index, instance_index));
+        }
+    }
+}
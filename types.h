@@ -54,5 +54,23 @@ struct m4x4_inv
 
 #define ArrayCount(Array) (sizeof(Array) / sizeof((Array)[0]))
 
+#ifdef _MSC_VER
 #include <intrin.h>
-#define Assert(cond) do { if (!(cond)) __debugbreak(); } while (0)
\ No newline at end of file
+#define Assert(cond) do { if (!(cond)) __debugbreak(); } while (0)
+#else
+#define Assert(cond) do { if (!(cond)) __builtin_trap(); } while (0)
+#endif
+
+#ifdef _MSC_VER
+#define PopCount64(value) ((u32)__popcnt64(value))
+#else
+#define PopCount64(value) ((u32)__builtin_popcountll(value))
+#endif
+
+// windows.h brings its own
+#ifndef min
+#define min(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+#ifndef max
+#define max(a, b) (((a) > (b)) ? (a) : (b))
+#endif
\ No newline at end of file
@@ -1,3 +1,19 @@
+// starts the wave at the current index: the reset bit is seen by the play clock,
+// the wave event by enemy_instances_update, which is the only consumer of the ring
+static void
+wave_update_reset(WaveUpdate *wave_update)
+{
+    u32 *wave_state_ptr = WaveUpdateStatePrt(wave_update);
+    *wave_state_ptr = (*wave_state_ptr & ~kWaveUpdateStateSpawnedAll) | kWaveUpdateStateReset;
+
+    // one event per frame at most and it is consumed in the same frame, a full ring is a bug
+    u32 row_index = WaveUpdateWaveEventsRingReserve(wave_update);
+    Assert(row_index != kSpscRingFull);
+
+    *WaveUpdateWaveEventsWaveIndexAt(wave_update, WaveUpdateWaveEventsPrt(wave_update), row_index) = *WaveUpdateIndexPrt(wave_update);
+    WaveUpdateWaveEventsRingPublish(wave_update);
+}
+
 static void
 wave_update(WaveUpdateContext *context)
 {
@@ -14,21 +30,33 @@ wave_update(WaveUpdateContext *context)
     f32 *wave_time_ptr  = WaveUpdateTimePrt(wave_update);
     u32 *wave_state_ptr = WaveUpdateStatePrt(wave_update);
 
-    u64 enemy_instances_live       = *EnemyInstancesInstancesLivePrt(enemy_instances);
-    u32 enemy_instances_wave_state = *EnemyInstancesWaveStatePrt(enemy_instances);
+    u64 enemy_instances_live = *EnemyInstancesInstancesLivePrt(enemy_instances);
+
+    // enemy_instances_update publishes once a wave has spawned all its enemies, events of the previous frame are consumed before any reset
+    EnemyInstancesSpawnEvents *spawn_events_sheet = EnemyInstancesSpawnEventsPrt(enemy_instances);
+    u32 spawn_event_count = EnemyInstancesSpawnEventsRingAvailable(enemy_instances);
+    for (u32 event_index = 0; event_index < spawn_event_count; event_index++)
+    {
+        u32 row_index = EnemyInstancesSpawnEventsRingPeek(enemy_instances, event_index);
+        if (*EnemyInstancesSpawnEventsWaveIndexAt(enemy_instances, spawn_events_sheet, row_index) == *wave_index_ptr)
+        {
+            *wave_state_ptr |= kWaveUpdateStateSpawnedAll;
+        }
+    }
+    EnemyInstancesSpawnEventsRingConsume(enemy_instances, spawn_event_count);
 
     if (level_state_state & kLevelUpdateStateReset)
     {
         *wave_index_ptr = 0;
         *wave_time_ptr  = 0.0f;
-        *wave_state_ptr |= kWaveUpdateStateReset;
+        wave_update_reset(wave_update);
         return;
     }
 
     *wave_time_ptr += time_delta;
     *wave_state_ptr &= ~kWaveUpdateStateReset;
 
-    if ((enemy_instances_wave_state & kEnemyInstancesWaveSpawnedAll) == 0)
+    if ((*wave_state_ptr & kWaveUpdateStateSpawnedAll) == 0)
     {
         return;
     }
@@ -40,5 +68,5 @@ wave_update(WaveUpdateContext *context)
 
     (*wave_index_ptr)++;
     *wave_time_ptr = 0.0f;
-    *wave_state_ptr |= kWaveUpdateStateReset;
+    wave_update_reset(wave_update);
 }
\ No newline at end of file
@@ -46,6 +46,85 @@ struct PixelTextureResource
 
 #define kMaxConstantBufferSlotCounts (D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT - 1)
 #define kMaxPixelTextureResourceSlotCounts (D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT - 1)
+#define kMaxVertexShaderResourceSlotCounts (D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT - 1)
+
+// a constant buffer holds at most 4096 16-byte elements and the header takes one of them, packed objects fit two to an element,
+// a frame_data capacity above that binds the objects as a structured buffer and keeps only the header in b1
+#if kFrameDataObjectFormat == kFrameDataObjectFormatPacked
+#define kObjectConstantBufferElementObjectCount 2
+#else
+#define kObjectConstantBufferElementObjectCount 1
+#endif
+#define kObjectConstantBufferMaxObjectCount ((D3D11_REQ_CONSTANT_BUFFER_ELEMENT_COUNT - 1) * kObjectConstantBufferElementObjectCount)
+#if kFrameDataMaxObjectDataCapacity > kObjectConstantBufferMaxObjectCount
+#define OBJECT_STRUCTURED_BUFFER 1
+#endif
+
+#define OBJECT_HEADER_HLSL                                                  \
+            "cbuffer cbuffer2 : register(b1)                            \n" \
+            "{                                                          \n" \
+            "  uint count;                                              \n" \
+            "  uint3 padding;                                           \n"
+
+// declares the object buffer and load_object(index), packed objects are decoded here
+#if kFrameDataObjectFormat == kFrameDataObjectFormatPacked
+#ifdef OBJECT_STRUCTURED_BUFFER
+#define OBJECT_LOAD_HLSL                                                    \
+            OBJECT_HEADER_HLSL                                              \
+            "}                                                          \n" \
+            "                                                           \n" \
+            "StructuredBuffer<uint2> objects : register(t0);            \n" \
+            "                                                           \n" \
+            "uint2 load_packed_object(uint index)                       \n" \
+            "{                                                          \n" \
+            "  return objects[index];                                   \n" \
+            "}                                                          \n"
+#else
+#define OBJECT_LOAD_HLSL                                                    \
+            OBJECT_HEADER_HLSL                                              \
+            "  uint4 objects[(" STR(kFrameDataMaxObjectDataCapacity) " + 1) / 2]; \n" \
+            "}                                                          \n" \
+            "                                                           \n" \
+            "uint2 load_packed_object(uint index)                       \n" \
+            "{                                                          \n" \
+            "  uint4 pair = objects[index >> 1];                        \n" \
+            "  return (index & 1) ? pair.zw : pair.xy;                  \n" \
+            "}                                                          \n"
+#endif
+#define OBJECT_BUFFER_HLSL                                                  \
+            OBJECT_LOAD_HLSL                                                \
+            "                                                           \n" \
+            "ObjectData load_object(uint index)                         \n" \
+            "{                                                          \n" \
+            "  uint2 packed = load_packed_object(index);                \n" \
+            "  ObjectData object_data;                                  \n" \
+            "  object_data.pos_and_scale.x = (float)((int)(packed.x << 16) >> 16) / " STR(kFrameDataPackedPositionScale) ".0; \n" \
+            "  object_data.pos_and_scale.y = (float)((int)packed.x >> 16) / " STR(kFrameDataPackedPositionScale) ".0; \n" \
+            "  object_data.pos_and_scale.z = (float)(packed.y & 0xffff) / " STR(kFrameDataPackedRadiusScale) ".0; \n" \
+            "  object_data.material_index = packed.y >> 16;             \n" \
+            "  return object_data;                                      \n" \
+            "}                                                          \n"
+#else
+#ifdef OBJECT_STRUCTURED_BUFFER
+#define OBJECT_LOAD_HLSL                                                    \
+            OBJECT_HEADER_HLSL                                              \
+            "}                                                          \n" \
+            "                                                           \n" \
+            "StructuredBuffer<ObjectData> objects : register(t0);       \n"
+#else
+#define OBJECT_LOAD_HLSL                                                    \
+            OBJECT_HEADER_HLSL                                              \
+            "  ObjectData objects[" STR(kFrameDataMaxObjectDataCapacity) "];      \n" \
+            "}                                                          \n"
+#endif
+#define OBJECT_BUFFER_HLSL                                                  \
+            OBJECT_LOAD_HLSL                                                \
+            "                                                           \n" \
+            "ObjectData load_object(uint index)                         \n" \
+            "{                                                          \n" \
+            "  return objects[index];                                   \n" \
+            "}                                                          \n"
+#endif
 
 #define kMaxRadianceCascades 10
 
@@ -82,6 +161,9 @@ struct RenderPipelineDescription
     ID3D11Buffer *pixel_constant_buffers[kMaxConstantBufferSlotCounts];
     u32 pixel_constant_buffers_count;
 
+    ID3D11ShaderResourceView *vertex_shader_resources[kMaxVertexShaderResourceSlotCounts];
+    u32 vertex_shader_resource_count;
+
     ID3D11VertexShader *vshader;
 
     PixelTextureResource pixel_texture_resources[kMaxPixelTextureResourceSlotCounts];
@@ -97,6 +179,8 @@ struct DirectX11State
     IDXGISwapChain1 *swap_chain;
 
     ID3D11Buffer *objects_constant_buffer;
+    ID3D11Buffer *objects_structured_buffer;
+    ID3D11ShaderResourceView *objects_structured_view;
 
     ID3D11Buffer *radiance_constant_buffer[kMaxRadianceCascades];
     u8 radiance_constant_buffer_count;
@@ -1053,6 +1137,7 @@ CreateMainPipeline(ID3D11Device* device,
                    ID3D11Buffer* vbuffer,
                    ID3D11Buffer* transform_constant_buffer,
                    ID3D11Buffer* objects_constant_buffer,
+                   ID3D11ShaderResourceView* objects_structured_view,
                    ID3D11Buffer* materials_buffer)
 {
     HRESULT hr;
@@ -1119,12 +1204,7 @@ CreateMainPipeline(ID3D11Device* device,
             "  uint material_index;                                     \n"
             "};                                                         \n"
             "                                                           \n"
-            "cbuffer cbuffer2 : register(b1)                            \n" // b1 = constant buffer bound to slot 1
-            "{                                                          \n"
-            "  uint count;                                              \n"
-            "  uint3 padding;                                           \n"
-            "  ObjectData objects[" STR(kFrameDataMaxObjectDataCapacity) "];      \n"
-            "}                                                          \n"
+            OBJECT_BUFFER_HLSL                                               // b1 = object count, objects in b1 or t0
             "                                                           \n"
             "struct MaterialData                                        \n"
             "{                                                          \n"
@@ -1145,7 +1225,7 @@ CreateMainPipeline(ID3D11Device* device,
             "PS_INPUT vs(VS_INPUT input)                                \n"
             "{                                                          \n"
             "  PS_INPUT output;                                         \n"
-            "  ObjectData object_data = objects[input.instanceID];      \n"
+            "  ObjectData object_data = load_object(input.instanceID);  \n"
             "  float2 position = input.pos * object_data.pos_and_scale.z; \n"
             "  position += object_data.pos_and_scale.xy;                \n"
             "                                                           \n"
@@ -1217,6 +1297,8 @@ CreateMainPipeline(ID3D11Device* device,
     result.vertex_constant_buffers[0] = transform_constant_buffer;
     result.vertex_constant_buffers[1] = objects_constant_buffer;
     result.vertex_constant_buffers[2] = materials_buffer;
+    result.vertex_shader_resource_count = objects_structured_view ? 1 : 0;
+    result.vertex_shader_resources[0] = objects_structured_view;
     result.pixel_texture_resource_count = 0;
     return result;
 }
@@ -1359,10 +1441,18 @@ InitDirectX11(DirectX11State *state, HWND window, m4x4 projection_martix, Materi
     }
 
     ID3D11Buffer* object_buffer;
+    ID3D11Buffer* object_structured_buffer = NULL;
+    ID3D11ShaderResourceView* object_structured_view = NULL;
     {
+        #ifdef OBJECT_STRUCTURED_BUFFER
+        u32 object_buffer_object_capacity = 0;
+        #else
+        u32 object_buffer_object_capacity = kFrameDataMaxObjectDataCapacity;
+        #endif
+
         D3D11_BUFFER_DESC desc =
         {
-            .ByteWidth = sizeof(ObjectBufferHeader) + (sizeof(FrameDataFrameDataObjectData) * kFrameDataMaxObjectDataCapacity),
+            .ByteWidth = sizeof(ObjectBufferHeader) + (((sizeof(FrameDataObject) * object_buffer_object_capacity) + 15) & ~15),
             .Usage = D3D11_USAGE_DYNAMIC,
             .BindFlags = D3D11_BIND_CONSTANT_BUFFER,
             .CPUAccessFlags = D3D11_CPU_ACCESS_WRITE,
@@ -1371,6 +1461,32 @@ InitDirectX11(DirectX11State *state, HWND window, m4x4 projection_martix, Materi
         ID3D11Device_CreateBuffer(device, &desc, NULL, &object_buffer);
     }
 
+    #ifdef OBJECT_STRUCTURED_BUFFER
+    {
+        D3D11_BUFFER_DESC desc =
+        {
+            .ByteWidth = sizeof(FrameDataObject) * kFrameDataMaxObjectDataCapacity,
+            .Usage = D3D11_USAGE_DYNAMIC,
+            .BindFlags = D3D11_BIND_SHADER_RESOURCE,
+            .CPUAccessFlags = D3D11_CPU_ACCESS_WRITE,
+            .MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED,
+            .StructureByteStride = sizeof(FrameDataObject),
+        };
+
+        ID3D11Device_CreateBuffer(device, &desc, NULL, &object_structured_buffer);
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC view_desc =
+        {
+            .Format = DXGI_FORMAT_UNKNOWN,
+            .ViewDimension = D3D11_SRV_DIMENSION_BUFFER,
+            .Buffer.FirstElement = 0,
+            .Buffer.NumElements = kFrameDataMaxObjectDataCapacity,
+        };
+
+        ID3D11Device_CreateShaderResourceView(device, (ID3D11Resource*)object_structured_buffer, &view_desc, &object_structured_view);
+    }
+    #endif
+
     for (u8 i = 0; i < ArrayCount(state->radiance_constant_buffer); i++)
     {
         D3D11_BUFFER_DESC desc =
@@ -1559,7 +1675,7 @@ InitDirectX11(DirectX11State *state, HWND window, m4x4 projection_martix, Materi
         ID3D11Device_CreateBuffer(device, &desc, &initial, &vbuffer);
     }
 
-    RenderPipelineDescription main_render_pipeline = CreateMainPipeline(device, vbuffer, transform_constant_buffer, object_buffer, materials_constant_buffer);
+    RenderPipelineDescription main_render_pipeline = CreateMainPipeline(device, vbuffer, transform_constant_buffer, object_buffer, object_structured_view, materials_constant_buffer);
 
     RenderPipelineDescription seed_jump_flood_pipeline = CreateSeedJumpFloodPipeline(device, vbuffer);
     RenderPipelineDescription jump_flood_pipeline = CreateJumpFloodPipeline(device, vbuffer, render_size_constant_buffer, jump_flood_constant_buffer);
@@ -1587,6 +1703,8 @@ InitDirectX11(DirectX11State *state, HWND window, m4x4 projection_martix, Materi
     state->jump_flood_constant_buffer = jump_flood_constant_buffer;
     state->render_size_constant_buffer = render_size_constant_buffer;
     state->objects_constant_buffer  = object_buffer;
+    state->objects_structured_buffer = object_structured_buffer;
+    state->objects_structured_view  = object_structured_view;
 
     state->radiance_constant_buffer_count = 0;
 
@@ -1647,6 +1765,11 @@ DestroyDirectX11(DirectX11State *directx_state)
     ID3D11Device_Release(directx_state->jump_flood_constant_buffer);
     ID3D11Device_Release(directx_state->render_size_constant_buffer);
     ID3D11Device_Release(directx_state->objects_constant_buffer);
+    if (directx_state->objects_structured_buffer)
+    {
+        ID3D11ShaderResourceView_Release(directx_state->objects_structured_view);
+        ID3D11Device_Release(directx_state->objects_structured_buffer);
+    }
 
     for (u8 i = 0; i < ArrayCount(directx_state->radiance_constant_buffer); i++)
     {
@@ -1684,6 +1807,10 @@ BindPineline(ID3D11DeviceContext* context, RenderPipelineDescription *pipeline)
     {
         ID3D11DeviceContext_VSSetConstantBuffers(context, i, 1, &pipeline->vertex_constant_buffers[i]);
     }
+    for (u8 i = 0; i < pipeline->vertex_shader_resource_count; i++)
+    {
+        ID3D11DeviceContext_VSSetShaderResources(context, i, 1, &pipeline->vertex_shader_resources[i]);
+    }
 
     ID3D11DeviceContext_VSSetShader(context, pipeline->vshader, NULL, 0);
 
@@ -1902,15 +2029,11 @@ EndFrameDirectX11(DirectX11State *directx_state, FrameData *frame_data)
     // can render only if window size is non-zero - we must have backbuffer & RenderTarget view created
     if (directx_state->backbuffer_rt_view)
     {
-        FrameDataFrameData* frame_data_sheet = FrameDataFrameDataPrt(frame_data);
-        FrameDataFrameDataObjectData* object_data = FrameDataFrameDataObjectDataPrt(frame_data, frame_data_sheet);
-
-        u32 frame_object_count    = *FrameDataFrameDataCountPrt(frame_data);
-        u32 frame_object_capacity = *FrameDataFrameDataCapacityPrt(frame_data);
+        FrameDataObjectStream object_stream = frame_data_object_stream(frame_data);
 
-        u32 object_count_this_frame = min(frame_object_count, frame_object_capacity);
+        u32 object_count_this_frame = object_stream.ObjectCount;
 
-        // upload data to gpu
+        // upload data to gpu, only the live prefix, shader never reads past count
         {
             // setup object data in uniform		
             D3D11_MAPPED_SUBRESOURCE mapped;
@@ -1920,8 +2043,19 @@ EndFrameDirectX11(DirectX11State *directx_state, FrameData *frame_data)
             header.frame_object_count = object_count_this_frame;
 
             memcpy(mapped.pData, &header, sizeof(ObjectBufferHeader));
-            memcpy((u8 *)mapped.pData + sizeof(ObjectBufferHeader), object_data, sizeof(FrameDataFrameDataObjectData) * kFrameDataMaxObjectDataCapacity);
+            #ifndef OBJECT_STRUCTURED_BUFFER
+            memcpy((u8 *)mapped.pData + sizeof(ObjectBufferHeader), object_stream.Objects, object_stream.ByteCount);
+            #endif
             ID3D11DeviceContext_Unmap(directx_state->context, (ID3D11Resource*)directx_state->objects_constant_buffer, 0);
+
+            #ifdef OBJECT_STRUCTURED_BUFFER
+            if (object_stream.ByteCount > 0)
+            {
+                ID3D11DeviceContext_Map(directx_state->context, (ID3D11Resource*)directx_state->objects_structured_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+                memcpy(mapped.pData, object_stream.Objects, object_stream.ByteCount);
+                ID3D11DeviceContext_Unmap(directx_state->context, (ID3D11Resource*)directx_state->objects_structured_buffer, 0);
+            }
+            #endif
         }
 
         D3D11_VIEWPORT game_viewport =
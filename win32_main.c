@@ -1,4 +1,5 @@
 #define COBJMACROS
+#define _CRT_SECURE_NO_WARNINGS
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 
@@ -6,6 +7,7 @@
 #include <math.h>
 #include <string.h>
 #include <stddef.h>
+#include <stdio.h>
 
 #pragma comment (lib, "gdi32")
 #pragma comment (lib, "user32")
@@ -19,48 +21,12 @@
 
 #include "types.h"
 #include "math.h"
+#include "game_world.c"
+#include "frame_pipeline.c"
+#include "frame_capture.c"
 
-#include "game_state.h"
-#include "level_update.h"
-#include "wave_update.h"
-
-#include "play_clock.h"
-
-#include "play_area.h"
-#include "frame_data.h"
-#include "materials.h"
-
-#include "enemy_instances.h"
-#include "enemy_instances_wave.h"
-#include "hero_instances.h"
-
-#include "bullets.h"
-#include "bullets_update.h"
-#include "bullets_draw.h"
-#include "bullet_source_instances.h"
-
-#include "enemy_instances_draw.h"
-#include "hero_instances_draw.h"
-
-#include "collision_grid.h"
-#include "collision_source_instances.h"
-#include "collision_instances_damage.h"
-#include "collision_source_radius.h"
-#include "collision_source_damage.h"
-#include "collision_damage.h"
-
-#include "enemy_instances_update.c"
-#include "enemy_instances_draw.c"
-
-#include "hero_instances_update.c"
-#include "hero_instances_draw.c"
-
-#include "bullets_update.c"
-#include "bullets_draw.c"
-#include "level_update.c"
-#include "wave_update.c"
-#include "collision_grid_update.c"
-#include "collision_damage_update.c"
+// C starts and stops recording consumed frames to frame_capture.fdc, one recording holds up to half an hour at 60 Hz
+#define kWin32FrameCaptureMaxFrameCount (30 * 60 * 60)
 
 #define AssertHR(hr) Assert(SUCCEEDED(hr))
 
@@ -174,249 +140,40 @@ CloseMapFile(MapFileData *mapData)
 	CloseHandle(mapData->fileHandle);
 }
 
-void
-begin_frame(FrameData *frame_data, f32 game_aspect, s32 screen_width, s32 screen_height)
-{
-    u16 *frame_data_count_prt   = FrameDataFrameDataCountPrt(frame_data);
-
-    FrameDataViewport *viewport_prt      = FrameDataViewportPrt(frame_data);
-    FrameDataScreenSize *screen_size_prt = FrameDataScreenSizePrt(frame_data);
-
-    screen_size_prt->Width  = screen_width;
-    screen_size_prt->Height = screen_height;
-    *frame_data_count_prt   = 0;
-
-    f32 window_aspect = (f32)screen_size_prt->Width / screen_size_prt->Height;
-
-    if (window_aspect > game_aspect)
-    {
-        viewport_prt->Width  = screen_size_prt->Height * game_aspect;
-        viewport_prt->Height = (f32)screen_size_prt->Height;
-        viewport_prt->X      = (screen_size_prt->Width - viewport_prt->Width) * 0.5f;
-        viewport_prt->Y      = 0.0f;
-    }
-    else
-    {
-        viewport_prt->Width  = (f32)screen_size_prt->Width;
-        viewport_prt->Height = screen_size_prt->Width / game_aspect;
-        viewport_prt->X      = 0.0f;
-        viewport_prt->Y      = (screen_size_prt->Height - viewport_prt->Height) * 0.5f;
-    }
-}
-
-#ifndef NDEBUG
 static void
-collision_grid_print_draw(CollisionGridContext *context_a, CollisionGridContext *context_b)
+ProtectPackFile(PackFile *pack)
 {
-    CollisionGrid *a_collision_grid = context_a->Root;
-
-    CollisionGridGridRowCount *a_collision_grid_row_count = CollisionGridGridRowCountPrt(a_collision_grid);
-    CollisionGridGridRows *a_collision_grid_rows = CollisionGridGridRowsPrt(a_collision_grid);
-
-    CollisionGrid *b_collision_grid = context_b->Root;
-
-    CollisionGridGridRowCount *b_collision_grid_row_count = CollisionGridGridRowCountPrt(b_collision_grid);
-    CollisionGridGridRows *b_collision_grid_rows = CollisionGridGridRowsPrt(b_collision_grid);
-    
-    printf("\033[0;0H");
-
-    for (s32 row_index = 0; row_index < kCollisionGridRowCount; row_index++)
+    // pack is mapped copy-on-write as a whole, read only entries are locked so stray writes fault
+    for (u32 entry_index = 0; entry_index < pack->EntryCount; entry_index++)
     {
-        printf("%02d ", row_index);
-
-        {
-            u8 count = a_collision_grid_row_count->GridRowCount[row_index];
-            if (count > kCollisionGridColCount)
-            {
-                printf("\033[1;31m");
-            }
-            else
-            {
-                printf("\033[34m");
-            }
-            printf("%02x ", count);
-
-            printf("\033[32m");
-            s32 col_index = 0;
-            for (; col_index < count; col_index++)
-            {
-                u8 source_index = a_collision_grid_rows->GridRows[(row_index * kCollisionGridColCount) + col_index];
-                printf("%02x ", source_index);
-            }
-            printf("\033[37m");
-            for (; col_index < kCollisionGridColCount; col_index++)
-            {
-                u8 source_index = a_collision_grid_rows->GridRows[(row_index * kCollisionGridColCount) + col_index];
-                printf("%02x ", source_index);
-            }
-        }
-
-        printf("  ");
-
+        PackFileEntry *entry = pack_file_entry_prt(pack, entry_index);
+        if (entry->Permissions == kPackFilePermissionsRead)
         {
-            u8 count = b_collision_grid_row_count->GridRowCount[row_index];
-            if (count > kCollisionGridColCount)
-            {
-                printf("\033[1;31m");
-            }
-            else
-            {
-                printf("\033[34m");
-            }
-            printf("%02x ", count);
-
-            printf("\033[32m");
-            s32 col_index = 0;
-            for (; col_index < count; col_index++)
-            {
-                u8 source_index = b_collision_grid_rows->GridRows[(row_index * kCollisionGridColCount) + col_index];
-                printf("%02x ", source_index);
-            }
-            printf("\033[37m");
-            for (; col_index < kCollisionGridColCount; col_index++)
-            {
-                u8 source_index = b_collision_grid_rows->GridRows[(row_index * kCollisionGridColCount) + col_index];
-                printf("%02x ", source_index);
-            }
+            DWORD old_protection;
+            BOOL protect_result = VirtualProtect((u8 *)pack + entry->Offset, entry->InstanceStride * entry->InstanceCount, PAGE_READONLY, &old_protection);
+            Assert(protect_result);
         }
-
-        printf("\n");
-    }
-}
-
-static void
-collision_damage_print_draw(CollisionDamageContext *context)
-{
-    CollisionDamage *collision_damage_bin = context->Root;
-
-    CollisionDamageDamageEvents *collision_damage_damage_events_sheet = CollisionDamageDamageEventsPrt(collision_damage_bin);
-    f32 *damage_events_time_prt = CollisionDamageDamageEventsTimePrt(collision_damage_bin, collision_damage_damage_events_sheet);
-    u8 *damage_events_a_source_instance_index_prt = CollisionDamageDamageEventsASourceInstanceIndexPrt(collision_damage_bin, collision_damage_damage_events_sheet);
-    u8 *damage_events_b_source_instance_index_prt = CollisionDamageDamageEventsBSourceInstanceIndexPrt(collision_damage_bin, collision_damage_damage_events_sheet);
-
-    CollisionDamageAccumulatedDamage *collision_damage_accumulated_damage_sheet = CollisionDamageAccumulatedDamagePrt(collision_damage_bin);
-    u16 *accumulated_damage_a_value_prt = CollisionDamageAccumulatedDamageAValuePrt(collision_damage_bin, collision_damage_accumulated_damage_sheet);
-    u16 *accumulated_damage_b_value_prt = CollisionDamageAccumulatedDamageBValuePrt(collision_damage_bin, collision_damage_accumulated_damage_sheet);
-
-    u16 *a_damage_value_prt = CollisionDamageDamageEventsAValuePrt(collision_damage_bin, collision_damage_damage_events_sheet);
-    u16 *b_damage_value_prt = CollisionDamageDamageEventsBValuePrt(collision_damage_bin, collision_damage_damage_events_sheet);
-
-    printf("\033[0;0H");
-    
-    for (s32 event_index = 0; event_index < kCollisionDamageMaxDamageEventCount / 2; event_index++)
-    {
-        s32 a_col_index = event_index;
-        s32 b_col_index = event_index + kCollisionDamageMaxDamageEventCount / 2;
-
-        printf("\033[1;35m");
-
-        printf("%5.2f ", damage_events_time_prt[a_col_index]);
-
-        printf("\033[37m");
-
-        u16 a_col_a_source_index = damage_events_a_source_instance_index_prt[a_col_index];
-        u16 a_col_b_source_index = damage_events_b_source_instance_index_prt[a_col_index];
-
-        printf("%02x %02x", a_col_a_source_index, a_col_b_source_index);
-
-        printf(" ");
-
-        printf("%04x %04x", a_damage_value_prt[a_col_index], b_damage_value_prt[a_col_index]);
-
-        //printf(" ");
-        
-        //printf("%04x %04x", accumulated_damage_a_value_prt[a_col_a_source_index], accumulated_damage_b_value_prt[a_col_b_source_index]);
-
-        printf("  ");
-
-        printf("\033[1;35m");
-
-        printf("%5.2f ", damage_events_time_prt[b_col_index]);
-
-        printf("\033[37m");
-
-        u16 b_col_a_source_index = damage_events_a_source_instance_index_prt[b_col_index];
-        u16 b_col_b_source_index = damage_events_b_source_instance_index_prt[b_col_index];
-
-        printf("%02x %02x", b_col_a_source_index, b_col_b_source_index);
-
-        printf(" ");
-
-        //printf("%04x %04x", a_damage_value_prt[b_col_index], b_damage_value_prt[b_col_index]);
-
-        //printf(" ");
-
-        printf("%04x %04x", accumulated_damage_a_value_prt[b_col_a_source_index], accumulated_damage_b_value_prt[b_col_b_source_index]);
-
-        printf("\n");
     }
-
 }
-#endif
 
 static void
-collision_damage_draw(CollisionDamageContext *context, FrameData *frame_data)
+SampleInput(HWND window, GameInput *input)
 {
-    CollisionDamage *collision_damage_bin = context->Root;
-    LevelUpdate *level_update_bin = context->LevelUpdateBin;
-
-    CollisionDamageDamageEvents *collision_damage_damage_events_sheet = CollisionDamageDamageEventsPrt(collision_damage_bin);
-
-    u16 damage_events_count = *CollisionDamageDamageEventsCountPrt(collision_damage_bin);
-    u16 damage_events_capacity = *CollisionDamageDamageEventsCapacityPrt(collision_damage_bin);
-
-    damage_events_count = min(damage_events_count, damage_events_capacity);
-
-    v2 *a_damage_position_prt = (v2*)CollisionDamageDamageEventsAPositionPrt(collision_damage_bin, collision_damage_damage_events_sheet);
-    v2 *b_damage_position_prt = (v2*)CollisionDamageDamageEventsBPositionPrt(collision_damage_bin, collision_damage_damage_events_sheet);
-
-    f32 *damage_time_prt = CollisionDamageDamageEventsTimePrt(collision_damage_bin, collision_damage_damage_events_sheet);
-
-    FrameDataFrameData *frame_data_sheet = FrameDataFrameDataPrt(frame_data);
-    FrameDataFrameDataObjectData *object_data_column = FrameDataFrameDataObjectDataPrt(frame_data, frame_data_sheet);
-
-    u16 *frame_data_count_ptr = FrameDataFrameDataCountPrt(frame_data);
-    u16 frame_data_capacity   = *FrameDataFrameDataCapacityPrt(frame_data);
-
-    f32 level_time = *LevelUpdateTimePrt(level_update_bin);
-
-    for (u16 damage_index = 0; damage_index < damage_events_count; damage_index++)
-    {
-        f32 damage_time = damage_time_prt[damage_index];
-
-        f32 delta = fabsf(level_time - damage_time);
-
-        if (delta < 0.25f)
-        {
-            {
-                v2 damage_position = a_damage_position_prt[damage_index];
-                u16 frame_data_count = (*frame_data_count_ptr) % frame_data_capacity;
-                FrameDataFrameDataObjectData *object_data = object_data_column + frame_data_count;
-
-                object_data->PositionAndScale[0] = damage_position.x;
-                object_data->PositionAndScale[1] = damage_position.y;
-                object_data->PositionAndScale[2] = 0.1f;
-
-                object_data->MaterialIndex = 6;
-
-                (*frame_data_count_ptr)++;
-            }
-
-            {
-                v2 damage_position = b_damage_position_prt[damage_index];
-                u16 frame_data_count = (*frame_data_count_ptr) % frame_data_capacity;
-                FrameDataFrameDataObjectData *object_data = object_data_column + frame_data_count;
-
-                object_data->PositionAndScale[0] = damage_position.x;
-                object_data->PositionAndScale[1] = damage_position.y;
-                object_data->PositionAndScale[2] = 0.1f;
-
-                object_data->MaterialIndex = 6;
-
-                (*frame_data_count_ptr)++;
-            }
-        }
-    }
+    // get current size for window client area
+    RECT rect;
+    GetClientRect(window, &rect);
+    s32 width = rect.right - rect.left;
+    s32 height = rect.bottom - rect.top;
+
+    POINT mouseP;
+    GetCursorPos(&mouseP);
+    ScreenToClient(window, &mouseP);
+
+    input->ticks         = platform_ticks();
+    input->screen_width  = width;
+    input->screen_height = height;
+    input->mouse_x       = (f32)mouseP.x;
+    input->mouse_y       = (f32)((height - 1) - mouseP.y);
 }
 
 int WINAPI 
@@ -464,200 +221,55 @@ WinMain(HINSTANCE instance, HINSTANCE previnstance, LPSTR cmdline, int cmdshow)
         NULL, NULL, wc.hInstance, NULL);
     Assert(window && "Failed to create window");
 
-    v2 game_area = V2(kPlayAreaWidth, kPlayAreaHeight);
-
-    v2 half_game_area = v2_scale(game_area, 0.5f);
+    // show the window
+    ShowWindow(window, SW_SHOWDEFAULT);
 
-    f32 left = -half_game_area.x;
-    f32 right = half_game_area.x;
-    f32 bottom = -half_game_area.y;
-    f32 top = half_game_area.y;
+    MapFileData world_pack_map_data = CreateMapFile("world.pack", MapFilePermitions_ReadWriteCopy);
+    PackFile *world_pack            = (PackFile *)world_pack_map_data.data;
 
-    f32 near_clip_plane = 0.0f;
-    f32 far_clip_plane = 1.0f;
+    Assert(pack_file_valid(world_pack, kWorldPackEntryCount));
+    ProtectPackFile(world_pack);
 
-    m4x4_inv matrix = orthographic_projection(left, right, bottom, top, near_clip_plane, far_clip_plane);
+    u32 template_memory_size = template_registry_memory_size(world_pack, kGameWorldTemplateEntriesMask);
+    void *template_memory    = VirtualAlloc(NULL, template_memory_size, MEM_RESERVE|MEM_COMMIT, PAGE_READWRITE);
+    Assert(template_memory != NULL);
 
-    // show the window
-    ShowWindow(window, SW_SHOWDEFAULT);
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
 
-    MapFileData game_state_map_data = CreateMapFile("game_state.bin", MapFilePermitions_ReadWriteCopy);
-    GameState *game_state           = (GameState *)game_state_map_data.data;
+    u32 job_worker_count      = system_info.dwNumberOfProcessors - 1;
+    u32 job_arena_memory_size = job_pool_arena_memory_size(job_worker_count, kGameWorldJobArenaSize);
+    void *job_arena_memory    = VirtualAlloc(NULL, job_arena_memory_size, MEM_RESERVE|MEM_COMMIT, PAGE_READWRITE);
+    Assert(job_arena_memory != NULL);
 
-    MapFileData level_update_map_data = CreateMapFile("level_update.bin", MapFilePermitions_ReadWriteCopy);
-    LevelUpdate *level_update_data     = (LevelUpdate *)level_update_map_data.data;
+    // the simulation thread helps workers while it waits for the update graph
+    JobPool job_pool;
+    job_pool_init(&job_pool, job_worker_count, job_arena_memory, kGameWorldJobArenaSize);
 
-    MapFileData wave_update_map_data = CreateMapFile("wave_update.bin", MapFilePermitions_ReadWriteCopy);
-    WaveUpdate *wave_update_data     = (WaveUpdate *)wave_update_map_data.data;
+    #ifndef NDEBUG
+    static JobPoolCheck job_pool_check;
+    job_pool_self_check(&job_pool, &job_pool_check);
+    #endif
 
-	MapFileData enemy_instances_map_data = CreateMapFile("enemy_instances.bin", MapFilePermitions_ReadWriteCopy);
-	EnemyInstances *enemy_instances      = (EnemyInstances *)enemy_instances_map_data.data;
-	
-    MapFileData enemy_bullets_map_data = CreateMapFile("enemy_bullets.bin", MapFilePermitions_Read);
-	Bullets *enemy_bullets             = (Bullets *)enemy_bullets_map_data.data;
-
-    MapFileData hero_bullets_map_data = CreateMapFile("hero_bullets.bin", MapFilePermitions_Read);
-	Bullets *hero_bullets             = (Bullets *)hero_bullets_map_data.data;
-    
-    MapFileData hero_instances_map_data = CreateMapFile("hero_instances.bin", MapFilePermitions_ReadWriteCopy);
-    HeroInstances *hero_instances       = (HeroInstances *)hero_instances_map_data.data;
-
-    MapFileData frame_data_map_data = CreateMapFile("frame_data.bin", MapFilePermitions_ReadWriteCopy);
-    FrameData *frame_data           = (FrameData *)frame_data_map_data.data;
-
-    MapFileData materials_data = CreateMapFile("materials.bin", MapFilePermitions_Read);
-	Materials *materials       = (Materials *)materials_data.data;
-
-    MapFileData enemy_bullets_update_map_data = CreateMapFile("enemy_bullets_update.bin", MapFilePermitions_ReadWriteCopy);
-    BulletsUpdate *enemy_bullets_update_data  = (BulletsUpdate *)enemy_bullets_update_map_data.data;
-
-    MapFileData hero_bullets_update_map_data = CreateMapFile("hero_bullets_update.bin", MapFilePermitions_ReadWriteCopy);
-    BulletsUpdate *hero_bullets_update_data  = (BulletsUpdate *)hero_bullets_update_map_data.data;
-
-    MapFileData hero_bullets_collision_grid_map_data = CreateMapFile("collision_grid.bin", MapFilePermitions_ReadWriteCopy);
-    CollisionGrid *hero_bullets_collision_grid       = (CollisionGrid *)hero_bullets_collision_grid_map_data.data;
-
-    MapFileData enemy_bullets_collision_grid_map_data = CreateMapFile("collision_grid.bin", MapFilePermitions_ReadWriteCopy);
-    CollisionGrid *enemy_bullets_collision_grid       = (CollisionGrid *)enemy_bullets_collision_grid_map_data.data;
-
-    MapFileData hero_instances_collision_grid_map_data = CreateMapFile("collision_grid.bin", MapFilePermitions_ReadWriteCopy);
-    CollisionGrid *hero_instances_collision_grid       = (CollisionGrid *)hero_instances_collision_grid_map_data.data;
-
-    MapFileData enemy_instances_collision_grid_map_data = CreateMapFile("collision_grid.bin", MapFilePermitions_ReadWriteCopy);
-    CollisionGrid *enemy_instances_collision_grid       = (CollisionGrid *)enemy_instances_collision_grid_map_data.data;
-
-    MapFileData enemy_instances_vs_hero_bullets_collision_damage_map_data = CreateMapFile("collision_damage.bin", MapFilePermitions_ReadWriteCopy);
-    CollisionDamage *enemy_instances_vs_hero_bullets_collision_damage     = (CollisionDamage *)enemy_instances_vs_hero_bullets_collision_damage_map_data.data;
-
-    MapFileData hero_instances_vs_enemy_bullets_collision_damage_map_data = CreateMapFile("collision_damage.bin", MapFilePermitions_ReadWriteCopy);
-    CollisionDamage *hero_instances_vs_enemy_bullets_collision_damage     = (CollisionDamage *)hero_instances_vs_enemy_bullets_collision_damage_map_data.data;
-
-    BulletsUpdateContext enemy_bullets_update_context;
-    enemy_bullets_update_context.Root                        = enemy_bullets_update_data;
-    enemy_bullets_update_context.BulletsBin                  = enemy_bullets;
-    enemy_bullets_update_context.BulletSourceInstancesBin    = EnemyInstancesBulletSourceInstancesMapPrt(enemy_instances);
-    enemy_bullets_update_context.GameStateBin                = game_state;
-    enemy_bullets_update_context.PlayClockBin                = WaveUpdatePlayClockMapPrt(wave_update_data);
-    enemy_bullets_update_context.CollisionInstancesDamageBin = CollisionDamageBCollisionInstancesDamageMapPrt(hero_instances_vs_enemy_bullets_collision_damage);
-
-    BulletsDrawContext enemy_bullets_draw_context;
-    enemy_bullets_draw_context.BulletsBin       = enemy_bullets;
-    enemy_bullets_draw_context.BulletsUpdateBin = enemy_bullets_update_data;
-    enemy_bullets_draw_context.FrameDataBin     = frame_data;
-
-    BulletsUpdateContext hero_bullets_update_context;
-    hero_bullets_update_context.Root                        = hero_bullets_update_data;
-    hero_bullets_update_context.BulletsBin                  = hero_bullets;
-    hero_bullets_update_context.BulletSourceInstancesBin    = HeroInstancesBulletSourceInstancesMapPrt(hero_instances);
-    hero_bullets_update_context.GameStateBin                = game_state;
-    hero_bullets_update_context.PlayClockBin                = LevelUpdatePlayClockMapPrt(level_update_data);
-    hero_bullets_update_context.CollisionInstancesDamageBin = CollisionDamageBCollisionInstancesDamageMapPrt(enemy_instances_vs_hero_bullets_collision_damage);
-
-    BulletsDrawContext hero_bullets_draw_context;
-    hero_bullets_draw_context.BulletsBin       = hero_bullets;
-    hero_bullets_draw_context.BulletsUpdateBin = hero_bullets_update_data;
-    hero_bullets_draw_context.FrameDataBin     = frame_data;
-
-    EnemyInstancesContext enemy_instances_context;
-    enemy_instances_context.Root           = enemy_instances;
-    enemy_instances_context.GameStateBin   = game_state;
-    enemy_instances_context.WaveUpdateBin  = wave_update_data;
-    enemy_instances_context.LevelUpdateBin = level_update_data;
-    enemy_instances_context.CollisionInstancesDamageBin = CollisionDamageACollisionInstancesDamageMapPrt(enemy_instances_vs_hero_bullets_collision_damage);
-
-    EnemyInstancesDrawContext enemy_instances_draw_context;
-    enemy_instances_draw_context.EnemyInstancesBin = enemy_instances;
-    enemy_instances_draw_context.FrameDataBin      = frame_data;
-
-    LevelUpdateContext level_update_context;
-    level_update_context.Root                  = level_update_data;
-    level_update_context.GameStateBin          = game_state;
-    level_update_context.EnemyInstancesBin     = enemy_instances;
-    level_update_context.EnemyBulletsUpdateBin = enemy_bullets_update_data;
-
-    WaveUpdateContext wave_update_context;
-    wave_update_context.Root                  = wave_update_data;
-    wave_update_context.GameStateBin          = game_state;
-    wave_update_context.EnemyInstancesBin     = enemy_instances;
-    wave_update_context.EnemyBulletsUpdateBin = enemy_bullets_update_data;
-    wave_update_context.LevelUpdateBin        = level_update_data;
-
-    HeroInstancesContext hero_instances_context;
-    hero_instances_context.Root         = hero_instances;
-    hero_instances_context.GameStateBin = game_state;
-    hero_instances_context.CollisionInstancesDamageBin = CollisionDamageACollisionInstancesDamageMapPrt(hero_instances_vs_enemy_bullets_collision_damage);
-
-    HeroInstancesDrawContext hero_instances_draw_context;
-    hero_instances_draw_context.HeroInstancesBin = hero_instances;
-    hero_instances_draw_context.FrameDataBin     = frame_data;
-
-    CollisionGridContext hero_bullets_collision_grid_context;
-    hero_bullets_collision_grid_context.Root = hero_bullets_collision_grid;
-    hero_bullets_collision_grid_context.CollisionSourceInstancesBin = BulletsUpdateCollisionSourceInstancesMapPrt(hero_bullets_update_data);
-    hero_bullets_collision_grid_context.CollisionSourceRadiusBin = BulletsCollisionSourceRadiusMapPrt(hero_bullets);
-
-    CollisionGridContext enemy_bullets_collision_grid_context;
-    enemy_bullets_collision_grid_context.Root = enemy_bullets_collision_grid;
-    enemy_bullets_collision_grid_context.CollisionSourceInstancesBin = BulletsUpdateCollisionSourceInstancesMapPrt(enemy_bullets_update_data);
-    enemy_bullets_collision_grid_context.CollisionSourceRadiusBin = BulletsCollisionSourceRadiusMapPrt(enemy_bullets);
-
-    CollisionGridContext hero_instances_collision_grid_context;
-    hero_instances_collision_grid_context.Root = hero_instances_collision_grid;
-    hero_instances_collision_grid_context.CollisionSourceInstancesBin = HeroInstancesCollisionSourceInstancesMapPrt(hero_instances);
-    hero_instances_collision_grid_context.CollisionSourceRadiusBin = HeroInstancesCollisionSourceRadiusMapPrt(hero_instances);
-
-    CollisionGridContext enemy_instances_collision_grid_context;
-    enemy_instances_collision_grid_context.Root = enemy_instances_collision_grid;
-    enemy_instances_collision_grid_context.CollisionSourceInstancesBin = EnemyInstancesCollisionSourceInstancesMapPrt(enemy_instances);
-    enemy_instances_collision_grid_context.CollisionSourceRadiusBin = EnemyInstancesCollisionSourceRadiusMapPrt(enemy_instances);
-
-    CollisionDamageContext enemy_instances_vs_hero_bullets_collision_damage_context;
-    enemy_instances_vs_hero_bullets_collision_damage_context.Root = enemy_instances_vs_hero_bullets_collision_damage;
-    
-    enemy_instances_vs_hero_bullets_collision_damage_context.ACollisionGridBin = enemy_instances_collision_grid;
-    enemy_instances_vs_hero_bullets_collision_damage_context.ACollisionSourceInstancesBin = enemy_instances_collision_grid_context.CollisionSourceInstancesBin;
-    enemy_instances_vs_hero_bullets_collision_damage_context.ACollisionSourceRadiusBin = enemy_instances_collision_grid_context.CollisionSourceRadiusBin;
-    enemy_instances_vs_hero_bullets_collision_damage_context.ACollisionSourceDamageBin = EnemyInstancesCollisionSourceDamageMapPrt(enemy_instances);
-
-    enemy_instances_vs_hero_bullets_collision_damage_context.BCollisionGridBin = hero_bullets_collision_grid;
-    enemy_instances_vs_hero_bullets_collision_damage_context.BCollisionSourceInstancesBin = hero_bullets_collision_grid_context.CollisionSourceInstancesBin;
-    enemy_instances_vs_hero_bullets_collision_damage_context.BCollisionSourceRadiusBin = hero_bullets_collision_grid_context.CollisionSourceRadiusBin;
-    enemy_instances_vs_hero_bullets_collision_damage_context.BCollisionSourceDamageBin = BulletsCollisionSourceDamageMapPrt(hero_bullets);
-    enemy_instances_vs_hero_bullets_collision_damage_context.LevelUpdateBin = level_update_data;
-
-    CollisionDamageContext hero_instances_vs_enemy_bullets_collision_damage_context;
-    hero_instances_vs_enemy_bullets_collision_damage_context.Root = hero_instances_vs_enemy_bullets_collision_damage;
-    
-    hero_instances_vs_enemy_bullets_collision_damage_context.ACollisionGridBin = hero_instances_collision_grid;
-    hero_instances_vs_enemy_bullets_collision_damage_context.ACollisionSourceInstancesBin = hero_instances_collision_grid_context.CollisionSourceInstancesBin;
-    hero_instances_vs_enemy_bullets_collision_damage_context.ACollisionSourceRadiusBin = hero_instances_collision_grid_context.CollisionSourceRadiusBin;
-    hero_instances_vs_enemy_bullets_collision_damage_context.ACollisionSourceDamageBin = HeroInstancesCollisionSourceDamageMapPrt(hero_instances);
-
-    hero_instances_vs_enemy_bullets_collision_damage_context.BCollisionGridBin = enemy_bullets_collision_grid;
-    hero_instances_vs_enemy_bullets_collision_damage_context.BCollisionSourceInstancesBin = enemy_bullets_collision_grid_context.CollisionSourceInstancesBin;
-    hero_instances_vs_enemy_bullets_collision_damage_context.BCollisionSourceRadiusBin = enemy_bullets_collision_grid_context.CollisionSourceRadiusBin;
-    hero_instances_vs_enemy_bullets_collision_damage_context.BCollisionSourceDamageBin = BulletsCollisionSourceDamageMapPrt(enemy_bullets);
-    hero_instances_vs_enemy_bullets_collision_damage_context.LevelUpdateBin = level_update_data;
-
-    f32 *time_delta_ptr          = GameStateTimeDeltaPrt(game_state);
-    f64 *time_ptr                = GameStateTimePrt(game_state);
-    f32 *play_time_ptr           = GameStatePlayTimePrt(game_state);
-    u64 *frame_count_ptr         = GameStateFrameCounterPrt(game_state);
-    u32 *state_ptr               = GameStateStatePrt(game_state);
-    v2 *world_mouse_position_ptr = (v2 *)GameStateWorldMousePositionPrt(game_state);
-
-    u64 *hero_instances_live_ptr = HeroInstancesInstancesLivePrt(hero_instances);
-
-    f32 game_aspect = game_area.x / game_area.y;
+    GameWorld world;
+    game_world_init(&world, world_pack, &job_pool, template_memory, template_memory_size);
 
     DirectX11State directx_state = { 0 };
-	InitDirectX11(&directx_state, window, matrix.forward, materials);
+	InitDirectX11(&directx_state, window, world.matrix.forward, world.materials);
+
+    GameInput input = { 0 };
+    SampleInput(window, &input);
+
+    // 1 simulates the next frame while this one is presented, 2 trades another frame of input latency for more overlap
+    u32 frame_pipeline_depth = 1;
 
-    LARGE_INTEGER freq, c1;
-    QueryPerformanceFrequency(&freq);
-    QueryPerformanceCounter(&c1);
+    FramePipeline frame_pipeline;
+    frame_pipeline_init(&frame_pipeline, &world, frame_pipeline_depth, 0.0f, &input);
 
-    *state_ptr |= kGameStateReset|kGameStatePlayEnable;
+    FrameCapture frame_capture;
+    b32 frame_capture_active   = 0;
+    b32 frame_capture_toggle   = 0;
+    void *frame_capture_memory = NULL;
 
     for (;;)
     {
@@ -687,16 +299,13 @@ WinMain(HINSTANCE instance, HINSTANCE previnstance, LPSTR cmdline, int cmdshow)
                     {
                         //if(IsDown)
                         {
-                            if ((*hero_instances_live_ptr) == 0)
-                            {
-                                *state_ptr |= kGameStateReset|kGameStatePlayEnable;
-                            }
-                            else
-                            {
-                                *state_ptr ^= kGameStatePlayEnable;
-                            }
+                            input.play_toggle_press_count++;
                         }
                     }
+                    else if(VKCode == 'C')
+                    {
+                        frame_capture_toggle = 1;
+                    }
                 }
 
             }
@@ -705,94 +314,66 @@ WinMain(HINSTANCE instance, HINSTANCE previnstance, LPSTR cmdline, int cmdshow)
             continue;
         }
 
-        // get current size for window client area
-        RECT rect;
-        GetClientRect(window, &rect);
-        width = rect.right - rect.left;
-        height = rect.bottom - rect.top;
+        SampleInput(window, &input);
+        frame_pipeline_input(&frame_pipeline, &input);
 
-        begin_frame(frame_data, game_aspect, width, height);
-
-		if (width != 0 && height != 0)
-		{
-			LARGE_INTEGER c2;
-			QueryPerformanceCounter(&c2);
-            *time_delta_ptr = (f32)((f64)(c2.QuadPart - c1.QuadPart) / freq.QuadPart);
-			c1 = c2;
+        FrameData *frame_data = frame_pipeline_acquire(&frame_pipeline);
+		EndFrameDirectX11(&directx_state, frame_data);
 
-            if ((*state_ptr) & kGameStatePlayEnable)
+        if (frame_capture_toggle)
+        {
+            frame_capture_toggle = 0;
+            if (frame_capture_active)
             {
-                POINT mouseP;
-                GetCursorPos(&mouseP);
-                ScreenToClient(window, &mouseP);
-                f32 mouseX = (f32)mouseP.x;
-                f32 mouseY = (f32)((height - 1) - mouseP.y);
-
-                FrameDataViewport viewport = *FrameDataViewportPrt(frame_data);
-
-                f32 clip_space_mouseX = clamp_binormal_map_to_range(viewport.X, mouseX, viewport.X + viewport.Width);
-                f32 clip_space_mouseY = clamp_binormal_map_to_range(viewport.Y, mouseY, viewport.Y + viewport.Height);
-
-                *world_mouse_position_ptr = transform(matrix.inverse, V2(clip_space_mouseX, clip_space_mouseY));
-
-                *play_time_ptr += *time_delta_ptr;
-
-                level_update(&level_update_context);
-                wave_update(&wave_update_context);
-
-                enemy_instances_update(&enemy_instances_context);
-                hero_instances_update(&hero_instances_context);
-
-                bullets_update(&enemy_bullets_update_context);
-                bullets_update(&hero_bullets_update_context);
-
-                collision_grid_update(&hero_bullets_collision_grid_context);
-                collision_grid_update(&enemy_bullets_collision_grid_context);
-                collision_grid_update(&hero_instances_collision_grid_context);
-                collision_grid_update(&enemy_instances_collision_grid_context);
-
-                collision_damage_update(&enemy_instances_vs_hero_bullets_collision_damage_context);
-                collision_damage_update(&hero_instances_vs_enemy_bullets_collision_damage_context);
-
-                *state_ptr &= ~kGameStateReset;
+                frame_capture_close(&frame_capture);
+                VirtualFree(frame_capture_memory, 0, MEM_RELEASE);
+                frame_capture_active = 0;
             }
+            else
+            {
+                frame_capture_memory = VirtualAlloc(NULL, frame_capture_memory_size(kWin32FrameCaptureMaxFrameCount), MEM_RESERVE|MEM_COMMIT, PAGE_READWRITE);
+                Assert(frame_capture_memory != NULL);
 
-            #ifndef NDEBUG
-            //collision_damage_print_draw(&enemy_instances_vs_hero_bullets_collision_damage_context);
-            //collision_grid_print_draw(&enemy_instances_collision_grid_context, &hero_bullets_collision_grid_context);
-            #endif
+                frame_capture_active = frame_capture_open(&frame_capture, "frame_capture.fdc", kWin32FrameCaptureMaxFrameCount, frame_capture_memory);
+                if (!frame_capture_active)
+                {
+                    VirtualFree(frame_capture_memory, 0, MEM_RELEASE);
+                }
+            }
+        }
 
-            bullets_draw(&enemy_bullets_draw_context);
-            enemy_instances_draw(&enemy_instances_draw_context);
-            bullets_draw(&hero_bullets_draw_context);
-            hero_instances_draw(&hero_instances_draw_context);
+        if (frame_capture_active)
+        {
+            frame_capture_record(&frame_capture, frame_data);
+        }
 
-            collision_damage_draw(&enemy_instances_vs_hero_bullets_collision_damage_context, frame_data);
-            collision_damage_draw(&hero_instances_vs_enemy_bullets_collision_damage_context, frame_data);
+        frame_pipeline_release(&frame_pipeline);
 
-            *time_ptr += *time_delta_ptr;
-            (*frame_count_ptr)++;
-		}
+        #ifndef NDEBUG
+        FramePipelineLatency *latency = &frame_pipeline.Latency;
+        if (latency->FrameCount == 240)
+        {
+            printf("input latency avg %.2f ms, max %.2f ms, depth %u\n",
+                   frame_pipeline_ticks_to_ms(&frame_pipeline, latency->TotalTicks / latency->FrameCount),
+                   frame_pipeline_ticks_to_ms(&frame_pipeline, latency->MaxTicks),
+                   frame_pipeline.Depth);
+            memset(latency, 0, sizeof(FramePipelineLatency));
+        }
+        #endif
+    }
 
-		EndFrameDirectX11(&directx_state, frame_data);
+    if (frame_capture_active)
+    {
+        frame_capture_close(&frame_capture);
+        VirtualFree(frame_capture_memory, 0, MEM_RELEASE);
     }
 
-	CloseMapFile(&hero_instances_map_data);
-	CloseMapFile(&enemy_instances_map_data);
-	CloseMapFile(&enemy_bullets_map_data);
-	CloseMapFile(&hero_bullets_map_data);
-	CloseMapFile(&frame_data_map_data);
-	CloseMapFile(&enemy_bullets_update_map_data);
-	CloseMapFile(&hero_bullets_update_map_data);
-	CloseMapFile(&game_state_map_data);
-	CloseMapFile(&wave_update_map_data);
-	CloseMapFile(&level_update_map_data);
-    CloseMapFile(&hero_bullets_collision_grid_map_data);
-    CloseMapFile(&enemy_bullets_collision_grid_map_data);
-    CloseMapFile(&hero_instances_collision_grid_map_data);
-    CloseMapFile(&enemy_instances_collision_grid_map_data);
-    CloseMapFile(&enemy_instances_vs_hero_bullets_collision_damage_map_data);
-    CloseMapFile(&hero_instances_vs_enemy_bullets_collision_damage_map_data);
+    frame_pipeline_shutdown(&frame_pipeline);
+    job_pool_shutdown(&job_pool);
+
+    VirtualFree(job_arena_memory, 0, MEM_RELEASE);
+    VirtualFree(template_memory, 0, MEM_RELEASE);
+    CloseMapFile(&world_pack_map_data);
 
     DestroyDirectX11(&directx_state);
 }